@@ -0,0 +1,111 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef BYTES_H_93D5A0E7_4C2F_4B18_B6E9_0F7A12C83D54
+#define BYTES_H_93D5A0E7_4C2F_4B18_B6E9_0F7A12C83D54
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Little-endian fields in byte buffers, whatever the alignment
+ */
+
+static inline void bytes_put_u16(
+    uint8_t* const p,
+    const uint16_t v) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void bytes_put_u32(
+    uint8_t* const p,
+    const uint32_t v) {
+        bytes_put_u16(p, (uint16_t)v);
+        bytes_put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline void bytes_put_u64(
+    uint8_t* const p,
+    const uint64_t v) {
+        bytes_put_u32(p, (uint32_t)v);
+        bytes_put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline void bytes_put_f32(
+    uint8_t* const p,
+    const float v) {
+        uint32_t u;
+        memcpy(&u, &v, sizeof(u));
+        bytes_put_u32(p, u);
+}
+
+static inline void bytes_put_f64(
+    uint8_t* const p,
+    const double v) {
+        uint64_t u;
+        memcpy(&u, &v, sizeof(u));
+        bytes_put_u64(p, u);
+}
+
+static inline uint16_t bytes_get_u16(
+    const uint8_t* const p) {
+        return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t bytes_get_u32(
+    const uint8_t* const p) {
+        return bytes_get_u16(p) |
+            ((uint32_t)bytes_get_u16(p + 2) << 16);
+}
+
+static inline uint64_t bytes_get_u64(
+    const uint8_t* const p) {
+        return bytes_get_u32(p) |
+            ((uint64_t)bytes_get_u32(p + 4) << 32);
+}
+
+static inline float bytes_get_f32(
+    const uint8_t* const p) {
+        const uint32_t u = bytes_get_u32(p);
+        float v;
+        memcpy(&v, &u, sizeof(v));
+        return v;
+}
+
+static inline double bytes_get_f64(
+    const uint8_t* const p) {
+        const uint64_t u = bytes_get_u64(p);
+        double v;
+        memcpy(&v, &u, sizeof(v));
+        return v;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CAPTURE_H_D4A1F963_0B7E_4E25_8C3A_95E2B6170FD8
+#define CAPTURE_H_D4A1F963_0B7E_4E25_8C3A_95E2B6170FD8
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Capture files hold raw values and the times they were obtained.
+ * All fields are little-endian.
+ * 
+ * header (CAPTURE_HEADER_LEN bytes):
+ *  u32 magic, u16 version, u16 sample size, u32 nominal period us
+ *  (0 if unknown), u32 reserved
+ * 
+ * then one capture_sample_t per value, to the end of the file.
+ */
+
+#define CAPTURE_MAGIC 0x50414353u //"SCAP"
+#define CAPTURE_VERSION 1u
+#define CAPTURE_HEADER_LEN 16u
+
+typedef struct {
+    uint32_t time; //us
+    int32_t value;
+} capture_sample_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
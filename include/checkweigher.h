@@ -0,0 +1,152 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CHECKWEIGHER_H_93A4C6E1_0B7D_4F25_8C3A_5E1F72D9B460
+#define CHECKWEIGHER_H_93A4C6E1_0B7D_4F25_8C3A_5E1F72D9B460
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/types.h"
+#include "mass.h"
+#include "scale.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    checkweigher_accept = 0,
+    checkweigher_under,
+    checkweigher_over
+} checkweigher_result_t;
+
+typedef struct {
+    mass_t target; //nominal weight of an item
+    mass_t under; //tolerance below target before an item is under
+    mass_t over; //tolerance above target before an item is over
+    mass_t empty; //weight above which an item is on the scale
+    uint settle; //samples discarded after an item arrives
+    uint samples; //samples averaged to make a decision
+} checkweigher_config_t;
+
+typedef enum {
+    checkweigher__state_idle = 0, //waiting for an item
+    checkweigher__state_settling,
+    checkweigher__state_measuring,
+    checkweigher__state_clearing //waiting for the item to leave
+} checkweigher__state_t;
+
+/**
+ * Classifies items as accept, under or over directly from raw samples.
+ * The tolerance band is converted to raw counts once, so each sample is
+ * an integer add and compare. No normalising or mass_t is involved.
+ */
+typedef struct {
+    const scale_t* _sc;
+    int64_t _empty; //counts from offset
+    int64_t _under_sum; //sums below this are under
+    int64_t _over_sum; //sums above this are over
+    uint _settle;
+    uint _samples;
+    checkweigher__state_t _state;
+    uint _n; //samples seen in the current state
+    int64_t _sum; //sum of counts while measuring
+    uint32_t _arrived; //us; time the current item arrived
+    uint32_t _results[3]; //count of each checkweigher_result_t
+    uint32_t _lat_min; //us
+    uint32_t _lat_max; //us
+    uint64_t _lat_total; //us
+} checkweigher_t;
+
+/**
+ * @brief Initialises a checkweigher for items on sc. The tolerance band is
+ * converted to raw counts using the scale's ref_unit, so the checkweigher
+ * must be initialised again if ref_unit changes. Counts are relative to the
+ * scale's offset when each sample is fed, so zeroing the scale does not.
+ * 
+ * @param cw 
+ * @param sc 
+ * @param cfg 
+ */
+void checkweigher_init(
+    checkweigher_t* const cw,
+    const scale_t* const sc,
+    const checkweigher_config_t* const cfg);
+
+/**
+ * @brief Feeds a raw sample from the scale. Returns true and sets result when
+ * the sample completes the decision for an item.
+ * 
+ * @param cw 
+ * @param raw 
+ * @param result 
+ * @return true 
+ * @return false 
+ */
+bool checkweigher_feed(
+    checkweigher_t* const cw,
+    const int32_t raw,
+    checkweigher_result_t* const result);
+
+/**
+ * @brief Returns the number of items given the result
+ * 
+ * @param cw 
+ * @param result 
+ * @return uint32_t 
+ */
+uint32_t checkweigher_get_count(
+    const checkweigher_t* const cw,
+    const checkweigher_result_t result);
+
+/**
+ * @brief Sets the minimum, maximum and mean time in microseconds from an
+ * item arriving to its decision. Returns false if no decisions have been
+ * made.
+ * 
+ * @param cw 
+ * @param min 
+ * @param max 
+ * @param mean 
+ * @return true 
+ * @return false 
+ */
+bool checkweigher_get_latency(
+    const checkweigher_t* const cw,
+    uint32_t* const min,
+    uint32_t* const max,
+    uint32_t* const mean);
+
+/**
+ * @brief Clears the result counts and latency statistics
+ * 
+ * @param cw 
+ */
+void checkweigher_reset_stats(
+    checkweigher_t* const cw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
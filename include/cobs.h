@@ -0,0 +1,83 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef COBS_H_7D19B3E6_52A4_4C8F_B0D3_6A9E14F2C85B
+#define COBS_H_7D19B3E6_52A4_4C8F_B0D3_6A9E14F2C85B
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Consistent Overhead Byte Stuffing. Encoded data contains no zero
+ * bytes, so a zero can mark the end of each frame in a byte stream.
+ */
+
+/**
+ * Largest encoded length of len bytes, not including the zero
+ * delimiter
+ */
+#define COBS_ENCODED_MAX(len) ((len) + ((len) / 254u) + 1u)
+
+/**
+ * @brief Encodes len bytes from src into dst, which must be at least
+ * COBS_ENCODED_MAX(len) bytes long. Returns the encoded length. No
+ * zero delimiter is appended.
+ * 
+ * @param src 
+ * @param len 
+ * @param dst 
+ * @return size_t 
+ */
+size_t cobs_encode(
+    const uint8_t* const src,
+    const size_t len,
+    uint8_t* const dst);
+
+/**
+ * @brief Decodes len bytes of a frame from src into dst, which must
+ * be at least len bytes long. src must not include the zero delimiter.
+ * Sets outlen to the decoded length. Returns false if the frame is
+ * malformed.
+ * 
+ * @param src 
+ * @param len 
+ * @param dst 
+ * @param outlen 
+ * @return true 
+ * @return false 
+ */
+bool cobs_decode(
+    const uint8_t* const src,
+    const size_t len,
+    uint8_t* const dst,
+    size_t* const outlen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,215 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CODEC_H_4F6B0D27_E5A3_4C91_8B7E_3D02A9C6F518
+#define CODEC_H_4F6B0D27_E5A3_4C91_8B7E_3D02A9C6F518
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Compresses streams of raw values. Each value is stored as the
+ * difference from the one before it, zigzag mapped so small negative
+ * differences are small numbers, then as a varint of 7 bits per byte.
+ * A slowly changing 24 bit value typically takes 1 or 2 bytes rather
+ * than 4.
+ * 
+ * Values are grouped into blocks of a fixed number of values. The
+ * first value of each block is a checkpoint, stored whole rather than
+ * as a difference, so decoding can start at any block.
+ */
+
+/**
+ * Most bytes a single value can take
+ */
+#define CODEC_VALUE_MAX 5u
+
+/**
+ * Most bytes len values can take
+ */
+#define CODEC_ENCODED_MAX(len) ((len) * CODEC_VALUE_MAX)
+
+typedef struct {
+    uint8_t* _buff;
+    size_t _bufflen;
+    size_t _pos; //bytes written
+    size_t _block; //values per block
+    size_t _count; //values written
+    int32_t _prev;
+    uint32_t* _index; //byte offset of each block; may be NULL
+    size_t _indexlen;
+} codec_encoder_t;
+
+typedef struct {
+    const uint8_t* _buff;
+    size_t _len;
+    size_t _pos; //bytes read
+    size_t _block; //values per block
+    size_t _count; //values read
+    int32_t _prev;
+} codec_decoder_t;
+
+static inline uint32_t codec_zigzag(
+    const int32_t v) {
+        return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t codec_unzigzag(
+    const uint32_t u) {
+        return (int32_t)((u >> 1) ^ (0u - (u & 1u)));
+}
+
+/**
+ * @brief Initialises the encoder to write to buff. block is the number
+ * of values between checkpoints. If index is not NULL, the byte offset
+ * of each block is written to it, up to indexlen blocks.
+ * 
+ * @param enc 
+ * @param buff 
+ * @param bufflen 
+ * @param block 
+ * @param index May be NULL
+ * @param indexlen 
+ */
+void codec_encoder_init(
+    codec_encoder_t* const enc,
+    uint8_t* const buff,
+    const size_t bufflen,
+    const size_t block,
+    uint32_t* const index,
+    const size_t indexlen);
+
+/**
+ * @brief Encodes a value. Returns false if there is no room for it,
+ * in which case nothing is written.
+ * 
+ * @param enc 
+ * @param value 
+ * @return true 
+ * @return false 
+ */
+bool codec_encoder_add(
+    codec_encoder_t* const enc,
+    const int32_t value);
+
+/**
+ * @brief Encodes values from arr until there is no more room. Returns
+ * the number of values encoded.
+ * 
+ * @param enc 
+ * @param arr 
+ * @param len 
+ * @return size_t 
+ */
+size_t codec_encoder_add_all(
+    codec_encoder_t* const enc,
+    const int32_t* const arr,
+    const size_t len);
+
+/**
+ * @brief Returns the number of bytes written
+ * 
+ * @param enc 
+ * @return size_t 
+ */
+size_t codec_encoder_get_len(
+    const codec_encoder_t* const enc);
+
+/**
+ * @brief Returns the number of values written
+ * 
+ * @param enc 
+ * @return size_t 
+ */
+size_t codec_encoder_get_count(
+    const codec_encoder_t* const enc);
+
+/**
+ * @brief Initialises the decoder to read len bytes from buff, which
+ * were encoded with the given block size
+ * 
+ * @param dec 
+ * @param buff 
+ * @param len 
+ * @param block 
+ */
+void codec_decoder_init(
+    codec_decoder_t* const dec,
+    const uint8_t* const buff,
+    const size_t len,
+    const size_t block);
+
+/**
+ * @brief Decodes the next value. Returns false at the end of the
+ * data or if it is malformed.
+ * 
+ * @param dec 
+ * @param value 
+ * @return true 
+ * @return false 
+ */
+bool codec_decoder_next(
+    codec_decoder_t* const dec,
+    int32_t* const value);
+
+/**
+ * @brief Decodes up to len values into arr. Returns the number of
+ * values decoded.
+ * 
+ * @param dec 
+ * @param arr 
+ * @param len 
+ * @return size_t 
+ */
+size_t codec_decoder_read(
+    codec_decoder_t* const dec,
+    int32_t* const arr,
+    const size_t len);
+
+/**
+ * @brief Moves the decoder so the next value decoded is value number n,
+ * using the block offsets from the encoder's index. Returns false if n
+ * is past the end of the data.
+ * 
+ * @param dec 
+ * @param index 
+ * @param indexlen Number of blocks in index that were written
+ * @param n 
+ * @return true 
+ * @return false 
+ */
+bool codec_decoder_seek(
+    codec_decoder_t* const dec,
+    const uint32_t* const index,
+    const size_t indexlen,
+    const size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,143 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FILTER_H_B5A181BC_E0C2_470F_A6E1_49DB5F9E7176
+#define FILTER_H_B5A181BC_E0C2_470F_A6E1_49DB5F9E7176
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    filter_mains_50 = 50,
+    filter_mains_60 = 60
+} filter_mains_t;
+
+/**
+ * Fractional bits used by the notch filter coefficients
+ */
+static const uint FILTER_NOTCH_Q = 16;
+
+/**
+ * Number of samples consumed before the notch filter produces
+ * its first output
+ */
+static const size_t FILTER_NOTCH_DELAY = 2;
+
+typedef struct {
+    bool _enabled;
+    int64_t _g0; //Q16 gain applied to x[n] and x[n-2]
+    int64_t _g1; //Q16 gain applied to x[n-1]
+} filter_notch_t;
+
+/**
+ * The inputs a notch filter carries from one call to
+ * filter_notch_apply_stream to the next
+ */
+typedef struct {
+    int32_t _x1; //x[n-1]
+    int32_t _x2; //x[n-2]
+    size_t _primed; //inputs seen, up to FILTER_NOTCH_DELAY
+} filter_notch_state_t;
+
+/**
+ * @brief Initialises a notch filter which removes mains interference
+ * as it appears after being aliased by the given sample rate. The filter
+ * is a three-tap FIR with unity gain at DC, so it does not alter the
+ * weight. If the mains frequency aliases to (or close to) DC, as it does
+ * at 10 SPS, the HX711's own filter already rejects it and the notch
+ * filter is left disabled.
+ * 
+ * @param f 
+ * @param sps Sample rate of the HX711 in samples per second (eg. 10 or 80)
+ * @param mains Local mains frequency
+ */
+void filter_notch_init(
+    filter_notch_t* const f,
+    const uint sps,
+    const filter_mains_t mains);
+
+/**
+ * @brief Returns true if the filter will modify samples
+ * 
+ * @param f 
+ * @return true 
+ * @return false 
+ */
+bool filter_notch_is_enabled(
+    const filter_notch_t* const f);
+
+/**
+ * @brief Filters arr in-place and returns the number of filtered values
+ * now at the start of arr. This is FILTER_NOTCH_DELAY fewer than len, so
+ * each call loses the first FILTER_NOTCH_DELAY values; filter a stream
+ * arriving in parts with filter_notch_apply_stream instead. If the filter
+ * is disabled or len is too short to be filtered, arr is not modified and
+ * len is returned.
+ * 
+ * @param f 
+ * @param arr array of values
+ * @param len number of values in the array
+ * @return size_t 
+ */
+size_t filter_notch_apply(
+    const filter_notch_t* const f,
+    int32_t* const arr,
+    const size_t len);
+
+/**
+ * @brief Starts a new stream of values for filter_notch_apply_stream
+ * 
+ * @param st 
+ */
+void filter_notch_state_init(
+    filter_notch_state_t* const st);
+
+/**
+ * @brief As filter_notch_apply, but for one part of a stream of values.
+ * The last inputs are kept in st, so only the first FILTER_NOTCH_DELAY
+ * values of the whole stream are lost rather than those of every part.
+ * Returns the number of filtered values now at the start of arr. If the
+ * filter is disabled, arr is not modified and len is returned.
+ * 
+ * @param f 
+ * @param st 
+ * @param arr array of values
+ * @param len number of values in the array
+ * @return size_t 
+ */
+size_t filter_notch_apply_stream(
+    const filter_notch_t* const f,
+    filter_notch_state_t* const st,
+    int32_t* const arr,
+    const size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FLASH_ADAPTOR_H_C6E1A8F3_2D4B_4A97_9F05_B3871E6D42AC
+#define FLASH_ADAPTOR_H_C6E1A8F3_2D4B_4A97_9F05_B3871E6D42AC
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A region of NOR flash. Offsets are from the start of the region.
+ * Erasing sets every byte of a sector to 0xff and programming can only
+ * clear bits, so a page must be erased before it is programmed.
+ */
+typedef struct flash_adaptor {
+
+    /**
+     * @brief Arbitrary user data
+     */
+    void* _data;
+
+    /**
+     * @brief Function pointer to function which copies len bytes at
+     * offset into buff
+     * @param fa pointer to flash adaptor
+     * @param offset 
+     * @param buff 
+     * @param len 
+     */
+    bool (*read)(
+        struct flash_adaptor* const fa,
+        const uint32_t offset,
+        uint8_t* const buff,
+        const size_t len);
+
+    /**
+     * @brief Function pointer to function which programs one page at
+     * offset, which is a multiple of page_size
+     * @param fa pointer to flash adaptor
+     * @param offset 
+     * @param buff page_size bytes
+     */
+    bool (*program)(
+        struct flash_adaptor* const fa,
+        const uint32_t offset,
+        const uint8_t* const buff);
+
+    /**
+     * @brief Function pointer to function which erases one sector at
+     * offset, which is a multiple of sector_size
+     * @param fa pointer to flash adaptor
+     * @param offset 
+     */
+    bool (*erase)(
+        struct flash_adaptor* const fa,
+        const uint32_t offset);
+
+    uint32_t size; //bytes in the region; a multiple of sector_size
+    uint32_t sector_size; //bytes erased at once
+    uint32_t page_size; //bytes programmed at once
+
+} flash_adaptor_t;
+
+bool flash_adaptor_init(
+    flash_adaptor_t* const fa,
+    void* data);
+
+void* flash_adaptor_get_data(
+    flash_adaptor_t* const fa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
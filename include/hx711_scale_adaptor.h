@@ -33,9 +33,30 @@
 extern "C" {
 #endif
 
+/**
+ * Number of values buffered by the interrupt handler when the
+ * adaptor is in IRQ mode. Must be a power of 2.
+ */
+#define HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN 32u
+
 typedef struct {
     hx711_t* _hx;
     scale_adaptor_t _sa;
+    volatile int32_t _irq_buff[HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN];
+    volatile uint32_t _irq_times[HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN]; //us; when each value in _irq_buff was captured
+    volatile uint32_t _irq_head; //only written by the interrupt handler
+    volatile uint32_t _irq_tail; //only written by the reader
+    volatile uint32_t _irq_overruns; //values overwritten before they were read; only written by the reader
+    bool _irq_enabled;
+    uint _period_nominal; //us; 0 if the rate has not been set
+    volatile uint _period_measured; //us; 0 until measured
+    volatile uint32_t _last_time; //us; time the last value arrived
+    volatile bool _timed; //whether _last_time is valid
+    uint32_t _value_time; //us; when the value last obtained was captured
+    bool _value_timed; //whether _value_time is valid
+    uint32_t _fifo_time; //us; when the value last taken from the FIFO was captured
+    bool _fifo_timed; //whether _fifo_time is valid
+    uint _backlog; //values still in the FIFO from when it was found full
 } hx711_scale_adaptor_t;
 
 bool hx711_scale_adaptor_init(
@@ -45,6 +66,17 @@ bool hx711_scale_adaptor_init(
 scale_adaptor_t* hx711_scale_adaptor_get_base(
     hx711_scale_adaptor_t* const hxa);
 
+/**
+ * @brief Sets the rate the HX711 is operating at, so the adaptor can report
+ * the nominal time between values
+ * 
+ * @param hxa 
+ * @param rate 
+ */
+void hx711_scale_adaptor_set_rate(
+    hx711_scale_adaptor_t* const hxa,
+    const hx711_rate_t rate);
+
 bool hx711_scale_adaptor_get_value_timeout(
     scale_adaptor_t* const sa,
     int32_t* const value,
@@ -54,6 +86,99 @@ bool hx711_scale_adaptor_get_value(
     scale_adaptor_t* const sa,
     int32_t* const value);
 
+/**
+ * @brief Switches the adaptor to IRQ mode. Each value the HX711's PIO state
+ * machine pushes into its RX FIFO raises an interrupt which moves the value
+ * into the adaptor's buffer, and the adaptor's functions sleep with __wfe
+ * until a value is available rather than polling. The hx711_t must be using
+ * a PIO program which reads continuously (eg. hx711_noblock_program) and must
+ * not be read directly while in IRQ mode. Returns true if the operation
+ * succeeded.
+ * 
+ * @param hxa 
+ * @return true 
+ * @return false 
+ */
+bool hx711_scale_adaptor_irq_enable(
+    hx711_scale_adaptor_t* const hxa);
+
+/**
+ * @brief Switches the adaptor back to reading the HX711 directly
+ * 
+ * @param hxa 
+ */
+void hx711_scale_adaptor_irq_disable(
+    hx711_scale_adaptor_t* const hxa);
+
+/**
+ * @brief Returns the number of values dropped in IRQ mode because the buffer
+ * filled before they were read. A full buffer keeps the newest values.
+ * 
+ * @param hxa 
+ * @return uint32_t 
+ */
+uint32_t hx711_scale_adaptor_irq_get_overruns(
+    const hx711_scale_adaptor_t* const hxa);
+
+bool hx711_scale_adaptor_irq_get_value_timeout(
+    scale_adaptor_t* const sa,
+    int32_t* const value,
+    const uint timeout);
+
+bool hx711_scale_adaptor_irq_get_value(
+    scale_adaptor_t* const sa,
+    int32_t* const value);
+
+bool hx711_scale_adaptor_irq_get_value_noblock(
+    scale_adaptor_t* const sa,
+    int32_t* const value);
+
+bool hx711_scale_adaptor_get_value_noblock(
+    scale_adaptor_t* const sa,
+    int32_t* const value);
+
+bool hx711_scale_adaptor_get_period(
+    scale_adaptor_t* const sa,
+    uint* const nominal,
+    uint* const measured);
+
+bool hx711_scale_adaptor_get_time(
+    scale_adaptor_t* const sa,
+    uint32_t* const time);
+
+void hx711_scale_adaptor__irq_handler(void);
+
+void hx711_scale_adaptor__record_time(
+    hx711_scale_adaptor_t* const hxa,
+    const uint32_t now);
+
+/**
+ * @brief Returns when the value about to be taken from the RX FIFO was
+ * captured, given the number of values queued including it and whether
+ * the FIFO was full
+ * 
+ * @param hxa 
+ * @param now 
+ * @param queued 
+ * @param full 
+ * @return uint32_t 
+ */
+uint32_t hx711_scale_adaptor__capture_time(
+    hx711_scale_adaptor_t* const hxa,
+    const uint32_t now,
+    const uint queued,
+    const bool full);
+
+void hx711_scale_adaptor__captured(
+    hx711_scale_adaptor_t* const hxa,
+    const uint queued,
+    const bool full);
+
+bool hx711_scale_adaptor__irq_pop(
+    hx711_scale_adaptor_t* const hxa,
+    int32_t* const value,
+    uint32_t* const time);
+
 #ifdef __cplusplus
 }
 #endif
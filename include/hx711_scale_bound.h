@@ -0,0 +1,190 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HX711_SCALE_BOUND_H_2F8E41C7_95B3_4D6A_B0E1_7C24A9D3F518
+#define HX711_SCALE_BOUND_H_2F8E41C7_95B3_4D6A_B0E1_7C24A9D3F518
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/pio.h"
+#include "pico/time.h"
+#include "hx711_scale_adaptor.h"
+#include "scale_bound.h"
+#include "../extern/hx711-pico-c/include/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief As hx711_scale_adaptor_get_value, but taking the adaptor directly
+ * so that it can be inlined. Follows the adaptor into IRQ mode.
+ * 
+ * @param hxa 
+ * @param value 
+ * @return true 
+ * @return false 
+ */
+static inline bool hx711_scale_bound_get_value(
+    hx711_scale_adaptor_t* const hxa,
+    int32_t* const value) {
+
+        assert(hxa != NULL);
+        assert(value != NULL);
+
+        if(hxa->_irq_enabled) {
+            return hx711_scale_adaptor_irq_get_value(&hxa->_sa, value);
+        }
+
+        const uint queued = pio_sm_get_rx_fifo_level(
+            hxa->_hx->_pio,
+            hxa->_hx->_reader_sm);
+        const bool full = pio_sm_is_rx_fifo_full(
+            hxa->_hx->_pio,
+            hxa->_hx->_reader_sm);
+
+        *value = hx711_get_value(hxa->_hx);
+        hx711_scale_adaptor__captured(hxa, queued, full);
+
+        return true;
+
+}
+
+/**
+ * @brief As hx711_scale_adaptor_get_value_timeout, but taking the adaptor
+ * directly so that it can be inlined. Follows the adaptor into IRQ mode.
+ * 
+ * @param hxa 
+ * @param value 
+ * @param timeout 
+ * @return true 
+ * @return false 
+ */
+static inline bool hx711_scale_bound_get_value_timeout(
+    hx711_scale_adaptor_t* const hxa,
+    int32_t* const value,
+    const uint timeout) {
+
+        assert(hxa != NULL);
+        assert(value != NULL);
+
+        if(hxa->_irq_enabled) {
+            return hx711_scale_adaptor_irq_get_value_timeout(&hxa->_sa, value, timeout);
+        }
+
+        const uint queued = pio_sm_get_rx_fifo_level(
+            hxa->_hx->_pio,
+            hxa->_hx->_reader_sm);
+        const bool full = pio_sm_is_rx_fifo_full(
+            hxa->_hx->_pio,
+            hxa->_hx->_reader_sm);
+
+        if(!hx711_get_value_timeout(hxa->_hx, value, timeout)) {
+            return false;
+        }
+
+        hx711_scale_adaptor__captured(hxa, queued, full);
+
+        return true;
+
+}
+
+/**
+ * @brief As hx711_scale_adaptor_get_value_noblock, but taking the adaptor
+ * directly so that it can be inlined. Follows the adaptor into IRQ mode.
+ * 
+ * @param hxa 
+ * @param value 
+ * @return true 
+ * @return false 
+ */
+static inline bool hx711_scale_bound_get_value_noblock(
+    hx711_scale_adaptor_t* const hxa,
+    int32_t* const value) {
+
+        assert(hxa != NULL);
+        assert(value != NULL);
+
+        if(hxa->_irq_enabled) {
+            return hx711_scale_adaptor_irq_get_value_noblock(&hxa->_sa, value);
+        }
+
+        const uint queued = pio_sm_get_rx_fifo_level(
+            hxa->_hx->_pio,
+            hxa->_hx->_reader_sm);
+        const bool full = pio_sm_is_rx_fifo_full(
+            hxa->_hx->_pio,
+            hxa->_hx->_reader_sm);
+
+        if(!hx711_get_value_noblock(hxa->_hx, value)) {
+            return false;
+        }
+
+        hx711_scale_adaptor__captured(hxa, queued, full);
+
+        return true;
+
+}
+
+/**
+ * @brief As hx711_scale_adaptor_get_time, but taking the adaptor directly
+ * so that it can be inlined
+ * 
+ * @param hxa 
+ * @param time 
+ * @return true 
+ * @return false 
+ */
+static inline bool hx711_scale_bound_get_time(
+    hx711_scale_adaptor_t* const hxa,
+    uint32_t* const time) {
+
+        assert(hxa != NULL);
+        assert(time != NULL);
+
+        if(!hxa->_value_timed) {
+            return false;
+        }
+
+        *time = hxa->_value_time;
+        return true;
+
+}
+
+/**
+ * hx711_scale_bound_get_values_samples, hx711_scale_bound_get_values_timeout,
+ * hx711_scale_bound_read and hx711_scale_bound_weight; see SCALE_BIND.
+ */
+SCALE_BIND(
+    hx711_scale_bound,
+    hx711_scale_adaptor_t,
+    hx711_scale_bound_get_value,
+    hx711_scale_bound_get_value_timeout,
+    hx711_scale_bound_get_value_noblock,
+    hx711_scale_bound_get_time)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,129 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef KALMAN_H_2E9A7C41_5D0B_4F3A_9B8E_6C1D7F2A4E53
+#define KALMAN_H_2E9A7C41_5D0B_4F3A_9B8E_6C1D7F2A4E53
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Default measurement noise variance in raw counts^2
+ */
+static const double KALMAN_DEFAULT_R = 400.0;
+
+/**
+ * Default process noise variance in raw counts^2 while the
+ * load is static
+ */
+static const double KALMAN_DEFAULT_Q = 0.01;
+
+/**
+ * Innovations larger than this many standard deviations are
+ * treated as a change in load rather than noise
+ */
+static const double KALMAN_GATE = 4.0;
+
+/**
+ * Number of consecutive innovations outside the gate, all on the same
+ * side of the estimate, taken as a change in load. Fewer are rejected
+ * as spikes.
+ */
+static const unsigned KALMAN_STEP_COUNT = 3;
+
+/**
+ * Weight given to each new innovation when estimating the process
+ * noise. Higher values adapt faster to drift and creep.
+ */
+static const double KALMAN_Q_ALPHA = 0.05;
+
+typedef struct {
+    double r; //measurement noise variance
+    double q_min; //process noise variance while static
+    double _q; //current process noise variance
+    double _x; //current estimate
+    double _p; //current estimate variance
+    int _outside; //consecutive innovations outside the gate; negative when below
+    bool _primed;
+} kalman_t;
+
+/**
+ * @brief Initialises a scalar Kalman filter with the given measurement noise
+ * and minimum process noise variances
+ * 
+ * @param kf 
+ * @param r Measurement noise variance (ie. square of the sample noise)
+ * @param q_min Process noise variance used while the load is static
+ */
+void kalman_init(
+    kalman_t* const kf,
+    const double r,
+    const double q_min);
+
+/**
+ * @brief Discards the current estimate so the next value seeds the filter
+ * 
+ * @param kf 
+ */
+void kalman_reset(
+    kalman_t* const kf);
+
+/**
+ * @brief Updates the estimate with a new value. A value too far from the
+ * estimate to be noise is rejected as a spike, unless it is the
+ * KALMAN_STEP_COUNT-th in a row on the same side, in which case the load
+ * has changed and the filter is reseeded from it. Otherwise the process noise is adapted from the
+ * size of the innovation: it grows while the load drifts or creeps and
+ * falls back to q_min while the load is static, so the estimate converges.
+ * 
+ * @param kf 
+ * @param z 
+ */
+void kalman_update(
+    kalman_t* const kf,
+    const int32_t z);
+
+/**
+ * @brief Updates the estimate with each value in arr and sets est to the
+ * resulting estimate
+ * 
+ * @param kf 
+ * @param arr array of values
+ * @param len number of values in the array
+ * @param est 
+ */
+void kalman_update_all(
+    kalman_t* const kf,
+    const int32_t* const arr,
+    const size_t len,
+    double* const est);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
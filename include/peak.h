@@ -0,0 +1,181 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PEAK_H_5B82E9F4_6C1A_4D37_A0E5_8F3D27C6B91E
+#define PEAK_H_5B82E9F4_6C1A_4D37_A0E5_8F3D27C6B91E
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int32_t value; //raw value
+    uint32_t time; //us
+} peak_sample_t;
+
+typedef enum {
+    peak_trigger_above = 0, //trigger when a value is at or above the level
+    peak_trigger_below //trigger when a value is at or below the level
+} peak_trigger_t;
+
+typedef enum {
+    peak__capture_off = 0,
+    peak__capture_armed, //recording pre-trigger samples
+    peak__capture_triggered, //recording post-trigger samples
+    peak__capture_done
+} peak__capture_state_t;
+
+/**
+ * Tracks the highest and lowest raw values, and when they
+ * occurred, at the full sample rate. Optionally captures the
+ * samples around a trigger into a caller-provided buffer.
+ */
+typedef struct {
+    peak_sample_t _max;
+    peak_sample_t _min;
+    bool _held; //whether _max and _min hold a sample
+    peak_sample_t* _buff;
+    size_t _bufflen;
+    size_t _pre; //samples kept from before the trigger
+    int32_t _level;
+    peak_trigger_t _trigger;
+    peak__capture_state_t _state;
+    size_t _head; //next index written in _buff
+    size_t _count; //samples in _buff
+    size_t _post; //post-trigger samples still to record
+    size_t _trigger_index; //index of the trigger sample in the capture
+} peak_t;
+
+/**
+ * @brief Initialises the peak/valley hold with nothing held and no capture
+ * 
+ * @param pk 
+ */
+void peak_init(
+    peak_t* const pk);
+
+/**
+ * @brief Releases the held peak and valley so the next sample starts a new
+ * hold
+ * 
+ * @param pk 
+ */
+void peak_reset(
+    peak_t* const pk);
+
+/**
+ * @brief Updates the peak, valley and any capture with a sample. O(1).
+ * 
+ * @param pk 
+ * @param value raw value
+ * @param time us the value was obtained
+ */
+void peak_feed(
+    peak_t* const pk,
+    const int32_t value,
+    const uint32_t time);
+
+/**
+ * @brief Sets s to the highest value held and when it occurred. Returns
+ * false if nothing is held.
+ * 
+ * @param pk 
+ * @param s 
+ * @return true 
+ * @return false 
+ */
+bool peak_get_max(
+    const peak_t* const pk,
+    peak_sample_t* const s);
+
+/**
+ * @brief Sets s to the lowest value held and when it occurred. Returns
+ * false if nothing is held.
+ * 
+ * @param pk 
+ * @param s 
+ * @return true 
+ * @return false 
+ */
+bool peak_get_min(
+    const peak_t* const pk,
+    peak_sample_t* const s);
+
+/**
+ * @brief Arms a capture of bufflen samples into buff around the first value
+ * to meet the trigger: pre samples from before it, then the trigger sample
+ * and the samples after it.
+ * 
+ * @param pk 
+ * @param buff 
+ * @param bufflen 
+ * @param pre number of pre-trigger samples; less than bufflen
+ * @param level raw trigger level
+ * @param trigger 
+ */
+void peak_capture_arm(
+    peak_t* const pk,
+    peak_sample_t* const buff,
+    const size_t bufflen,
+    const size_t pre,
+    const int32_t level,
+    const peak_trigger_t trigger);
+
+/**
+ * @brief Returns true once the capture is complete
+ * 
+ * @param pk 
+ * @return true 
+ * @return false 
+ */
+bool peak_capture_is_done(
+    const peak_t* const pk);
+
+/**
+ * @brief Copies the completed capture in order into out and sets trigger to
+ * the index of the trigger sample within it. Returns the number of samples
+ * copied, which is the capture length. If the trigger came before all the
+ * pre-trigger samples were recorded, trigger is less than pre and the rest
+ * of the capture is samples from after it. Returns 0 if the capture is not
+ * complete.
+ * 
+ * @param pk 
+ * @param out 
+ * @param outlen 
+ * @param trigger 
+ * @return size_t 
+ */
+size_t peak_capture_read(
+    const peak_t* const pk,
+    peak_sample_t* const out,
+    const size_t outlen,
+    size_t* const trigger);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,98 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PICO_FLASH_ADAPTOR_H_1A7F04D9_8C3E_4B62_A5D1_E9024C7B368F
+#define PICO_FLASH_ADAPTOR_H_1A7F04D9_8C3E_4B62_A5D1_E9024C7B368F
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "flash_adaptor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Time in ms to wait for the other core to pause before a flash
+ * operation fails
+ */
+static const uint32_t PICO_FLASH_ADAPTOR_SAFE_TIMEOUT = 100;
+
+/**
+ * A region of the RP2040's own flash. Nothing can run from flash
+ * while it is erased or programmed, so each operation is run with
+ * flash_safe_execute, which disables interrupts on this core and
+ * pauses the other: about 50ms for a sector erase and 1ms for a page.
+ * The other core must have called multicore_lockout_victim_init (a
+ * scale_pipeline_t does so on core 1); if core 1 is never used, define
+ * PICO_FLASH_ASSUME_CORE1_SAFE as 1. Otherwise the operation fails.
+ * 
+ * No interrupts are serviced on either core during an erase, so an
+ * hx711_scale_adaptor_t in IRQ mode captures nothing for its duration
+ * beyond what the PIO's RX FIFO holds. Erase between windows (see
+ * recorder_service), not while one is being acquired.
+ */
+typedef struct {
+    uint32_t _offset; //bytes from the start of flash
+    flash_adaptor_t _fa;
+} pico_flash_adaptor_t;
+
+/**
+ * @brief Initialises the adaptor for size bytes of flash starting
+ * offset bytes from the start of flash. Both must be multiples of
+ * FLASH_SECTOR_SIZE, and the region must not overlap the program.
+ * 
+ * @param pfa 
+ * @param offset 
+ * @param size 
+ * @return true 
+ * @return false 
+ */
+bool pico_flash_adaptor_init(
+    pico_flash_adaptor_t* const pfa,
+    const uint32_t offset,
+    const uint32_t size);
+
+flash_adaptor_t* pico_flash_adaptor_get_base(
+    pico_flash_adaptor_t* const pfa);
+
+bool pico_flash_adaptor_read(
+    flash_adaptor_t* const fa,
+    const uint32_t offset,
+    uint8_t* const buff,
+    const size_t len);
+
+bool pico_flash_adaptor_program(
+    flash_adaptor_t* const fa,
+    const uint32_t offset,
+    const uint8_t* const buff);
+
+bool pico_flash_adaptor_erase(
+    flash_adaptor_t* const fa,
+    const uint32_t offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
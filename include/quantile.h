@@ -0,0 +1,103 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef QUANTILE_H_8D3F6A20_71C4_4E9B_A5D2_0B7E94C13F68
+#define QUANTILE_H_8D3F6A20_71C4_4E9B_A5D2_0B7E94C13F68
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Number of markers kept by the P-squared algorithm
+ */
+#define QUANTILE_P2_MARKERS 5
+
+/**
+ * Streaming quantile estimator using the P-squared algorithm
+ * (Jain & Chlamtac, 1985). Memory use is constant regardless
+ * of how many values are added.
+ */
+typedef struct {
+    double _p; //quantile being estimated
+    double _q[QUANTILE_P2_MARKERS]; //marker heights
+    double _np[QUANTILE_P2_MARKERS]; //desired marker positions
+    double _dn[QUANTILE_P2_MARKERS]; //desired position increments
+    uint32_t _n[QUANTILE_P2_MARKERS]; //actual marker positions
+    uint32_t _count; //number of values added
+} quantile_p2_t;
+
+/**
+ * @brief Initialises the estimator for the p-quantile (eg. 0.5 for the median)
+ * 
+ * @param qe 
+ * @param p [0, 1]
+ */
+void quantile_p2_init(
+    quantile_p2_t* const qe,
+    const double p);
+
+/**
+ * @brief Adds a value to the estimator
+ * 
+ * @param qe 
+ * @param val 
+ */
+void quantile_p2_add(
+    quantile_p2_t* const qe,
+    const int32_t val);
+
+/**
+ * @brief Adds each value in arr to the estimator
+ * 
+ * @param qe 
+ * @param arr array of values
+ * @param len number of values in the array
+ */
+void quantile_p2_add_all(
+    quantile_p2_t* const qe,
+    const int32_t* const arr,
+    const size_t len);
+
+/**
+ * @brief Sets val to the current estimate of the quantile. Returns false if
+ * no values have been added. The estimate is exact until more than
+ * QUANTILE_P2_MARKERS values have been added.
+ * 
+ * @param qe 
+ * @param val 
+ * @return true 
+ * @return false 
+ */
+bool quantile_p2_get(
+    const quantile_p2_t* const qe,
+    double* const val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
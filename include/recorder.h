@@ -0,0 +1,273 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RECORDER_H_6B3D9E02_F147_4C58_8A2E_57C0D1B94A63
+#define RECORDER_H_6B3D9E02_F147_4C58_8A2E_57C0D1B94A63
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "codec.h"
+#include "flash_adaptor.h"
+#include "mass.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A flight recorder which keeps the most recent raw values and weights
+ * in a circular region of flash, oldest overwritten first.
+ * 
+ * Adding records only copies them into one of two page buffers in
+ * RAM. All flash operations happen in recorder_service, one per call,
+ * so the caller decides when they happen (eg. between reads). The
+ * sector after the one being written is erased as soon as the last
+ * one fills, well before a page needs to be programmed into it.
+ * Records which arrive while both page buffers are waiting to be
+ * programmed are dropped and counted.
+ * 
+ * Each page starts with a header of u32 seq, u16 magic, u16 used
+ * bytes. seq increases by one per page, so the oldest and newest
+ * pages can be found after a reset. Records follow the header, and
+ * never span pages. All fields are little-endian.
+ * 
+ * recorder_record_samples:
+ *  u8 type, u8 count, u8 bytes, u32 time, u16 period, then count
+ *  values encoded by codec_encoder_t as one block
+ * 
+ * recorder_record_weight:
+ *  u8 type, u32 time, f32 raw, f64 ug, u8 unit
+ * 
+ * Times are in microseconds.
+ */
+
+#define RECORDER_PAGE_LEN 256u
+#define RECORDER_PAGE_MAGIC 0x5246u
+#define RECORDER_HEADER_LEN 8u
+#define RECORDER_SAMPLES_HEADER_LEN 9u
+#define RECORDER_WEIGHT_LEN 18u
+
+/**
+ * Most values in a single samples record
+ */
+#define RECORDER_MAX_SAMPLES 255u
+
+typedef enum {
+    recorder_record_samples = 1,
+    recorder_record_weight = 2
+} recorder_record_type_t;
+
+typedef struct {
+    recorder_record_type_t type;
+    uint32_t seq; //page the record is in
+    uint32_t time; //samples: time of the first value; weight: time
+    uint32_t period; //samples: mean us between values; 0 if unknown
+    size_t count; //samples
+    int32_t values[RECORDER_MAX_SAMPLES]; //samples
+    float raw; //weight
+    double ug; //weight
+    mass_unit_t unit; //weight
+} recorder_record_t;
+
+typedef struct {
+    flash_adaptor_t* _fa;
+    uint8_t _pages[2][RECORDER_PAGE_LEN];
+    uint8_t _fill; //index of the page being filled
+    size_t _len; //bytes used in the page being filled
+    bool _pending; //whether the other page is waiting to be programmed
+    uint32_t _head; //offset the next page is programmed at
+    bool _head_erased; //whether the sector at _head is erased from _head on
+    uint32_t _seq; //seq of the page being filled
+    uint32_t _dropped; //values and weights dropped
+} recorder_t;
+
+typedef struct {
+    flash_adaptor_t* _fa;
+    uint8_t _page[RECORDER_PAGE_LEN];
+    uint32_t _next; //offset of the next page to read
+    uint32_t _pages_left; //pages not yet read
+    size_t _pos; //next record in _page
+    size_t _used; //bytes used in _page
+    uint32_t _seq; //seq of _page
+} recorder_reader_t;
+
+/**
+ * Called with consecutive pieces of the recording by recorder_dump.
+ * Returns false if it could not be written.
+ */
+typedef bool (*recorder_write_t)(
+    const uint8_t* const buff,
+    const size_t len,
+    void* const data);
+
+/**
+ * @brief Initialises the recorder to continue the recording in the flash
+ * region, or to start one if there is none. The flash's page size must
+ * be RECORDER_PAGE_LEN. Returns false if the region cannot be read.
+ * 
+ * @param rec 
+ * @param fa 
+ * @return true 
+ * @return false 
+ */
+bool recorder_init(
+    recorder_t* const rec,
+    flash_adaptor_t* const fa);
+
+/**
+ * @brief Records raw values and the times they were obtained. times may
+ * be NULL. Returns false if any were dropped.
+ * 
+ * @param rec 
+ * @param values 
+ * @param times 
+ * @param len 
+ * @return true 
+ * @return false 
+ */
+bool recorder_add_samples(
+    recorder_t* const rec,
+    const int32_t* const values,
+    const uint32_t* const times,
+    const size_t len);
+
+/**
+ * @brief Records a reduced raw value and the mass it was converted to.
+ * Returns false if it was dropped.
+ * 
+ * @param rec 
+ * @param time us
+ * @param raw 
+ * @param m 
+ * @return true 
+ * @return false 
+ */
+bool recorder_add_weight(
+    recorder_t* const rec,
+    const uint32_t time,
+    const double raw,
+    const mass_t* const m);
+
+/**
+ * @brief Queues the partly filled page to be programmed, so everything
+ * added so far is written by the following recorder_service calls.
+ * Returns false if the other page is still waiting, in which case call
+ * recorder_service and try again.
+ * 
+ * @param rec 
+ * @return true 
+ * @return false 
+ */
+bool recorder_flush(
+    recorder_t* const rec);
+
+/**
+ * @brief Performs at most one flash operation: erasing the next sector
+ * or programming a full page. Returns false if the operation failed.
+ * 
+ * @param rec 
+ * @return true 
+ * @return false 
+ */
+bool recorder_service(
+    recorder_t* const rec);
+
+/**
+ * @brief Returns whether recorder_service has nothing left to do
+ * 
+ * @param rec 
+ * @return true 
+ * @return false 
+ */
+bool recorder_is_idle(
+    const recorder_t* const rec);
+
+/**
+ * @brief Returns the number of values and weights dropped because
+ * recorder_service was not called often enough
+ * 
+ * @param rec 
+ * @return uint32_t 
+ */
+uint32_t recorder_get_dropped(
+    const recorder_t* const rec);
+
+/**
+ * @brief Initialises the reader at the oldest record in the flash region
+ * 
+ * @param rd 
+ * @param fa 
+ * @return true 
+ * @return false 
+ */
+bool recorder_reader_init(
+    recorder_reader_t* const rd,
+    flash_adaptor_t* const fa);
+
+/**
+ * @brief Reads the next record, oldest first. Returns false when there
+ * are no more.
+ * 
+ * @param rd 
+ * @param r 
+ * @return true 
+ * @return false 
+ */
+bool recorder_reader_next(
+    recorder_reader_t* const rd,
+    recorder_record_t* const r);
+
+/**
+ * @brief Passes every recorded page to write, oldest first. The output
+ * can be read back with a flash_adaptor_t over it, eg. by
+ * tools/recorder_dump.
+ * 
+ * @param fa 
+ * @param write 
+ * @param data Passed to write
+ * @return true 
+ * @return false 
+ */
+bool recorder_dump(
+    flash_adaptor_t* const fa,
+    const recorder_write_t write,
+    void* const data);
+
+bool recorder__find(
+    flash_adaptor_t* const fa,
+    uint32_t* const oldest,
+    uint32_t* const newest,
+    uint32_t* const newest_seq);
+
+bool recorder__reserve(
+    recorder_t* const rec,
+    const size_t len);
+
+bool recorder__close(
+    recorder_t* const rec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
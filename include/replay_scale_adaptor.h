@@ -0,0 +1,178 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef REPLAY_SCALE_ADAPTOR_H_8E2C47B1_D905_4F6A_B3E8_716A0C5D29F4
+#define REPLAY_SCALE_ADAPTOR_H_8E2C47B1_D905_4F6A_B3E8_716A0C5D29F4
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "capture.h"
+#include "scale_adaptor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    replay_mode_fast = 0, //every value is available at once
+    replay_mode_realtime //values become available as they did when captured
+} replay_mode_t;
+
+/**
+ * Host-only adaptor which serves values from a capture file. The file
+ * is memory mapped, so values can also be read in batches straight
+ * from it without copying.
+ * 
+ * In fast mode, a strategy_type_time read fills the whole buffer, since
+ * values arrive faster than any timeout. Use strategy_type_samples for
+ * reads which match the device.
+ * 
+ * Each value is reported as captured at its recorded time, moved onto the
+ * host clock, so the scale's timing and timestamps follow the capture. In
+ * realtime mode the capture starts when it is rewound. In fast mode it is
+ * moved on to the host time whenever the caller falls behind it, and
+ * otherwise runs ahead; a capture read in one burst for longer than 2^31 us
+ * (about 35 minutes) of recorded time would run far enough ahead to look
+ * stale, so read it in parts or in realtime mode.
+ */
+typedef struct {
+    const capture_sample_t* _samples;
+    size_t _count;
+    size_t _pos; //next value
+    void* _map;
+    size_t _maplen;
+    replay_mode_t _mode;
+    uint32_t _period_nominal; //us; 0 if unknown
+    uint32_t _period_measured; //us; mean over the whole capture; 0 if unknown
+    uint64_t _due; //us; host time the value at _pos is due
+    uint32_t _time; //us; host time the value most recently served was due
+    scale_adaptor_t _sa;
+} replay_scale_adaptor_t;
+
+/**
+ * @brief Maps the capture file at path and starts replaying it from the
+ * beginning. Returns false if it cannot be opened or is not a capture.
+ * 
+ * @param rsa 
+ * @param path 
+ * @param mode 
+ * @return true 
+ * @return false 
+ */
+bool replay_scale_adaptor_open(
+    replay_scale_adaptor_t* const rsa,
+    const char* const path,
+    const replay_mode_t mode);
+
+/**
+ * @brief Unmaps the capture file
+ * 
+ * @param rsa 
+ */
+void replay_scale_adaptor_close(
+    replay_scale_adaptor_t* const rsa);
+
+scale_adaptor_t* replay_scale_adaptor_get_base(
+    replay_scale_adaptor_t* const rsa);
+
+/**
+ * @brief Starts replaying again from the beginning
+ * 
+ * @param rsa 
+ */
+void replay_scale_adaptor_rewind(
+    replay_scale_adaptor_t* const rsa);
+
+/**
+ * @brief Returns whether every value has been served
+ * 
+ * @param rsa 
+ * @return true 
+ * @return false 
+ */
+bool replay_scale_adaptor_is_done(
+    const replay_scale_adaptor_t* const rsa);
+
+/**
+ * @brief Returns the number of values in the capture
+ * 
+ * @param rsa 
+ * @return size_t 
+ */
+size_t replay_scale_adaptor_get_count(
+    const replay_scale_adaptor_t* const rsa);
+
+/**
+ * @brief Sets samples to point at up to len of the next values in the
+ * mapped file, and returns how many. In realtime mode only values which
+ * are already due are included. The values are consumed.
+ * 
+ * @param rsa 
+ * @param samples 
+ * @param len 
+ * @return size_t 
+ */
+size_t replay_scale_adaptor_get_batch(
+    replay_scale_adaptor_t* const rsa,
+    const capture_sample_t** const samples,
+    const size_t len);
+
+bool replay_scale_adaptor_get_value(
+    scale_adaptor_t* const sa,
+    int32_t* const value);
+
+bool replay_scale_adaptor_get_value_timeout(
+    scale_adaptor_t* const sa,
+    int32_t* const value,
+    const uint timeout);
+
+bool replay_scale_adaptor_get_value_noblock(
+    scale_adaptor_t* const sa,
+    int32_t* const value);
+
+bool replay_scale_adaptor_get_period(
+    scale_adaptor_t* const sa,
+    uint* const nominal,
+    uint* const measured);
+
+/**
+ * @brief Sets time to when the value most recently served was captured,
+ * on the host clock. Returns false if none has been served.
+ * 
+ * @param sa 
+ * @param time 
+ * @return true 
+ * @return false 
+ */
+bool replay_scale_adaptor_get_time(
+    scale_adaptor_t* const sa,
+    uint32_t* const time);
+
+int32_t replay_scale_adaptor__take(
+    replay_scale_adaptor_t* const rsa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -27,8 +27,13 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "pico/time.h"
+#include "filter.h"
+#include "kalman.h"
 #include "mass.h"
+#include "quantile.h"
 #include "scale_adaptor.h"
+#include "scale_perf.h"
+#include "util.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,7 +46,11 @@ typedef enum {
 
 typedef enum {
     read_type_median = 0,
-    read_type_average
+    read_type_average,
+    read_type_kalman,
+    read_type_trimmed_mean,
+    read_type_mad_mean,
+    read_type_quantile
 } read_type_t;
 
 typedef struct {
@@ -51,16 +60,40 @@ typedef struct {
     uint timeout; //us
     int32_t* buffer; //read buffer
     size_t bufflen; //read buffer length
+    const filter_notch_t* notch; //optional mains filter; NULL to disable. Each window loses its first FILTER_NOTCH_DELAY values
+    double trim; //fraction discarded from each end for read_type_trimmed_mean
+    double mad_k; //standard deviations kept for read_type_mad_mean
+    double quantile; //quantile estimated by read_type_quantile
+    bool align; //start strategy_type_time windows when a value arrives
+    uint32_t* timestamps; //optional; us each buffer value was obtained; bufflen long
 } scale_options_t;
 
-static const scale_options_t SCALE_DEFAULT_OPTIONS = {
-    .strat = strategy_type_samples,
-    .read = read_type_median,
-    .samples = 3, //3 samples
-    .timeout = 1000000, //1 second
-    .buffer = NULL,
-    .bufflen = 0
-};
+/**
+ * Initialiser for a scale_options_t with the default options and the given
+ * buffer, buffer length and number of samples
+ */
+#define SCALE__OPTIONS_INIT(BUFFER, BUFFLEN, SAMPLES) {                         \
+    .strat = strategy_type_samples,                                             \
+    .read = read_type_median,                                                   \
+    .samples = (SAMPLES),                                                       \
+    .timeout = 1000000, /* 1 second */                                          \
+    .buffer = (BUFFER),                                                         \
+    .bufflen = (BUFFLEN),                                                       \
+    .notch = NULL,                                                              \
+    .trim = 0.25, /* interquartile mean */                                      \
+    .mad_k = 3.0,                                                               \
+    .quantile = 0.5, /* median */                                               \
+    .align = false,                                                             \
+    .timestamps = NULL                                                          \
+}
+
+/**
+ * Number of samples in the default options
+ */
+#define SCALE_DEFAULT_SAMPLES 3u
+
+static const scale_options_t SCALE_DEFAULT_OPTIONS =
+    SCALE__OPTIONS_INIT(NULL, 0, SCALE_DEFAULT_SAMPLES);
 
 /**
  * @brief Fill options will default values
@@ -70,13 +103,148 @@ static const scale_options_t SCALE_DEFAULT_OPTIONS = {
 void scale_options_get_default(
     scale_options_t* const opt);
 
+/**
+ * Time in us scale_get_latest keeps trying to obtain a consistent
+ * reading before giving up. A write takes far less; this only runs
+ * out when the writer cannot make progress (eg. it has been preempted
+ * by the caller).
+ */
+static const uint SCALE_LATEST_TIMEOUT = 100;
+
+/**
+ * Weight of each new inter-sample time in the running period and
+ * jitter estimates is 1 / SCALE_TIMING_WEIGHT
+ */
+static const double SCALE_TIMING_WEIGHT = 16.0;
+
+typedef struct {
+    uint32_t samples; //number of samples obtained
+    uint32_t missed; //estimated number of samples missed within reads
+    double period; //running estimate of us between samples; 0 if unknown
+    double jitter; //running estimate of mean absolute deviation from period; us
+    uint32_t _last; //us
+    bool _timed; //whether _last is valid
+    uint32_t _start; //us; when the current window began
+    bool _follow; //whether the next window follows straight on from the last
+} scale_timing_t;
+
+typedef struct {
+    mass_t mass;
+    double raw; //value before normalising
+    uint64_t time; //us since boot the reading was published
+    bool stable; //whether raw is within stable_tol of the previous reading
+} scale_reading_t;
+
 typedef struct {
     mass_unit_t unit;
     int32_t ref_unit;
     int32_t offset;
+    uint32_t stable_tol; //raw difference between readings considered stable
     scale_adaptor_t* _adaptor;
+    kalman_t _kalman;
+    volatile uint32_t _seq; //odd while _latest is being written
+    scale_reading_t _latest;
+    scale_timing_t _timing;
+#if SCALE_PERF_ENABLED
+    scale_perf_t _perf;
+#endif
 } scale_t;
 
+/**
+ * Acquires values into opt->buffer and sets len to the number obtained
+ */
+typedef bool (*scale_plan_acquire_t)(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    size_t* const len);
+
+/**
+ * Reduces len values in opt->buffer to a single value
+ */
+typedef bool (*scale_plan_reduce_t)(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val);
+
+/**
+ * A read plan is built once from a scale_options_t, which is validated and
+ * copied, and has the acquisition and reduction for its strategy and read
+ * type resolved to functions, so reading with the plan does not need to
+ * examine the options again.
+ */
+typedef struct {
+    scale_options_t opt;
+    scale_plan_acquire_t _acquire;
+    scale_plan_reduce_t _reduce; //NULL for streamed reads
+} scale_plan_t;
+
+/**
+ * The default plan's acquisition and reduction, which SCALE__PLAN_INIT
+ * refers to. Not for use on their own.
+ */
+bool scale__plan_acquire_samples(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    size_t* const len);
+
+bool scale__plan_reduce_median(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val);
+
+/**
+ * Initialiser for a scale_plan_t with the default options, which is the same
+ * as scale_plan_init would produce for them
+ */
+#define SCALE__PLAN_INIT(BUFFER, BUFFLEN, SAMPLES) {                            \
+    .opt = SCALE__OPTIONS_INIT(BUFFER, BUFFLEN, SAMPLES),                       \
+    ._acquire = scale__plan_acquire_samples,                                    \
+    ._reduce = scale__plan_reduce_median                                        \
+}
+
+/**
+ * Alignment in bytes of the buffer embedded by SCALE_DEFINE
+ */
+#define SCALE_BUFFER_ALIGN 8
+
+/**
+ * SCALE_DEFINE(NAME, N) defines NAME as a scale with an embedded buffer of
+ * N values. Its members are:
+ *
+ *  sc      the scale_t, to be initialised with scale_init
+ *  plan    a read plan built from the default options, using all of
+ *          buffer, with the default number of samples (or N if fewer)
+ *  opt     the plan's options; read only
+ *  buffer  the read buffer; SCALE_BUFFER_ALIGN aligned
+ *
+ * so the memory needed is fixed when linked, and the buffer cannot be too
+ * short for the number of samples. N is checked when compiled. The options
+ * are only kept in the plan, so to change them, copy *NAME.opt, change the
+ * copy and pass it to scale_plan_init(&NAME.plan, &copy). C only; prefix
+ * with static to limit its scope, eg.
+ *
+ *  static SCALE_DEFINE(front, 64);
+ *
+ *  scale_init(&front.sc, adaptor, mass_g, ref_unit, offset);
+ *  scale_plan_weight(&front.sc, &front.plan, &m);
+ */
+#define SCALE_DEFINE(NAME, N)                                                   \
+    struct {                                                                    \
+        _Static_assert((N) > 0, "scale buffer must hold at least one value");   \
+        scale_t sc;                                                             \
+        scale_plan_t plan;                                                      \
+        const scale_options_t* const opt;                                       \
+        int32_t buffer[(N)] __attribute__((aligned(SCALE_BUFFER_ALIGN)));       \
+    } NAME = {                                                                  \
+        .plan = SCALE__PLAN_INIT(                                               \
+            NAME.buffer,                                                        \
+            (N),                                                                \
+            (N) < SCALE_DEFAULT_SAMPLES ? (N) : SCALE_DEFAULT_SAMPLES),         \
+        .opt = &NAME.plan.opt                                                   \
+    }
+
 /**
  * @brief Initialise the scale with a hx711_t
  * 
@@ -85,6 +253,8 @@ typedef struct {
  * @param unit The mass_unit_t to output mass_t's in
  * @param ref_unit The reference unit to use (see: calibration)
  * @param offset The offset from 0 (see: calibration)
+ * 
+ * stable_tol is set to the magnitude of ref_unit (ie. one unit).
  */
 void scale_init(
     scale_t* const sc,
@@ -93,6 +263,46 @@ void scale_init(
     const int32_t ref_unit,
     const int32_t offset);
 
+/**
+ * @brief Returns a pointer to the scale's Kalman filter used by
+ * read_type_kalman. The filter's noise variances can be tuned through
+ * this pointer and its state persists between reads.
+ * 
+ * @param sc 
+ * @return kalman_t* 
+ */
+kalman_t* scale_get_kalman(
+    scale_t* const sc);
+
+/**
+ * @brief Converts a mass to the number of raw counts it spans on the scale,
+ * ignoring the offset and the sign of ref_unit
+ * 
+ * @param sc 
+ * @param m 
+ * @return int64_t 
+ */
+int64_t scale_mass_to_counts(
+    const scale_t* const sc,
+    const mass_t* const m);
+
+/**
+ * @brief Returns the number of counts raw is from the scale's offset in the
+ * direction of increasing weight. Comparing this against
+ * scale_mass_to_counts levels needs no floating point.
+ * 
+ * @param sc 
+ * @param raw 
+ * @return int64_t 
+ */
+static inline int64_t scale_raw_to_counts(
+    const scale_t* const sc,
+    const int32_t raw) {
+        return sc->ref_unit < 0
+            ? (int64_t)sc->offset - raw
+            : (int64_t)raw - sc->offset;
+}
+
 /**
  * @brief Adjusts a raw value to a normalised value according to the scale's
  * reference unit and offset. Returns true if the operation succeeded.
@@ -123,8 +333,27 @@ bool scale_get_values_samples(
     int32_t* const arr,
     const size_t len);
 
+/**
+ * @brief As scale_get_values_samples, and also sets each element of ts to the
+ * time in microseconds the corresponding value was obtained
+ * 
+ * @param sc 
+ * @param arr 
+ * @param ts May be NULL
+ * @param len 
+ * @return true 
+ * @return false 
+ */
+bool scale_get_values_samples_ts(
+    scale_t* const sc,
+    int32_t* const arr,
+    uint32_t* const ts,
+    const size_t len);
+
 /**
  * @brief Fills arr with as many number of samples as possible up to the timeout.
+ * If the adaptor reports its sample period, this returns as soon as the next
+ * sample could not arrive before the timeout rather than waiting it out.
  * Returns true if the operation succeeded.
  * 
  * @param sc 
@@ -142,6 +371,58 @@ bool scale_get_values_timeout(
     size_t* const len,
     const uint timeout);
 
+/**
+ * @brief As scale_get_values_timeout, and also sets each element of ts to the
+ * time in microseconds the corresponding value was obtained
+ * 
+ * @param sc 
+ * @param arr buffer
+ * @param ts May be NULL; otherwise arrlen long
+ * @param arrlen Size of buffer
+ * @param len Will be set to the number of samples obtained
+ * @param timeout Microseconds
+ * @return true 
+ * @return false 
+ */
+bool scale_get_values_timeout_ts(
+    scale_t* const sc,
+    int32_t* const arr,
+    uint32_t* const ts,
+    const size_t arrlen,
+    size_t* const len,
+    const uint timeout);
+
+/**
+ * @brief Sets timing to the scale's measured sample rate and jitter, and the
+ * number of samples missed. The time between separate reads is not counted.
+ * 
+ * @param sc 
+ * @param timing 
+ */
+void scale_get_timing(
+    const scale_t* const sc,
+    scale_timing_t* const timing);
+
+/**
+ * @brief Clears the scale's timing measurements
+ * 
+ * @param sc 
+ */
+void scale_reset_timing(
+    scale_t* const sc);
+
+#if SCALE_PERF_ENABLED
+/**
+ * @brief Returns the scale's counters and latency histograms. Only
+ * available when SCALE_PERF_ENABLED is 1.
+ * 
+ * @param sc 
+ * @return scale_perf_t* 
+ */
+scale_perf_t* scale_get_perf(
+    scale_t* const sc);
+#endif
+
 /**
  * @brief Obtains a value from the scale according to the given options. Returns
  * true if the operation succeeded.
@@ -157,6 +438,108 @@ bool scale_read(
     double* const val,
     const scale_options_t* const opt);
 
+/**
+ * @brief Obtains a value from the scale according to the given options and
+ * sets stats to the mean, variance, minimum, maximum and median of the
+ * samples it was calculated from. For read_type_median and read_type_average
+ * the value is taken from the statistics, so they cost nothing extra. For
+ * read_type_quantile the samples are not held, so stats->len is set to 0.
+ * The statistics are found by selection, which reorders opt->buffer; use
+ * scale_acquire and scale_reduce to see the samples in the order they were
+ * obtained. Returns true if the operation succeeded.
+ * 
+ * @param sc 
+ * @param val 
+ * @param stats May be NULL
+ * @param opt 
+ * @return true 
+ * @return false 
+ */
+bool scale_read_stats(
+    scale_t* const sc,
+    double* const val,
+    util_stats_t* const stats,
+    const scale_options_t* const opt);
+
+/**
+ * @brief Fills opt->buffer with samples according to opt->strat and sets len
+ * to the number obtained. Returns true if the operation succeeded.
+ * 
+ * @param sc 
+ * @param opt 
+ * @param len 
+ * @return true 
+ * @return false 
+ */
+bool scale_acquire(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    size_t* const len);
+
+/**
+ * @brief Reduces the first len samples in opt->buffer to a single value
+ * according to opt->read, after applying opt->notch if set. opt->buffer is
+ * modified. Returns false if there are no samples to reduce.
+ * 
+ * @param sc 
+ * @param val 
+ * @param stats May be NULL
+ * @param opt 
+ * @param len 
+ * @return true 
+ * @return false 
+ */
+bool scale_reduce(
+    scale_t* const sc,
+    double* const val,
+    util_stats_t* const stats,
+    const scale_options_t* const opt,
+    const size_t len);
+
+/**
+ * @brief Validates opt and builds a read plan from it. Returns false, leaving
+ * the plan unchanged, if the options cannot be read with (eg. the buffer is
+ * shorter than the number of samples).
+ * 
+ * @param plan 
+ * @param opt 
+ * @return true 
+ * @return false 
+ */
+bool scale_plan_init(
+    scale_plan_t* const plan,
+    const scale_options_t* const opt);
+
+/**
+ * @brief As scale_read, according to a plan. Returns true if the operation
+ * succeeded.
+ * 
+ * @param sc 
+ * @param plan 
+ * @param val 
+ * @return true 
+ * @return false 
+ */
+bool scale_plan_read(
+    scale_t* const sc,
+    const scale_plan_t* const plan,
+    double* const val);
+
+/**
+ * @brief As scale_weight, according to a plan. Returns true if the operation
+ * succeeded.
+ * 
+ * @param sc 
+ * @param plan 
+ * @param m 
+ * @return true 
+ * @return false 
+ */
+bool scale_plan_weight(
+    scale_t* const sc,
+    const scale_plan_t* const plan,
+    mass_t* const m);
+
 /**
  * @brief Zeros the scale (tare) by adjusting its offset from 0 according to
  * the given options. Returns true if the operation succeeded.
@@ -185,6 +568,36 @@ bool scale_weight(
     mass_t* const m,
     const scale_options_t* const opt);
 
+/**
+ * @brief Publishes a reading as the scale's latest. scale_weight calls this
+ * after every successful read. Only one core or context may publish for a
+ * given scale.
+ * 
+ * @param sc 
+ * @param raw 
+ * @param m 
+ */
+void scale_publish(
+    scale_t* const sc,
+    const double* const raw,
+    const mass_t* const m);
+
+/**
+ * @brief Copies the latest published reading into r without reading from the
+ * scale, so it can be called from any core or interrupt handler. Returns
+ * false if nothing has been published yet, or if a consistent copy could not
+ * be obtained within SCALE_LATEST_TIMEOUT us (eg. when an interrupt handler
+ * preempts the publisher on the same core).
+ * 
+ * @param sc 
+ * @param r 
+ * @return true 
+ * @return false 
+ */
+bool scale_get_latest(
+    const scale_t* const sc,
+    scale_reading_t* const r);
+
 #ifdef __cplusplus
 }
 #endif
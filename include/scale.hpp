@@ -0,0 +1,576 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SCALE_HPP_8C3F1A5E_7B2D_4E96_A4C0_5D19E2B7F36A
+#define SCALE_HPP_8C3F1A5E_7B2D_4E96_A4C0_5D19E2B7F36A
+
+/**
+ * Header-only C++ front end to the scale. Units are types rather than
+ * mass_unit_t values, so conversions between them are resolved at compile
+ * time to a single multiplication and division by constants, and the notch
+ * filter's coefficients are computed by the compiler for a given sample rate
+ * and mains frequency. The C API remains available alongside it.
+ *
+ * Requires C++17. std::span overloads are provided with C++20.
+ */
+
+#if __cplusplus < 201703L
+#error "scale.hpp requires C++17 or later"
+#endif
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <ratio>
+#include <type_traits>
+#include "filter.h"
+#include "mass.h"
+#include "scale.h"
+#include "scale_adaptor.h"
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define SCALE_HPP_HAS_SPAN 1
+#else
+#define SCALE_HPP_HAS_SPAN 0
+#endif
+
+namespace pico_scale {
+
+/**
+ * A unit of mass. Ratio is the number of micrograms per unit and Id is the
+ * equivalent mass_unit_t.
+ */
+template<mass_unit_t Id, class Ratio>
+struct Unit {
+    using ratio = typename Ratio::type;
+    static constexpr mass_unit_t id = Id;
+
+    static const char* name() {
+        return mass_unit_to_string(Id);
+    }
+};
+
+//these match MASS_RATIOS
+using micrograms = Unit<mass_ug, std::ratio<1>>;
+using milligrams = Unit<mass_mg, std::ratio<1000>>;
+using grams = Unit<mass_g, std::ratio<1000000>>;
+using kilograms = Unit<mass_kg, std::ratio<1000000000>>;
+using tonnes = Unit<mass_ton, std::ratio<1000000000000>>;
+using imperial_tons = Unit<mass_imp_ton, std::ratio<1016046908800>>;
+using us_tons = Unit<mass_us_ton, std::ratio<907184740000>>;
+using stones = Unit<mass_st, std::ratio<6350293180>>;
+using pounds = Unit<mass_lb, std::ratio<453592370>>;
+using ounces = Unit<mass_oz, std::ratio<226796185, 8>>;
+
+template<class U, class Rep = double>
+class Mass;
+
+namespace detail {
+
+template<class T>
+struct is_mass : std::false_type {};
+
+template<class U, class Rep>
+struct is_mass<Mass<U, Rep>> : std::true_type {};
+
+//the ratio to multiply a From value by to obtain a To value
+template<class From, class To>
+using mass_ratio = std::ratio_divide<
+    typename From::unit::ratio,
+    typename To::unit::ratio>;
+
+/**
+ * cos for use in constant expressions. x must be within [-pi, pi], where
+ * the series has converged to double precision well before the last term.
+ */
+constexpr double cos(const double x) {
+
+    double term = 1.0;
+    double sum = 1.0;
+
+    for(int k = 1; k <= 20; ++k) {
+        term *= -(x * x) / ((2.0 * k - 1.0) * (2.0 * k));
+        sum += term;
+    }
+
+    return sum;
+
+}
+
+constexpr int64_t round(const double x) {
+    return static_cast<int64_t>(x < 0 ? x - 0.5 : x + 0.5);
+}
+
+} //namespace detail
+
+/**
+ * @brief Converts a Mass to another unit and/or representation. As with
+ * std::chrono::duration_cast, the ratio between the units is known at
+ * compile time, so this is at most one multiplication and one division.
+ * 
+ * @tparam To Mass type to convert to
+ * @param m 
+ * @return constexpr To 
+ */
+template<class To, class U, class Rep>
+constexpr To mass_cast(const Mass<U, Rep>& m) {
+
+    static_assert(detail::is_mass<To>::value, "To must be a Mass");
+
+    using r = detail::mass_ratio<Mass<U, Rep>, To>;
+    using to_rep = typename To::rep;
+    using calc = std::common_type_t<Rep, to_rep, intmax_t>;
+
+    if constexpr(r::num == 1 && r::den == 1) {
+        return To(static_cast<to_rep>(m.value()));
+    }
+    else if constexpr(r::den == 1) {
+        return To(static_cast<to_rep>(static_cast<calc>(m.value()) * static_cast<calc>(r::num)));
+    }
+    else if constexpr(r::num == 1) {
+        return To(static_cast<to_rep>(static_cast<calc>(m.value()) / static_cast<calc>(r::den)));
+    }
+    else {
+        return To(static_cast<to_rep>(
+            static_cast<calc>(m.value()) * static_cast<calc>(r::num) / static_cast<calc>(r::den)));
+    }
+
+}
+
+/**
+ * A mass in a unit fixed at compile time. Conversions which cannot lose
+ * information (to a floating point representation, or to a smaller unit
+ * which is a whole multiple) are implicit; others require mass_cast.
+ */
+template<class U, class Rep>
+class Mass {
+public:
+    using unit = U;
+    using rep = Rep;
+
+    constexpr Mass() : _val() {
+    }
+
+    constexpr explicit Mass(const Rep val) : _val(val) {
+    }
+
+    template<
+        class U2,
+        class Rep2,
+        std::enable_if_t<
+            std::is_floating_point_v<Rep> ||
+            (detail::mass_ratio<Mass<U2, Rep2>, Mass>::den == 1 &&
+                !std::is_floating_point_v<Rep2>), int> = 0>
+    constexpr Mass(const Mass<U2, Rep2>& m) : _val(mass_cast<Mass>(m).value()) {
+    }
+
+    /**
+     * @brief Returns a Mass from a mass_t, which holds its value in
+     * micrograms regardless of its unit
+     * 
+     * @param m 
+     * @return Mass 
+     */
+    static constexpr Mass from(const mass_t& m) {
+        return mass_cast<Mass>(Mass<micrograms, double>(m.ug));
+    }
+
+    /**
+     * @brief Returns the equivalent mass_t for use with the C API
+     * 
+     * @return constexpr mass_t 
+     */
+    constexpr mass_t c() const {
+        return mass_t{
+            mass_cast<Mass<micrograms, double>>(*this).value(),
+            U::id
+        };
+    }
+
+    constexpr Rep value() const {
+        return _val;
+    }
+
+    template<class To>
+    constexpr Mass<To, Rep> to() const {
+        return mass_cast<Mass<To, Rep>>(*this);
+    }
+
+    constexpr Mass operator+() const {
+        return *this;
+    }
+
+    constexpr Mass operator-() const {
+        return Mass(-_val);
+    }
+
+    constexpr Mass& operator+=(const Mass& rhs) {
+        _val += rhs._val;
+        return *this;
+    }
+
+    constexpr Mass& operator-=(const Mass& rhs) {
+        _val -= rhs._val;
+        return *this;
+    }
+
+    constexpr Mass& operator*=(const Rep rhs) {
+        _val *= rhs;
+        return *this;
+    }
+
+    constexpr Mass& operator/=(const Rep rhs) {
+        _val /= rhs;
+        return *this;
+    }
+
+    friend constexpr Mass operator+(Mass lhs, const Mass& rhs) {
+        return lhs += rhs;
+    }
+
+    friend constexpr Mass operator-(Mass lhs, const Mass& rhs) {
+        return lhs -= rhs;
+    }
+
+    friend constexpr Mass operator*(Mass lhs, const Rep rhs) {
+        return lhs *= rhs;
+    }
+
+    friend constexpr Mass operator*(const Rep lhs, Mass rhs) {
+        return rhs *= lhs;
+    }
+
+    friend constexpr Mass operator/(Mass lhs, const Rep rhs) {
+        return lhs /= rhs;
+    }
+
+    friend constexpr Rep operator/(const Mass& lhs, const Mass& rhs) {
+        return lhs._val / rhs._val;
+    }
+
+    friend constexpr bool operator==(const Mass& lhs, const Mass& rhs) {
+        return lhs._val == rhs._val;
+    }
+
+    friend constexpr bool operator!=(const Mass& lhs, const Mass& rhs) {
+        return lhs._val != rhs._val;
+    }
+
+    friend constexpr bool operator<(const Mass& lhs, const Mass& rhs) {
+        return lhs._val < rhs._val;
+    }
+
+    friend constexpr bool operator>(const Mass& lhs, const Mass& rhs) {
+        return lhs._val > rhs._val;
+    }
+
+    friend constexpr bool operator<=(const Mass& lhs, const Mass& rhs) {
+        return lhs._val <= rhs._val;
+    }
+
+    friend constexpr bool operator>=(const Mass& lhs, const Mass& rhs) {
+        return lhs._val >= rhs._val;
+    }
+
+private:
+    Rep _val;
+};
+
+namespace literals {
+
+constexpr Mass<micrograms> operator""_ug(const long double v) { return Mass<micrograms>(static_cast<double>(v)); }
+constexpr Mass<micrograms> operator""_ug(const unsigned long long v) { return Mass<micrograms>(static_cast<double>(v)); }
+constexpr Mass<milligrams> operator""_mg(const long double v) { return Mass<milligrams>(static_cast<double>(v)); }
+constexpr Mass<milligrams> operator""_mg(const unsigned long long v) { return Mass<milligrams>(static_cast<double>(v)); }
+constexpr Mass<grams> operator""_g(const long double v) { return Mass<grams>(static_cast<double>(v)); }
+constexpr Mass<grams> operator""_g(const unsigned long long v) { return Mass<grams>(static_cast<double>(v)); }
+constexpr Mass<kilograms> operator""_kg(const long double v) { return Mass<kilograms>(static_cast<double>(v)); }
+constexpr Mass<kilograms> operator""_kg(const unsigned long long v) { return Mass<kilograms>(static_cast<double>(v)); }
+constexpr Mass<stones> operator""_st(const long double v) { return Mass<stones>(static_cast<double>(v)); }
+constexpr Mass<stones> operator""_st(const unsigned long long v) { return Mass<stones>(static_cast<double>(v)); }
+constexpr Mass<pounds> operator""_lb(const long double v) { return Mass<pounds>(static_cast<double>(v)); }
+constexpr Mass<pounds> operator""_lb(const unsigned long long v) { return Mass<pounds>(static_cast<double>(v)); }
+constexpr Mass<ounces> operator""_oz(const long double v) { return Mass<ounces>(static_cast<double>(v)); }
+constexpr Mass<ounces> operator""_oz(const unsigned long long v) { return Mass<ounces>(static_cast<double>(v)); }
+
+} //namespace literals
+
+/**
+ * A notch filter for a sample rate and mains frequency known at compile
+ * time. The coefficients are identical to those filter_notch_init would
+ * calculate, and notch can be given to scale_options_t.notch.
+ */
+template<uint Sps, filter_mains_t Mains>
+class NotchFilter {
+    static_assert(Sps > 0, "Sps must be greater than 0");
+
+    //see filter_notch_init
+    static constexpr int _m = static_cast<int>(Mains);
+    static constexpr int _s = static_cast<int>(Sps);
+    static constexpr int _alias_signed = _m - (((_m + (_s / 2)) / _s) * _s);
+    static constexpr int _alias = _alias_signed < 0 ? -_alias_signed : _alias_signed;
+    static constexpr bool _enabled = _alias * 20 >= _s;
+    static constexpr double _c = detail::cos((2.0 * 3.14159265358979323846 * _alias) / _s);
+    static constexpr double _g = _enabled ? 1.0 / (2.0 - (2.0 * _c)) : 0.0;
+    static constexpr double _one = static_cast<double>(1 << FILTER_NOTCH_Q);
+
+public:
+    static constexpr bool enabled = _enabled;
+    static constexpr int64_t g0 = enabled ? detail::round(_g * _one) : 0;
+    static constexpr int64_t g1 = enabled ? detail::round(-2.0 * _c * _g * _one) : 0;
+    static constexpr filter_notch_t notch = { enabled, g0, g1 };
+
+    /**
+     * @brief As filter_notch_apply, with the coefficients as constants
+     * 
+     * @param arr 
+     * @param len 
+     * @return size_t 
+     */
+    static size_t apply(
+        int32_t* const arr,
+        const size_t len) {
+
+            assert(arr != NULL);
+
+            if constexpr(!enabled) {
+                return len;
+            }
+            else {
+
+                if(len <= FILTER_NOTCH_DELAY) {
+                    return len;
+                }
+
+                constexpr int64_t round = INT64_C(1) << (FILTER_NOTCH_Q - 1);
+                int32_t x2 = arr[0];
+                int32_t x1 = arr[1];
+
+                for(size_t i = FILTER_NOTCH_DELAY; i < len; ++i) {
+
+                    const int32_t x0 = arr[i];
+
+                    const int64_t acc =
+                        (static_cast<int64_t>(x0) + x2) * g0 +
+                        static_cast<int64_t>(x1) * g1;
+
+                    arr[i - FILTER_NOTCH_DELAY] = static_cast<int32_t>((acc + round) >> FILTER_NOTCH_Q);
+
+                    x2 = x1;
+                    x1 = x0;
+
+                }
+
+                return len - FILTER_NOTCH_DELAY;
+
+            }
+
+    }
+
+#if SCALE_HPP_HAS_SPAN
+    /**
+     * @brief Filters arr in-place and returns the filtered values
+     * 
+     * @param arr 
+     * @return std::span<int32_t> 
+     */
+    static std::span<int32_t> apply(
+        const std::span<int32_t> arr) {
+            return arr.first(apply(arr.data(), arr.size()));
+    }
+#endif
+
+};
+
+/**
+ * scale_options_t with the read buffer taken from an array (or span), so
+ * its length is always correct.
+ */
+class Options {
+public:
+    Options() {
+        scale_options_get_default(&_opt);
+    }
+
+    template<size_t N>
+    explicit Options(int32_t (&buffer)[N]) : Options() {
+        set_buffer(buffer, N);
+    }
+
+#if SCALE_HPP_HAS_SPAN
+    explicit Options(const std::span<int32_t> buffer) : Options() {
+        set_buffer(buffer.data(), buffer.size());
+    }
+#endif
+
+    void set_buffer(
+        int32_t* const buffer,
+        const size_t len) {
+            _opt.buffer = buffer;
+            _opt.bufflen = len;
+    }
+
+    scale_options_t* operator->() {
+        return &_opt;
+    }
+
+    const scale_options_t* operator->() const {
+        return &_opt;
+    }
+
+    operator const scale_options_t&() const {
+        return _opt;
+    }
+
+private:
+    scale_options_t _opt;
+};
+
+/**
+ * A scale whose weights are in U. Values are normalised straight into a
+ * Mass<U> and converted to other units at compile time, rather than through
+ * MASS_RATIOS.
+ */
+template<class U>
+class Scale {
+public:
+    using unit = U;
+    using mass = Mass<U>;
+
+    Scale(
+        scale_adaptor_t* const adaptor,
+        const int32_t ref_unit,
+        const int32_t offset) {
+            scale_init(&_sc, adaptor, U::id, ref_unit, offset);
+    }
+
+    //the scale_t may be referred to by a scheduler or pipeline
+    Scale(const Scale&) = delete;
+    Scale& operator=(const Scale&) = delete;
+
+    scale_t* c() {
+        return &_sc;
+    }
+
+    const scale_t* c() const {
+        return &_sc;
+    }
+
+    bool read(
+        double& raw,
+        const scale_options_t& opt) {
+            return scale_read(&_sc, &raw, &opt);
+    }
+
+    bool zero(
+        const scale_options_t& opt) {
+            return scale_zero(&_sc, &opt);
+    }
+
+    /**
+     * @brief Obtains a weight from the scale and publishes it as scale_weight
+     * does. Returns true if the operation succeeded.
+     * 
+     * @param m 
+     * @param opt 
+     * @return true 
+     * @return false 
+     */
+    bool weight(
+        mass& m,
+        const scale_options_t& opt) {
+
+            double raw;
+            double val;
+
+            if(!scale_read(&_sc, &raw, &opt)) {
+                return false;
+            }
+
+            if(!scale_normalise(&_sc, &raw, &val)) {
+                return false;
+            }
+
+            m = mass(val);
+
+            const mass_t cm = m.c();
+            scale_publish(&_sc, &raw, &cm);
+
+            return true;
+
+    }
+
+    template<class U2, class Rep>
+    bool weight(
+        Mass<U2, Rep>& m,
+        const scale_options_t& opt) {
+
+            mass tmp;
+
+            if(!weight(tmp, opt)) {
+                return false;
+            }
+
+            m = mass_cast<Mass<U2, Rep>>(tmp);
+            return true;
+
+    }
+
+    /**
+     * @brief Obtains the most recently published weight; see scale_get_latest
+     * 
+     * @param m 
+     * @param r Optional; the full reading
+     * @return true 
+     * @return false 
+     */
+    bool latest(
+        mass& m,
+        scale_reading_t* const r = nullptr) const {
+
+            scale_reading_t tmp;
+            scale_reading_t* const out = r != nullptr ? r : &tmp;
+
+            if(!scale_get_latest(&_sc, out)) {
+                return false;
+            }
+
+            m = mass::from(out->mass);
+            return true;
+
+    }
+
+#if SCALE_HPP_HAS_SPAN
+    bool get_values(
+        const std::span<int32_t> arr) {
+            return scale_get_values_samples(&_sc, arr.data(), arr.size());
+    }
+#endif
+
+private:
+    scale_t _sc;
+};
+
+} //namespace pico_scale
+
+#endif
@@ -0,0 +1,316 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SCALE_ACQUIRE_H_3D7B5E19_8A42_4C6F_B1E0_94F2C6A83D57
+#define SCALE_ACQUIRE_H_3D7B5E19_8A42_4C6F_B1E0_94F2C6A83D57
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "scale.h"
+#include "scale_adaptor.h"
+#include "scale_internal.h"
+#include "scale_perf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The acquisition loops shared by the runtime scale functions (through the
+ * scale_adaptor_t function pointers) and SCALE_BIND (through direct calls).
+ * Not for use on its own.
+ *
+ * SCALE__ACQUIRE_DEFINE generates the following static inline functions for
+ * an adaptor of type TYPE, where GET_VALUE, GET_VALUE_TIMEOUT,
+ * GET_VALUE_NOBLOCK and GET_TIME are as described for SCALE_BIND:
+ *
+ *  NAME__value_time(a)
+ *  NAME__get_values_samples(sc, a, arr, ts, len, period)
+ *  NAME__get_values_timeout(sc, a, arr, ts, arrlen, len, end, period)
+ *  NAME__get_values_aligned(sc, a, arr, ts, arrlen, len, timeout, period)
+ *  NAME__acquire(sc, a, opt, len)
+ *
+ * The first three continue a window begun with scale__window_begin, so
+ * they can be called more than once within a window. Values the adaptor
+ * says were captured before the window began are discarded. NAME__acquire
+ * begins a window itself and counts it in the scale's perf counters.
+ */
+
+/**
+ * @brief Begins a new window of values and returns the adaptor's period
+ * in us, or 0 if unknown
+ * 
+ * @param sc 
+ * @return uint 
+ */
+static inline uint scale__window_begin(
+    scale_t* const sc) {
+
+        uint period = 0;
+
+        scale_adaptor_get_period(sc->_adaptor, &period);
+        scale__timing_begin(sc);
+
+        return period;
+
+}
+
+#define SCALE__ACQUIRE_DEFINE(                                                  \
+    NAME,                                                                       \
+    TYPE,                                                                       \
+    GET_VALUE,                                                                  \
+    GET_VALUE_TIMEOUT,                                                          \
+    GET_VALUE_NOBLOCK,                                                          \
+    GET_TIME)                                                                   \
+                                                                                \
+/* when the value just obtained was captured; if the adaptor */               \
+/* cannot tell, it was just now */                                              \
+static inline uint32_t NAME##__value_time(                                      \
+    TYPE* const a) {                                                            \
+                                                                                \
+        uint32_t time;                                                          \
+                                                                                \
+        if(!GET_TIME(a, &time)) {                                               \
+            time = time_us_32();                                                \
+        }                                                                       \
+                                                                                \
+        return time;                                                            \
+                                                                                \
+}                                                                               \
+                                                                                \
+static inline bool NAME##__get_values_samples(                                  \
+    scale_t* const sc,                                                          \
+    TYPE* const a,                                                              \
+    int32_t* const arr,                                                         \
+    uint32_t* const ts,                                                         \
+    const size_t len,                                                           \
+    const uint period) {                                                        \
+                                                                                \
+        for(size_t i = 0; i < len;) {                                           \
+                                                                                \
+            if(!GET_VALUE(a, &arr[i])) {                                        \
+                return false;                                                   \
+            }                                                                   \
+                                                                                \
+            const uint32_t now = NAME##__value_time(a);                         \
+                                                                                \
+            if(scale__timing_is_stale(sc, now)) {                               \
+                continue;                                                       \
+            }                                                                   \
+                                                                                \
+            if(ts != NULL) {                                                    \
+                ts[i] = now;                                                    \
+            }                                                                   \
+                                                                                \
+            scale__timing_record(sc, now, period);                              \
+            ++i;                                                                \
+                                                                                \
+        }                                                                       \
+                                                                                \
+        return true;                                                            \
+                                                                                \
+}                                                                               \
+                                                                                \
+static inline bool NAME##__get_values_timeout(                                  \
+    scale_t* const sc,                                                          \
+    TYPE* const a,                                                              \
+    int32_t* const arr,                                                         \
+    uint32_t* const ts,                                                         \
+    const size_t arrlen,                                                        \
+    size_t* const len,                                                          \
+    const absolute_time_t end,                                                  \
+    const uint period) {                                                        \
+                                                                                \
+        *len = 0;                                                               \
+                                                                                \
+        while(*len < arrlen) {                                                  \
+                                                                                \
+            /* update the time diff between now and the end */                  \
+            const int64_t diff = absolute_time_diff_us(                         \
+                get_absolute_time(),                                            \
+                end);                                                           \
+                                                                                \
+            if(diff <= 0) {                                                     \
+                break;                                                          \
+            }                                                                   \
+                                                                                \
+            /* a value has just arrived, so the next one is a whole */          \
+            /* period away. If that is after the end there is no */             \
+            /* point waiting for it, but any already waiting are taken */       \
+            const bool wait = *len == 0 || diff >= (int64_t)period;             \
+                                                                                \
+            /* the last call might fail because there is little time */        \
+            /* left, so fail only if no values were read at all */              \
+            const bool got = wait                                               \
+                ? GET_VALUE_TIMEOUT(a, &arr[*len], (uint)diff)                  \
+                : GET_VALUE_NOBLOCK(a, &arr[*len]);                             \
+                                                                                \
+            if(!got) {                                                          \
+                break;                                                          \
+            }                                                                   \
+                                                                                \
+            const uint32_t now = NAME##__value_time(a);                         \
+                                                                                \
+            if(scale__timing_is_stale(sc, now)) {                               \
+                continue;                                                       \
+            }                                                                   \
+                                                                                \
+            if(ts != NULL) {                                                    \
+                ts[*len] = now;                                                 \
+            }                                                                   \
+                                                                                \
+            scale__timing_record(sc, now, period);                              \
+            ++(*len);                                                           \
+                                                                                \
+        }                                                                       \
+                                                                                \
+        return *len > 0;                                                        \
+                                                                                \
+}                                                                               \
+                                                                                \
+static inline bool NAME##__get_values_aligned(                                  \
+    scale_t* const sc,                                                          \
+    TYPE* const a,                                                              \
+    int32_t* const arr,                                                         \
+    uint32_t* const ts,                                                         \
+    const size_t arrlen,                                                        \
+    size_t* const len,                                                          \
+    const uint timeout,                                                         \
+    const uint period) {                                                        \
+                                                                                \
+        *len = 0;                                                               \
+                                                                                \
+        const absolute_time_t first = make_timeout_time_us(timeout);           \
+        uint32_t now;                                                           \
+                                                                                \
+        /* the window starts when the first value arrives, so every */          \
+        /* window of the same length holds the same number of values */         \
+        do {                                                                    \
+                                                                                \
+            const int64_t diff = absolute_time_diff_us(                         \
+                get_absolute_time(),                                            \
+                first);                                                         \
+                                                                                \
+            if(diff <= 0 || !GET_VALUE_TIMEOUT(a, &arr[0], (uint)diff)) {       \
+                return false;                                                   \
+            }                                                                   \
+                                                                                \
+            now = NAME##__value_time(a);                                        \
+                                                                                \
+        } while(scale__timing_is_stale(sc, now));                               \
+                                                                                \
+        if(ts != NULL) {                                                        \
+            ts[0] = now;                                                        \
+        }                                                                       \
+                                                                                \
+        /* the rest of the window follows on from this value */                 \
+        scale__timing_record(sc, now, period);                                  \
+                                                                                \
+        if(arrlen > 1) {                                                        \
+            NAME##__get_values_timeout(                                         \
+                sc,                                                             \
+                a,                                                              \
+                arr + 1,                                                        \
+                ts != NULL ? ts + 1 : NULL,                                     \
+                arrlen - 1,                                                     \
+                len,                                                            \
+                make_timeout_time_us(timeout),                                  \
+                period);                                                        \
+        }                                                                       \
+                                                                                \
+        ++(*len);                                                               \
+                                                                                \
+        return true;                                                            \
+                                                                                \
+}                                                                               \
+                                                                                \
+static inline bool NAME##__acquire(                                             \
+    scale_t* const sc,                                                          \
+    TYPE* const a,                                                              \
+    const scale_options_t* const opt,                                           \
+    size_t* const len) {                                                        \
+                                                                                \
+        bool ok;                                                                \
+                                                                                \
+        SCALE_PERF_COUNT(&sc->_perf, reads);                                    \
+        SCALE_PERF_BEGIN(start);                                                \
+                                                                                \
+        const uint period = scale__window_begin(sc);                            \
+                                                                                \
+        if(opt->strat == strategy_type_time) {                                  \
+            ok = opt->align                                                     \
+                ? NAME##__get_values_aligned(                                   \
+                    sc,                                                         \
+                    a,                                                          \
+                    opt->buffer,                                                \
+                    opt->timestamps,                                            \
+                    opt->bufflen,                                               \
+                    len,                                                        \
+                    opt->timeout,                                               \
+                    period)                                                     \
+                : NAME##__get_values_timeout(                                   \
+                    sc,                                                         \
+                    a,                                                          \
+                    opt->buffer,                                                \
+                    opt->timestamps,                                            \
+                    opt->bufflen,                                               \
+                    len,                                                        \
+                    make_timeout_time_us(opt->timeout),                         \
+                    period);                                                    \
+        }                                                                       \
+        else {                                                                  \
+            assert(opt->bufflen >= opt->samples);                               \
+            *len = opt->samples;                                                \
+            ok = NAME##__get_values_samples(                                    \
+                sc,                                                             \
+                a,                                                              \
+                opt->buffer,                                                    \
+                opt->timestamps,                                                \
+                *len,                                                           \
+                period);                                                        \
+        }                                                                       \
+                                                                                \
+        SCALE_PERF_END(&sc->_perf, scale_perf_stage_acquire, start);            \
+                                                                                \
+        /* a time window fails only when nothing arrives in time; */            \
+        /* a sample count fails only when the adaptor does */                   \
+        if(!ok) {                                                               \
+            if(opt->strat == strategy_type_time) {                              \
+                SCALE_PERF_COUNT(&sc->_perf, timeouts);                         \
+            }                                                                   \
+            else {                                                              \
+                SCALE_PERF_COUNT(&sc->_perf, failures);                         \
+            }                                                                   \
+        }                                                                       \
+                                                                                \
+        return ok;                                                              \
+                                                                                \
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
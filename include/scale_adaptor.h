@@ -58,6 +58,41 @@ typedef struct scale_adaptor {
         int32_t* const value,
         const uint timeout);
 
+    /**
+     * @brief Optional function pointer to function which sets value only
+     * if one is available without waiting. NULL if not supported.
+     * @param sa pointer to scale adaptor
+     * @param value value to be set
+     */
+    bool (*get_value_noblock)(
+        struct scale_adaptor* const sa,
+        int32_t* const value);
+
+    /**
+     * @brief Optional function pointer to function which reports the
+     * time between values. NULL if the adaptor cannot tell.
+     * @param sa pointer to scale adaptor
+     * @param nominal nominal period in microseconds to be set
+     * @param measured measured period in microseconds to be set; 0 until
+     * enough values have been obtained to measure it
+     */
+    bool (*get_period)(
+        struct scale_adaptor* const sa,
+        uint* const nominal,
+        uint* const measured);
+
+    /**
+     * @brief Optional function pointer to function which reports when the
+     * value most recently obtained from the adaptor was captured, which
+     * may be well before it was obtained if the adaptor buffers values.
+     * NULL if the adaptor cannot tell.
+     * @param sa pointer to scale adaptor
+     * @param time us on the time_us_32 clock to be set
+     */
+    bool (*get_time)(
+        struct scale_adaptor* const sa,
+        uint32_t* const time);
+
 } scale_adaptor_t;
 
 bool scale_adaptor_init(
@@ -67,6 +102,49 @@ bool scale_adaptor_init(
 void* scale_adaptor_get_data(
     scale_adaptor_t* const sa);
 
+/**
+ * @brief Sets value if one is available from the adaptor without waiting.
+ * Uses get_value_noblock if the adaptor has it, otherwise get_value_timeout
+ * with a timeout of 0. Returns true if value was set.
+ * 
+ * @param sa 
+ * @param value 
+ * @return true 
+ * @return false 
+ */
+bool scale_adaptor_get_value_noblock(
+    scale_adaptor_t* const sa,
+    int32_t* const value);
+
+/**
+ * @brief Sets period to the best known time between values from the
+ * adaptor in microseconds: the measured period if there is one, otherwise
+ * the nominal period. Returns false if the adaptor cannot tell.
+ * 
+ * @param sa 
+ * @param period 
+ * @return true 
+ * @return false 
+ */
+bool scale_adaptor_get_period(
+    scale_adaptor_t* const sa,
+    uint* const period);
+
+/**
+ * @brief Sets time to when the value most recently obtained from the adaptor
+ * was captured, in us on the time_us_32 clock. Returns false if the adaptor
+ * cannot tell, in which case the time the value was obtained is the best
+ * estimate.
+ * 
+ * @param sa 
+ * @param time 
+ * @return true 
+ * @return false 
+ */
+bool scale_adaptor_get_time(
+    scale_adaptor_t* const sa,
+    uint32_t* const time);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,177 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SCALE_BOUND_H_6A1D93F2_C4E7_4B0A_8D25_3F7B19E60C84
+#define SCALE_BOUND_H_6A1D93F2_C4E7_4B0A_8D25_3F7B19E60C84
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "mass.h"
+#include "scale.h"
+#include "scale_acquire.h"
+#include "scale_adaptor.h"
+#include "scale_internal.h"
+#include "scale_perf.h"
+#include "util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * SCALE_BIND generates a set of scale functions specialised for a single,
+ * known adaptor type. Where scale_read and friends go through the
+ * scale_adaptor_t function pointers (and the adaptor's scale_adaptor_get_data
+ * and wrapper) once per value, the generated functions call the given
+ * functions directly, so the compiler can inline the adaptor into the
+ * acquisition loop.
+ *
+ * GET_VALUE, GET_VALUE_TIMEOUT, GET_VALUE_NOBLOCK and GET_TIME take the
+ * concrete adaptor rather than its scale_adaptor_t:
+ *
+ *  bool GET_VALUE(TYPE* const a, int32_t* const value);
+ *  bool GET_VALUE_TIMEOUT(TYPE* const a, int32_t* const value, const uint timeout);
+ *  bool GET_VALUE_NOBLOCK(TYPE* const a, int32_t* const value);
+ *  bool GET_TIME(TYPE* const a, uint32_t* const time);
+ *
+ * and are best made static inline. The following are generated:
+ *
+ *  NAME_get_values_samples(sc, a, arr, ts, len)
+ *  NAME_get_values_timeout(sc, a, arr, ts, arrlen, len, timeout)
+ *  NAME_read(sc, a, val, opt)
+ *  NAME_weight(sc, a, m, opt)
+ *
+ * which behave as their scale_* counterparts (ts may be NULL). The scale_t
+ * must have been initialised with the same adaptor's base, which is still
+ * used for things only needed once per read, such as its period. The runtime
+ * API remains usable on the same scale_t and adaptor. Streamed quantile reads
+ * are passed through to the runtime implementation. The acquisition loops
+ * are generated from the same source as the runtime ones; see
+ * scale_acquire.h.
+ */
+#define SCALE_BIND(                                                             \
+    NAME,                                                                       \
+    TYPE,                                                                       \
+    GET_VALUE,                                                                  \
+    GET_VALUE_TIMEOUT,                                                          \
+    GET_VALUE_NOBLOCK,                                                          \
+    GET_TIME)                                                                   \
+                                                                                \
+SCALE__ACQUIRE_DEFINE(                                                          \
+    NAME,                                                                       \
+    TYPE,                                                                       \
+    GET_VALUE,                                                                  \
+    GET_VALUE_TIMEOUT,                                                          \
+    GET_VALUE_NOBLOCK,                                                          \
+    GET_TIME)                                                                   \
+                                                                                \
+static inline bool NAME##_get_values_samples(                                   \
+    scale_t* const sc,                                                          \
+    TYPE* const a,                                                              \
+    int32_t* const arr,                                                         \
+    uint32_t* const ts,                                                         \
+    const size_t len) {                                                         \
+                                                                                \
+        assert(sc != NULL);                                                     \
+        assert(a != NULL);                                                      \
+        assert(arr != NULL);                                                    \
+                                                                                \
+        const uint period = scale__window_begin(sc);                            \
+                                                                                \
+        return NAME##__get_values_samples(sc, a, arr, ts, len, period);         \
+                                                                                \
+}                                                                               \
+                                                                                \
+static inline bool NAME##_get_values_timeout(                                   \
+    scale_t* const sc,                                                          \
+    TYPE* const a,                                                              \
+    int32_t* const arr,                                                         \
+    uint32_t* const ts,                                                         \
+    const size_t arrlen,                                                        \
+    size_t* const len,                                                          \
+    const uint timeout) {                                                       \
+                                                                                \
+        assert(sc != NULL);                                                     \
+        assert(a != NULL);                                                      \
+        assert(arr != NULL);                                                    \
+        assert(arrlen > 0);                                                     \
+        assert(len != NULL);                                                    \
+                                                                                \
+        const absolute_time_t end = make_timeout_time_us(timeout);              \
+        const uint period = scale__window_begin(sc);                            \
+                                                                                \
+        return NAME##__get_values_timeout(                                      \
+            sc, a, arr, ts, arrlen, len, end, period);                          \
+                                                                                \
+}                                                                               \
+                                                                                \
+static inline bool NAME##_read(                                                 \
+    scale_t* const sc,                                                          \
+    TYPE* const a,                                                              \
+    double* const val,                                                          \
+    const scale_options_t* const opt) {                                         \
+                                                                                \
+        assert(sc != NULL);                                                     \
+        assert(a != NULL);                                                      \
+        assert(val != NULL);                                                    \
+        assert(opt != NULL);                                                    \
+                                                                                \
+        if(opt->read == read_type_quantile) {                                   \
+            return scale_read(sc, val, opt);                                    \
+        }                                                                       \
+                                                                                \
+        size_t len;                                                             \
+                                                                                \
+        if(!NAME##__acquire(sc, a, opt, &len)) {                                \
+            return false;                                                       \
+        }                                                                       \
+                                                                                \
+        return scale_reduce(sc, val, NULL, opt, len);                           \
+                                                                                \
+}                                                                               \
+                                                                                \
+static inline bool NAME##_weight(                                               \
+    scale_t* const sc,                                                          \
+    TYPE* const a,                                                              \
+    mass_t* const m,                                                            \
+    const scale_options_t* const opt) {                                         \
+                                                                                \
+        assert(m != NULL);                                                      \
+                                                                                \
+        double raw;                                                             \
+                                                                                \
+        if(!NAME##_read(sc, a, &raw, opt)) {                                    \
+            return false;                                                       \
+        }                                                                       \
+                                                                                \
+        return scale__complete(sc, &raw, m);                                    \
+                                                                                \
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SCALE_EVENTS_H_0F6D2B84_C93E_47A1_9D58_E27B41A6C3D9
+#define SCALE_EVENTS_H_0F6D2B84_C93E_47A1_9D58_E27B41A6C3D9
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/types.h"
+#include "mass.h"
+#include "scale.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of subscriptions per scale_events_t
+ */
+#define SCALE_EVENTS_MAX_SUBS 8
+
+typedef enum {
+    scale_event_rise = 0, //weight rose to or above a threshold
+    scale_event_fall, //weight fell below a threshold less its hysteresis
+    scale_event_enter, //weight entered a band
+    scale_event_exit, //weight left a band plus its hysteresis
+    scale_event_delta //weight changed by at least delta since the last event
+} scale_event_type_t;
+
+typedef enum {
+    scale_subscription_threshold = 0,
+    scale_subscription_band,
+    scale_subscription_delta
+} scale_subscription_type_t;
+
+/**
+ * @brief Function called when a subscribed event occurs
+ * @param ev the event
+ * @param m the weight of the sample which caused the event
+ * @param data arbitrary user data given when subscribing
+ */
+typedef void (*scale_event_callback_t)(
+    const scale_event_type_t ev,
+    const mass_t* const m,
+    void* const data);
+
+typedef struct {
+    scale_subscription_type_t _type;
+    scale_event_callback_t _callback;
+    void* _data;
+    int64_t _lo; //threshold, lower band edge or delta; in counts from offset
+    int64_t _hi; //upper band edge; in counts from offset
+    int64_t _hyst; //in counts
+    uint _debounce; //consecutive samples needed to change state
+    uint _pending; //consecutive samples seen so far
+    int64_t _ref; //count at the last delta event
+    bool _state; //above the threshold or inside the band
+    bool _primed; //whether _state/_ref have been set from a sample
+} scale_subscription_t;
+
+/**
+ * Subscriptions to weight changes of one scale, evaluated on
+ * each raw sample. Levels are converted to raw counts once when
+ * subscribing, so evaluating a sample is integer comparisons only.
+ */
+typedef struct {
+    scale_t* _sc;
+    scale_subscription_t _subs[SCALE_EVENTS_MAX_SUBS];
+    size_t _count;
+} scale_events_t;
+
+/**
+ * @brief Initialises an empty set of subscriptions for sc. Levels are
+ * relative to the scale's offset at the time each sample is evaluated, so
+ * zeroing the scale does not require subscribing again. Changing the
+ * scale's ref_unit does.
+ * 
+ * @param evs 
+ * @param sc 
+ */
+void scale_events_init(
+    scale_events_t* const evs,
+    scale_t* const sc);
+
+/**
+ * @brief Subscribes to the weight rising to or above level and falling below
+ * level less hysteresis. Returns false if there is no room.
+ * 
+ * @param evs 
+ * @param level 
+ * @param hysteresis 
+ * @param debounce number of consecutive samples needed to change state
+ * @param callback 
+ * @param data arbitrary user data passed to callback
+ * @return true 
+ * @return false 
+ */
+bool scale_events_subscribe_threshold(
+    scale_events_t* const evs,
+    const mass_t* const level,
+    const mass_t* const hysteresis,
+    const uint debounce,
+    const scale_event_callback_t callback,
+    void* const data);
+
+/**
+ * @brief Subscribes to the weight entering [lo, hi] and leaving
+ * [lo - hysteresis, hi + hysteresis]. Returns false if there is no room.
+ * 
+ * @param evs 
+ * @param lo 
+ * @param hi 
+ * @param hysteresis 
+ * @param debounce number of consecutive samples needed to change state
+ * @param callback 
+ * @param data arbitrary user data passed to callback
+ * @return true 
+ * @return false 
+ */
+bool scale_events_subscribe_band(
+    scale_events_t* const evs,
+    const mass_t* const lo,
+    const mass_t* const hi,
+    const mass_t* const hysteresis,
+    const uint debounce,
+    const scale_event_callback_t callback,
+    void* const data);
+
+/**
+ * @brief Subscribes to the weight changing by at least delta from the weight
+ * at the last delta event. Returns false if there is no room.
+ * 
+ * @param evs 
+ * @param delta 
+ * @param debounce number of consecutive samples needed to raise the event
+ * @param callback 
+ * @param data arbitrary user data passed to callback
+ * @return true 
+ * @return false 
+ */
+bool scale_events_subscribe_delta(
+    scale_events_t* const evs,
+    const mass_t* const delta,
+    const uint debounce,
+    const scale_event_callback_t callback,
+    void* const data);
+
+/**
+ * @brief Evaluates every subscription against a raw sample from the scale
+ * 
+ * @param evs 
+ * @param raw 
+ */
+void scale_events_feed(
+    scale_events_t* const evs,
+    const int32_t raw);
+
+/**
+ * @brief Evaluates every subscription against each raw sample in arr
+ * 
+ * @param evs 
+ * @param arr array of values
+ * @param len number of values in the array
+ */
+void scale_events_feed_all(
+    scale_events_t* const evs,
+    const int32_t* const arr,
+    const size_t len);
+
+scale_subscription_t* scale_events__add(
+    scale_events_t* const evs,
+    const scale_subscription_type_t type,
+    const uint debounce,
+    const scale_event_callback_t callback,
+    void* const data);
+
+bool scale_events__debounce(
+    scale_subscription_t* const sub,
+    const bool changing);
+
+void scale_events__raise(
+    const scale_events_t* const evs,
+    const scale_subscription_t* const sub,
+    const scale_event_type_t ev,
+    const int32_t raw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,190 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SCALE_INTERNAL_H_09146CFF_DBCF_48BA_8E5C_D938F1EBC554
+#define SCALE_INTERNAL_H_09146CFF_DBCF_48BA_8E5C_D938F1EBC554
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mass.h"
+#include "scale.h"
+#include "util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The scale's internals, shared by the scale, the scheduler, the pipeline
+ * and the bound acquisition loops. Not for use on its own.
+ */
+
+/**
+ * @brief Waits for a value and then fills the rest of arr with as many samples
+ * as possible up to the timeout from when it arrived. Used by scale_read
+ * when opt->align is set.
+ * 
+ * @param sc 
+ * @param arr buffer
+ * @param ts May be NULL; otherwise arrlen long
+ * @param arrlen Size of buffer
+ * @param len Will be set to the number of samples obtained
+ * @param timeout Microseconds
+ * @return true 
+ * @return false 
+ */
+bool scale__get_values_aligned(
+    scale_t* const sc,
+    int32_t* const arr,
+    uint32_t* const ts,
+    const size_t arrlen,
+    size_t* const len,
+    const uint timeout);
+
+/**
+ * @brief Begins a window of values. Values captured before it began are
+ * stale, unless scale__timing_follow was called, in which case the window
+ * starts where the last one ended.
+ * 
+ * @param sc 
+ */
+void scale__timing_begin(
+    scale_t* const sc);
+
+/**
+ * @brief Ends a window of len values so the next one begun follows
+ * straight on from it
+ * 
+ * @param sc 
+ * @param len 
+ */
+void scale__timing_follow(
+    scale_t* const sc,
+    const size_t len);
+
+/**
+ * @brief Counts a value captured at now towards the scale's sample rate,
+ * jitter and missed samples, given the adaptor's period in us (0 if
+ * unknown)
+ * 
+ * @param sc 
+ * @param now 
+ * @param period 
+ */
+void scale__timing_record(
+    scale_t* const sc,
+    const uint32_t now,
+    const uint period);
+
+/**
+ * @brief Returns whether a value captured at captured was left over from
+ * before the current window began
+ * 
+ * @param sc 
+ * @param captured 
+ * @return true 
+ * @return false 
+ */
+bool scale__timing_is_stale(
+    const scale_t* const sc,
+    const uint32_t captured);
+
+bool scale__reduce(
+    scale_t* const sc,
+    double* const val,
+    util_stats_t* const stats,
+    const scale_options_t* const opt,
+    size_t len);
+
+/**
+ * @brief Obtains a value from the scale by streaming samples through a
+ * constant-memory quantile estimator. The buffer is only used to hold
+ * samples in between adding them to the estimator, so it may be much
+ * smaller than the number of samples in the window. Used by scale_read
+ * for read_type_quantile.
+ * 
+ * @param sc 
+ * @param val 
+ * @param opt 
+ * @return true 
+ * @return false 
+ */
+bool scale__read_quantile(
+    scale_t* const sc,
+    double* const val,
+    const scale_options_t* const opt);
+
+bool scale__plan_acquire_time(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    size_t* const len);
+
+bool scale__plan_acquire_aligned(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    size_t* const len);
+
+bool scale__plan_reduce_average(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val);
+
+bool scale__plan_reduce_kalman(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val);
+
+bool scale__plan_reduce_trimmed_mean(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val);
+
+bool scale__plan_reduce_mad_mean(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val);
+
+/**
+ * @brief Converts a raw value read from the scale to a mass_t and publishes
+ * it as the latest reading. Returns true if the operation succeeded.
+ * 
+ * @param sc 
+ * @param raw 
+ * @param m 
+ * @return true 
+ * @return false 
+ */
+bool scale__complete(
+    scale_t* const sc,
+    const double* const raw,
+    mass_t* const m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,139 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SCALE_PERF_H_0E4C7A92_3B5D_4F18_9A6E_D21F8C4B7035
+#define SCALE_PERF_H_0E4C7A92_3B5D_4F18_9A6E_D21F8C4B7035
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Define SCALE_PERF_ENABLED as 1 (or set the PICO_SCALE_PERF CMake
+ * option) to give each scale_t a block of counters and latency
+ * histograms. When disabled, the scale_t has no such block and the
+ * instrumentation compiles to nothing.
+ */
+#ifndef SCALE_PERF_ENABLED
+#define SCALE_PERF_ENABLED 0
+#endif
+
+/**
+ * Source of the ticks recorded in the histograms. Defaults to the
+ * 1us timer, since an acquisition can be far longer than SysTick's
+ * 24 bits of cycles. Define as a cycle counter to time short stages
+ * more finely.
+ */
+#ifndef SCALE_PERF_NOW
+#define SCALE_PERF_NOW() time_us_32()
+#endif
+
+/**
+ * Bucket i counts durations d where 2^(i-1) <= d < 2^i, so bucket 0
+ * holds 0 ticks and bucket 32 holds 2^31 ticks or more
+ */
+#define SCALE_PERF_BUCKETS 33u
+
+typedef enum {
+    scale_perf_stage_acquire = 0, //waiting for and collecting values
+    scale_perf_stage_reduce, //reducing values to a single value
+    scale_perf_stage_convert, //normalising and converting to a mass
+    scale_perf_stage_count
+} scale_perf_stage_t;
+
+typedef struct {
+    uint32_t reads; //acquisitions started
+    uint32_t timeouts; //acquisitions which obtained no values in time
+    uint32_t failures; //acquisitions where the adaptor failed
+    uint32_t hist[scale_perf_stage_count][SCALE_PERF_BUCKETS];
+    uint32_t max[scale_perf_stage_count]; //longest time in each stage; ticks
+} scale_perf_t;
+
+#if SCALE_PERF_ENABLED
+
+#define SCALE_PERF_BEGIN(start) \
+    const uint32_t start = SCALE_PERF_NOW()
+
+#define SCALE_PERF_END(perf, stage, start) \
+    scale_perf_record((perf), (stage), SCALE_PERF_NOW() - (start))
+
+#define SCALE_PERF_COUNT(perf, field) \
+    (++((perf)->field))
+
+#else
+
+#define SCALE_PERF_BEGIN(start)
+#define SCALE_PERF_END(perf, stage, start) ((void)0)
+#define SCALE_PERF_COUNT(perf, field) ((void)0)
+
+#endif
+
+/**
+ * @brief Clears all counters and histograms
+ * 
+ * @param perf 
+ */
+void scale_perf_reset(
+    scale_perf_t* const perf);
+
+/**
+ * @brief Adds a duration to a stage's histogram
+ * 
+ * @param perf 
+ * @param stage 
+ * @param ticks 
+ */
+void scale_perf_record(
+    scale_perf_t* const perf,
+    const scale_perf_stage_t stage,
+    const uint32_t ticks);
+
+/**
+ * @brief Returns the histogram bucket for a duration
+ * 
+ * @param ticks 
+ * @return uint 
+ */
+static inline uint scale_perf_bucket(
+    const uint32_t ticks) {
+        return ticks == 0 ? 0 : 32u - (uint)__builtin_clz(ticks);
+}
+
+/**
+ * @brief Prints the counters and the non-empty histogram buckets
+ * to stdout
+ * 
+ * @param perf 
+ */
+void scale_perf_dump(
+    const scale_perf_t* const perf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,163 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SCALE_PIPELINE_H_4C7E1B92_38A5_4D06_B1F7_9E2A6D5C0B84
+#define SCALE_PIPELINE_H_4C7E1B92_38A5_4D06_B1F7_9E2A6D5C0B84
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/sync.h"
+#include "mass.h"
+#include "scale.h"
+#include "scale_perf.h"
+#include "util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Number of buffers a pipeline alternates between
+ */
+#define SCALE_PIPELINE_BUFFS 2
+
+/**
+ * Time in us scale_pipeline_stop waits, beyond the length of a time
+ * window, for core 1 to finish the window in progress before
+ * resetting it anyway
+ */
+static const uint SCALE_PIPELINE_STOP_TIMEOUT = 1000000;
+
+typedef enum {
+    scale_pipeline_buff_free = 0,
+    scale_pipeline_buff_filling, //owned by core 1
+    scale_pipeline_buff_ready, //holds a complete window
+    scale_pipeline_buff_reading //owned by core 0
+} scale_pipeline_buff_t;
+
+/**
+ * Acquires samples on core 1 into one buffer while core 0 reduces
+ * the other, so there is no gap in acquisition while a window is
+ * being processed.
+ */
+typedef struct {
+    scale_t* _sc;
+    scale_t _acq; //core 1's copy of the scale, so acquisition does not write to _sc
+    scale_options_t _opts[SCALE_PIPELINE_BUFFS]; //one per buffer
+    size_t _lens[SCALE_PIPELINE_BUFFS];
+    bool _oks[SCALE_PIPELINE_BUFFS];
+    scale_timing_t _timings[SCALE_PIPELINE_BUFFS]; //_acq's timing when each window completed
+#if SCALE_PERF_ENABLED
+    scale_perf_t _perfs[SCALE_PIPELINE_BUFFS]; //_acq's counters when each window completed
+#endif
+    uint32_t _seqs[SCALE_PIPELINE_BUFFS]; //order the windows completed in
+    volatile scale_pipeline_buff_t _states[SCALE_PIPELINE_BUFFS]; //only changed while holding _lock
+    uint32_t _seq; //only used by core 1
+    spin_lock_t* _lock;
+    volatile bool _running;
+    volatile bool _stopped;
+} scale_pipeline_t;
+
+/**
+ * @brief Initialises a pipeline which reads from sc according to opt, using
+ * buff0 and buff1 in turn as the read buffer. opt->buffer and opt->bufflen
+ * are ignored. read_type_quantile is not supported. Claims a hardware spin
+ * lock.
+ * 
+ * @param pl 
+ * @param sc 
+ * @param opt 
+ * @param buff0 
+ * @param buff1 
+ * @param bufflen length of each buffer
+ */
+void scale_pipeline_init(
+    scale_pipeline_t* const pl,
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    int32_t* const buff0,
+    int32_t* const buff1,
+    const size_t bufflen);
+
+/**
+ * @brief Launches acquisition on core 1. Core 1 must not be in use. The
+ * scale and its adaptor must not be read from outside the pipeline until
+ * it is stopped. While it runs, the scale's timing (and acquisition
+ * counters, if enabled) are updated from core 1's as each window is read.
+ * 
+ * @param pl 
+ */
+void scale_pipeline_start(
+    scale_pipeline_t* const pl);
+
+/**
+ * @brief Stops acquisition once the window in progress is complete and
+ * resets core 1. If the window has not completed within
+ * SCALE_PIPELINE_STOP_TIMEOUT us of when it should have (eg. the
+ * adaptor has stopped providing values), core 1 is reset without
+ * waiting for it.
+ * 
+ * @param pl 
+ */
+void scale_pipeline_stop(
+    scale_pipeline_t* const pl);
+
+/**
+ * @brief Waits for the next acquired window and reduces it to a value while
+ * the following window is acquired. Core 1 never waits for a slow reader;
+ * it refills the buffer holding the older window instead, so the window
+ * returned is always the newest available. Returns true if the operation
+ * succeeded, and false if the pipeline is stopped with no window ready.
+ * 
+ * @param pl 
+ * @param val 
+ * @param stats May be NULL
+ * @return true 
+ * @return false 
+ */
+bool scale_pipeline_read(
+    scale_pipeline_t* const pl,
+    double* const val,
+    util_stats_t* const stats);
+
+/**
+ * @brief Waits for the next acquired window and converts it to a weight
+ * while the following window is acquired. Returns true if the operation
+ * succeeded.
+ * 
+ * @param pl 
+ * @param m 
+ * @return true 
+ * @return false 
+ */
+bool scale_pipeline_weight(
+    scale_pipeline_t* const pl,
+    mass_t* const m);
+
+void scale_pipeline__core1_entry(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
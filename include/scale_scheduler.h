@@ -0,0 +1,148 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SCALE_SCHEDULER_H_71B0E5D3_2A9C_4F84_8E16_D43C9A7B05F2
+#define SCALE_SCHEDULER_H_71B0E5D3_2A9C_4F84_8E16_D43C9A7B05F2
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "mass.h"
+#include "scale.h"
+#include "scale_events.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of scales a scheduler can service
+ */
+#define SCALE_SCHEDULER_MAX_SCALES 8
+
+/**
+ * @brief Function called when a scale's window is complete
+ * @param index index of the scale in the scheduler
+ * @param sc the scale
+ * @param ok whether a weight was obtained
+ * @param m the weight; only valid if ok is true
+ * @param data arbitrary user data given to scale_scheduler_add
+ */
+typedef void (*scale_scheduler_callback_t)(
+    const size_t index,
+    scale_t* const sc,
+    const bool ok,
+    const mass_t* const m,
+    void* const data);
+
+typedef struct {
+    scale_t* _sc;
+    const scale_options_t* _opt;
+    scale_scheduler_callback_t _callback;
+    void* _data;
+    scale_events_t* _events; //optional; fed every sample
+    size_t _len; //samples in the current window
+    absolute_time_t _end; //end of the current strategy_type_time window
+} scale_scheduler_entry_t;
+
+/**
+ * Services many scales from one loop. Each call to scale_scheduler_poll
+ * takes whatever samples are ready from each scale's adaptor without
+ * waiting, so a slow converter never holds up the others.
+ */
+typedef struct {
+    scale_scheduler_entry_t _entries[SCALE_SCHEDULER_MAX_SCALES];
+    size_t _count;
+    size_t _next; //entry polled first on the next call
+} scale_scheduler_t;
+
+/**
+ * @brief Initialises an empty scheduler
+ * 
+ * @param ss 
+ */
+void scale_scheduler_init(
+    scale_scheduler_t* const ss);
+
+/**
+ * @brief Adds a scale to the scheduler. opt must remain valid while the scale
+ * is scheduled and its buffer must not be shared with another scale.
+ * read_type_quantile is not supported. callback is called each time a window
+ * is complete. Returns false if the scheduler is full, or if opt asks for
+ * more samples than its buffer holds.
+ * 
+ * @param ss 
+ * @param sc 
+ * @param opt 
+ * @param callback 
+ * @param data arbitrary user data passed to callback
+ * @param index set to the index of the scale in the scheduler; may be NULL
+ * @return true 
+ * @return false 
+ */
+bool scale_scheduler_add(
+    scale_scheduler_t* const ss,
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const scale_scheduler_callback_t callback,
+    void* const data,
+    size_t* const index);
+
+/**
+ * @brief Sets subscriptions to be evaluated against every sample taken from
+ * the scale at index, as it is taken. evs may be NULL to stop evaluating
+ * subscriptions.
+ * 
+ * @param ss 
+ * @param index 
+ * @param evs 
+ */
+void scale_scheduler_set_events(
+    scale_scheduler_t* const ss,
+    const size_t index,
+    scale_events_t* const evs);
+
+/**
+ * @brief Takes every sample that is ready from each scale, starting with a
+ * different scale each call, and completes any windows which are full or
+ * have timed out. Never waits for a sample. Returns the number of windows
+ * completed.
+ * 
+ * @param ss 
+ * @return size_t 
+ */
+size_t scale_scheduler_poll(
+    scale_scheduler_t* const ss);
+
+void scale_scheduler__begin(
+    scale_scheduler_entry_t* const e);
+
+bool scale_scheduler__service(
+    scale_scheduler_entry_t* const e,
+    const size_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,217 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SIM_SCALE_ADAPTOR_H_75F0C3A8_19D2_4E6B_A7C4_0E83B5D1F926
+#define SIM_SCALE_ADAPTOR_H_75F0C3A8_19D2_4E6B_A7C4_0E83B5D1F926
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "scale_adaptor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t time; //us from the start of the simulation
+    double load; //units of load on the cell from then on
+} sim_step_t;
+
+/**
+ * Model of a load cell and HX711. Raw values are
+ * 
+ *  offset + ref_unit * response(t) + drift + vibration + mains + noise
+ * 
+ * clamped to 24 bits, where response(t) is the sum over each step in
+ * load of the change in load times
+ * 
+ *  1 - exp(-dt / settle) * cos(2 pi ring_hz dt)
+ *  + creep * (1 - exp(-dt / creep_tau))
+ * 
+ * dt being the time since the step. Separately, each value may be
+ * replaced by a full scale spike or dropped altogether.
+ */
+typedef struct {
+    uint64_t seed; //the same seed gives the same values
+    uint period; //us between values
+    bool realtime; //serve values at the period rather than at once
+    int32_t offset; //raw value with no load
+    double ref_unit; //raw counts per unit of load
+    const sim_step_t* steps; //in time order; may be NULL
+    size_t steps_len;
+    double settle; //us; time constant of the response to a step
+    double ring_hz; //frequency of ringing after a step; 0 for none
+    double creep; //fraction of a step which creeps in afterwards
+    double creep_tau; //us; time constant of creep
+    double drift; //counts per second, eg. from temperature change
+    double vibration; //counts; amplitude of ambient vibration
+    double vibration_hz;
+    double mains; //counts; amplitude of mains pickup
+    double mains_hz; //50 or 60
+    double noise; //counts; standard deviation of noise
+    double spike_p; //probability a value is a full scale spike
+    double drop_p; //probability a value is never delivered; below 1
+} sim_scale_adaptor_config_t;
+
+typedef struct {
+    sim_scale_adaptor_config_t _cfg;
+    uint64_t _state; //prng
+    uint64_t _time; //us; time of the value after _value
+    int32_t _value; //next value to be served
+    uint64_t _value_time; //us; time of _value
+    uint64_t _served_time; //us; time of the value most recently served
+    uint64_t _start; //us; host time the simulation started
+    uint32_t _spikes;
+    uint32_t _drops;
+    scale_adaptor_t _sa;
+} sim_scale_adaptor_t;
+
+/**
+ * @brief Sets cfg to an unloaded 80 SPS HX711 with typical noise,
+ * a 50ms settle and none of the other effects
+ * 
+ * @param cfg 
+ */
+void sim_scale_adaptor_get_default_config(
+    sim_scale_adaptor_config_t* const cfg);
+
+bool sim_scale_adaptor_init(
+    sim_scale_adaptor_t* const sim,
+    const sim_scale_adaptor_config_t* const cfg);
+
+scale_adaptor_t* sim_scale_adaptor_get_base(
+    sim_scale_adaptor_t* const sim);
+
+/**
+ * @brief Returns the simulated time in us of the next value served
+ * 
+ * @param sim 
+ * @return uint64_t 
+ */
+uint64_t sim_scale_adaptor_get_clock(
+    const sim_scale_adaptor_t* const sim);
+
+/**
+ * @brief Returns the load applied at time t, in units; what a perfect
+ * scale would read
+ * 
+ * @param sim 
+ * @param t us
+ * @return double 
+ */
+double sim_scale_adaptor_get_load(
+    const sim_scale_adaptor_t* const sim,
+    const uint64_t t);
+
+/**
+ * @brief Returns the simulated load cell's offset and ref_unit, the
+ * latter rounded to the nearest count, as given to scale_init for a
+ * scale which reads the load in units
+ * 
+ * @param sim 
+ * @param ref_unit 
+ * @param offset 
+ */
+void sim_scale_adaptor_get_calibration(
+    const sim_scale_adaptor_t* const sim,
+    int32_t* const ref_unit,
+    int32_t* const offset);
+
+/**
+ * @brief Returns the number of spikes and drops so far
+ * 
+ * @param sim 
+ * @param spikes 
+ * @param drops 
+ */
+void sim_scale_adaptor_get_faults(
+    const sim_scale_adaptor_t* const sim,
+    uint32_t* const spikes,
+    uint32_t* const drops);
+
+bool sim_scale_adaptor_get_value(
+    scale_adaptor_t* const sa,
+    int32_t* const value);
+
+bool sim_scale_adaptor_get_value_timeout(
+    scale_adaptor_t* const sa,
+    int32_t* const value,
+    const uint timeout);
+
+bool sim_scale_adaptor_get_value_noblock(
+    scale_adaptor_t* const sa,
+    int32_t* const value);
+
+bool sim_scale_adaptor_get_period(
+    scale_adaptor_t* const sa,
+    uint* const nominal,
+    uint* const measured);
+
+/**
+ * @brief Sets time to when the value most recently served was due on the
+ * time_us_32 clock. Only realtime simulations can tell.
+ * 
+ * @param sa 
+ * @param time 
+ * @return true 
+ * @return false 
+ */
+bool sim_scale_adaptor_get_time(
+    scale_adaptor_t* const sa,
+    uint32_t* const time);
+
+/**
+ * @brief Returns the raw value at time t, before spikes
+ * 
+ * @param sim 
+ * @param t us
+ * @return double 
+ */
+double sim_scale_adaptor__model(
+    sim_scale_adaptor_t* const sim,
+    const uint64_t t);
+
+/**
+ * @brief Generates the next value and moves to the time of the one
+ * after. Returns false if the value is dropped.
+ * 
+ * @param sim 
+ * @param value 
+ * @return true 
+ * @return false 
+ */
+bool sim_scale_adaptor__next(
+    sim_scale_adaptor_t* const sim,
+    int32_t* const value);
+
+uint64_t sim_scale_adaptor__rand(
+    sim_scale_adaptor_t* const sim);
+
+double sim_scale_adaptor__uniform(
+    sim_scale_adaptor_t* const sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
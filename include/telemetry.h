@@ -0,0 +1,204 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TELEMETRY_H_A83F2C51_96E7_4B0D_8E2A_C45D71B9F036
+#define TELEMETRY_H_A83F2C51_96E7_4B0D_8E2A_C45D71B9F036
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cobs.h"
+#include "mass.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Telemetry is sent as COBS-encoded packets, each followed by a zero
+ * byte. Every packet starts with a type byte and a 16 bit sequence
+ * number, which increases by one per packet so a receiver can count
+ * lost packets. All fields are little-endian.
+ * 
+ * telemetry_packet_samples:
+ *  u8 type, u16 seq, u8 count, then count times { u32 time, i32 value }
+ * 
+ * telemetry_packet_reading:
+ *  u8 type, u16 seq, u32 time, f32 raw, f64 ug, u8 unit, u8 stable
+ * 
+ * Times are in microseconds.
+ */
+
+#define TELEMETRY_MAX_SAMPLES 16u
+
+#define TELEMETRY_HEADER_LEN 3u
+#define TELEMETRY_SAMPLES_LEN(count) (TELEMETRY_HEADER_LEN + 1u + ((count) * 8u))
+#define TELEMETRY_READING_LEN (TELEMETRY_HEADER_LEN + 4u + 4u + 8u + 1u + 1u)
+
+/**
+ * Longest packet, before encoding
+ */
+#define TELEMETRY_PACKET_MAX TELEMETRY_SAMPLES_LEN(TELEMETRY_MAX_SAMPLES)
+
+/**
+ * Longest frame, including the zero delimiter
+ */
+#define TELEMETRY_FRAME_MAX (COBS_ENCODED_MAX(TELEMETRY_PACKET_MAX) + 1u)
+
+typedef enum {
+    telemetry_packet_samples = 1,
+    telemetry_packet_reading = 2
+} telemetry_packet_type_t;
+
+/**
+ * Called with each complete frame. Returns false if the frame could
+ * not be written.
+ */
+typedef bool (*telemetry_write_t)(
+    const uint8_t* const buff,
+    const size_t len,
+    void* const data);
+
+typedef struct {
+    telemetry_write_t _write;
+    void* _data;
+    uint16_t _seq; //sequence number of the next packet
+} telemetry_t;
+
+typedef struct {
+    telemetry_packet_type_t type;
+    uint16_t seq;
+    size_t count; //samples
+    uint32_t times[TELEMETRY_MAX_SAMPLES]; //samples
+    int32_t values[TELEMETRY_MAX_SAMPLES]; //samples
+    uint32_t time; //reading
+    float raw; //reading
+    double ug; //reading
+    mass_unit_t unit; //reading
+    bool stable; //reading
+} telemetry_packet_t;
+
+/**
+ * Collects the bytes of a frame as they are received
+ */
+typedef struct {
+    uint8_t _buff[TELEMETRY_FRAME_MAX];
+    size_t _len;
+    bool _overflow; //whether the current frame was too long
+} telemetry_decoder_t;
+
+/**
+ * @brief Initialises the telemetry sender to pass each frame to write
+ * 
+ * @param tm 
+ * @param write 
+ * @param data Passed to write
+ */
+void telemetry_init(
+    telemetry_t* const tm,
+    const telemetry_write_t write,
+    void* const data);
+
+/**
+ * @brief Sends raw values and the times they were obtained, in as many
+ * packets as needed. times may be NULL, in which case they are sent as 0.
+ * Returns false if a frame could not be written.
+ * 
+ * @param tm 
+ * @param values 
+ * @param times 
+ * @param len 
+ * @return true 
+ * @return false 
+ */
+bool telemetry_send_samples(
+    telemetry_t* const tm,
+    const int32_t* const values,
+    const uint32_t* const times,
+    const size_t len);
+
+/**
+ * @brief Sends a reduced raw value and the mass it was converted to
+ * 
+ * @param tm 
+ * @param time us
+ * @param raw 
+ * @param m 
+ * @param stable 
+ * @return true 
+ * @return false 
+ */
+bool telemetry_send_reading(
+    telemetry_t* const tm,
+    const uint32_t time,
+    const double raw,
+    const mass_t* const m,
+    const bool stable);
+
+/**
+ * @brief Parses a decoded packet. Returns false if it is not a valid
+ * packet.
+ * 
+ * @param buff 
+ * @param len 
+ * @param pkt 
+ * @return true 
+ * @return false 
+ */
+bool telemetry_parse(
+    const uint8_t* const buff,
+    const size_t len,
+    telemetry_packet_t* const pkt);
+
+/**
+ * @brief Initialises the decoder to wait for the start of a frame
+ * 
+ * @param dec 
+ */
+void telemetry_decoder_init(
+    telemetry_decoder_t* const dec);
+
+/**
+ * @brief Adds a received byte. Returns true when it completes a valid
+ * packet, which is then set in pkt. Malformed frames are dropped.
+ * 
+ * @param dec 
+ * @param byte 
+ * @param pkt 
+ * @return true 
+ * @return false 
+ */
+bool telemetry_decoder_feed(
+    telemetry_decoder_t* const dec,
+    const uint8_t byte,
+    telemetry_packet_t* const pkt);
+
+bool telemetry__send(
+    telemetry_t* const tm,
+    uint8_t* const pkt,
+    const size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
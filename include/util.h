@@ -24,6 +24,7 @@
 #define UTIL_H_916DF5EE_2C2B_4D3C_A484_A64B176F8D96
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -31,6 +32,15 @@
 extern "C" {
 #endif
 
+typedef struct {
+    size_t len; //number of values the statistics were calculated from
+    double mean;
+    double variance; //sample variance; 0 when len is 1
+    int32_t min;
+    int32_t max;
+    double median;
+} util_stats_t;
+
 /**
  * @brief Calculates the average value from an array of signed 32-bit integers
  * 
@@ -44,7 +54,8 @@ void util_average(
     double* const avg);
 
 /**
- * @brief Calculates the median value from an array of signed 32-bit integers
+ * @brief Calculates the median value from an array of signed 32-bit integers.
+ * arr is partially reordered.
  * 
  * @param arr array of values
  * @param len number of values in the array
@@ -55,9 +66,96 @@ void util_median(
     const size_t len,
     double* const med);
 
-int util__median_compare_func(
-    const void* a,
-    const void* b);
+/**
+ * @brief Calculates the mean, variance, minimum, maximum and median of an
+ * array of signed 32-bit integers with a single pass over the values and a
+ * single selection. arr is partially reordered.
+ * 
+ * @param arr array of values
+ * @param len number of values in the array
+ * @param stats 
+ */
+void util_stats(
+    int32_t* const arr,
+    const size_t len,
+    util_stats_t* const stats);
+
+/**
+ * Scales a median absolute deviation to an estimate of the standard
+ * deviation of normally distributed values
+ */
+static const double UTIL_MAD_TO_SD = 1.4826;
+
+/**
+ * @brief Partially reorders arr so the value at index k is the value that
+ * would be there if arr were sorted, all values before it are less than or
+ * equal to it, and all values after it are greater than or equal to it.
+ * 
+ * @param arr array of values
+ * @param len number of values in the array
+ * @param k index to select
+ */
+void util_select(
+    int32_t* const arr,
+    const size_t len,
+    const size_t k);
+
+/**
+ * @brief Calculates the average value from an array of signed 32-bit integers
+ * after discarding the lowest and highest trim fraction of values. arr is
+ * partially reordered.
+ * 
+ * @param arr array of values
+ * @param len number of values in the array
+ * @param trim fraction of values to discard from each end [0, 0.5)
+ * @param avg 
+ */
+void util_trimmed_mean(
+    int32_t* const arr,
+    const size_t len,
+    const double trim,
+    double* const avg);
+
+/**
+ * @brief Calculates the average value from an array of signed 32-bit integers
+ * after discarding values further than k standard deviations from the median,
+ * where the standard deviation is estimated from the median absolute
+ * deviation. arr is partially reordered.
+ * 
+ * @param arr array of values
+ * @param len number of values in the array
+ * @param k number of standard deviations from the median to keep
+ * @param avg 
+ */
+void util_mad_mean(
+    int32_t* const arr,
+    const size_t len,
+    const double k,
+    double* const avg);
+
+void util__select(
+    int32_t* const arr,
+    const size_t len,
+    const size_t k,
+    const bool absolute);
+
+/**
+ * @brief As util_select, for indices k1 and k2 (k1 <= k2) in one pass
+ * 
+ * @param arr array of values
+ * @param len number of values in the array
+ * @param k1 lower index to select
+ * @param k2 upper index to select
+ */
+void util__select_pair(
+    int32_t* const arr,
+    const size_t len,
+    const size_t k1,
+    const size_t k2);
+
+int32_t util__max(
+    const int32_t* const arr,
+    const size_t len);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,196 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "../include/checkweigher.h"
+#include "../include/mass.h"
+
+void checkweigher_init(
+    checkweigher_t* const cw,
+    const scale_t* const sc,
+    const checkweigher_config_t* const cfg) {
+
+        assert(cw != NULL);
+        assert(sc != NULL);
+        assert(cfg != NULL);
+        assert(cfg->samples > 0);
+
+        const int64_t target = scale_mass_to_counts(sc, &cfg->target);
+        const int64_t under = scale_mass_to_counts(sc, &cfg->under);
+        const int64_t over = scale_mass_to_counts(sc, &cfg->over);
+
+        cw->_sc = sc;
+        cw->_empty = scale_mass_to_counts(sc, &cfg->empty);
+        cw->_settle = cfg->settle;
+        cw->_samples = cfg->samples;
+
+        /**
+         * Compare the sum of the samples rather than their mean,
+         * so no division is needed when deciding.
+         */
+        cw->_under_sum = (target - under) * cfg->samples;
+        cw->_over_sum = (target + over) * cfg->samples;
+
+        cw->_state = checkweigher__state_idle;
+        cw->_n = 0;
+        cw->_sum = 0;
+        cw->_arrived = 0;
+
+        checkweigher_reset_stats(cw);
+
+}
+
+bool checkweigher_feed(
+    checkweigher_t* const cw,
+    const int32_t raw,
+    checkweigher_result_t* const result) {
+
+        assert(cw != NULL);
+        assert(result != NULL);
+
+        const int64_t n = scale_raw_to_counts(cw->_sc, raw);
+
+        const bool present = n >= cw->_empty;
+
+        switch(cw->_state) {
+            case checkweigher__state_idle:
+                if(present) {
+                    cw->_arrived = time_us_32();
+                    cw->_n = 0;
+                    cw->_sum = 0;
+                    cw->_state = cw->_settle > 0
+                        ? checkweigher__state_settling
+                        : checkweigher__state_measuring;
+                }
+                return false;
+
+            case checkweigher__state_settling:
+                if(!present) {
+                    //item was removed (or bounced) before settling
+                    cw->_state = checkweigher__state_idle;
+                }
+                else if(++cw->_n >= cw->_settle) {
+                    cw->_n = 0;
+                    cw->_state = checkweigher__state_measuring;
+                }
+                return false;
+
+            case checkweigher__state_measuring:
+                cw->_sum += n;
+                if(++cw->_n < cw->_samples) {
+                    return false;
+                }
+                break;
+
+            case checkweigher__state_clearing:
+            default:
+                if(!present) {
+                    cw->_state = checkweigher__state_idle;
+                }
+                return false;
+        }
+
+        if(cw->_sum < cw->_under_sum) {
+            *result = checkweigher_under;
+        }
+        else if(cw->_sum > cw->_over_sum) {
+            *result = checkweigher_over;
+        }
+        else {
+            *result = checkweigher_accept;
+        }
+
+        const uint32_t lat = time_us_32() - cw->_arrived;
+
+        ++cw->_results[*result];
+        cw->_lat_total += lat;
+
+        if(lat < cw->_lat_min) {
+            cw->_lat_min = lat;
+        }
+
+        if(lat > cw->_lat_max) {
+            cw->_lat_max = lat;
+        }
+
+        cw->_state = checkweigher__state_clearing;
+
+        return true;
+
+}
+
+uint32_t checkweigher_get_count(
+    const checkweigher_t* const cw,
+    const checkweigher_result_t result) {
+
+        assert(cw != NULL);
+        assert((uint)result < 3);
+
+        return cw->_results[result];
+
+}
+
+bool checkweigher_get_latency(
+    const checkweigher_t* const cw,
+    uint32_t* const min,
+    uint32_t* const max,
+    uint32_t* const mean) {
+
+        assert(cw != NULL);
+        assert(min != NULL);
+        assert(max != NULL);
+        assert(mean != NULL);
+
+        const uint64_t count =
+            (uint64_t)cw->_results[checkweigher_accept] +
+            cw->_results[checkweigher_under] +
+            cw->_results[checkweigher_over];
+
+        if(count == 0) {
+            return false;
+        }
+
+        *min = cw->_lat_min;
+        *max = cw->_lat_max;
+        *mean = (uint32_t)(cw->_lat_total / count);
+
+        return true;
+
+}
+
+void checkweigher_reset_stats(
+    checkweigher_t* const cw) {
+
+        assert(cw != NULL);
+
+        cw->_results[checkweigher_accept] = 0;
+        cw->_results[checkweigher_under] = 0;
+        cw->_results[checkweigher_over] = 0;
+        cw->_lat_min = UINT32_MAX;
+        cw->_lat_max = 0;
+        cw->_lat_total = 0;
+
+}
@@ -0,0 +1,112 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/cobs.h"
+
+size_t cobs_encode(
+    const uint8_t* const src,
+    const size_t len,
+    uint8_t* const dst) {
+
+        assert(src != NULL || len == 0);
+        assert(dst != NULL);
+
+        size_t code_pos = 0; //where the current block's code byte goes
+        size_t out = 1;
+        uint8_t code = 1; //one more than the bytes in the current block
+
+        for(size_t i = 0; i < len; ++i) {
+
+            if(src[i] != 0) {
+                dst[out++] = src[i];
+                ++code;
+            }
+
+            //a zero ends the block, as does a full block
+            if(src[i] == 0 || code == 0xff) {
+
+                dst[code_pos] = code;
+                code_pos = out++;
+                code = 1;
+
+                //a full block at the end needs no empty block after it
+                if(src[i] != 0 && i + 1 == len) {
+                    return code_pos;
+                }
+
+            }
+
+        }
+
+        dst[code_pos] = code;
+
+        return out;
+
+}
+
+bool cobs_decode(
+    const uint8_t* const src,
+    const size_t len,
+    uint8_t* const dst,
+    size_t* const outlen) {
+
+        assert(src != NULL || len == 0);
+        assert(dst != NULL);
+        assert(outlen != NULL);
+
+        size_t in = 0;
+        size_t out = 0;
+
+        while(in < len) {
+
+            const uint8_t code = src[in++];
+
+            //zeroes are delimiters and cannot appear in a frame, and
+            //a block cannot run past the end of the frame
+            if(code == 0 || in + code - 1 > len) {
+                return false;
+            }
+
+            for(uint8_t i = 1; i < code; ++i) {
+                if(src[in] == 0) {
+                    return false;
+                }
+                dst[out++] = src[in++];
+            }
+
+            //every block but a full one stands for a zero, except
+            //the last, since the data did not end in a zero
+            if(code != 0xff && in < len) {
+                dst[out++] = 0;
+            }
+
+        }
+
+        *outlen = out;
+
+        return true;
+
+}
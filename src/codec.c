@@ -0,0 +1,236 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/codec.h"
+
+void codec_encoder_init(
+    codec_encoder_t* const enc,
+    uint8_t* const buff,
+    const size_t bufflen,
+    const size_t block,
+    uint32_t* const index,
+    const size_t indexlen) {
+
+        assert(enc != NULL);
+        assert(buff != NULL);
+        assert(block > 0);
+
+        enc->_buff = buff;
+        enc->_bufflen = bufflen;
+        enc->_pos = 0;
+        enc->_block = block;
+        enc->_count = 0;
+        enc->_prev = 0;
+        enc->_index = index;
+        enc->_indexlen = index != NULL ? indexlen : 0;
+
+}
+
+bool codec_encoder_add(
+    codec_encoder_t* const enc,
+    const int32_t value) {
+
+        assert(enc != NULL);
+
+        const bool checkpoint = enc->_count % enc->_block == 0;
+
+        //wrapping subtraction, so every pair of values has a difference
+        uint32_t u = codec_zigzag(checkpoint
+            ? value
+            : (int32_t)((uint32_t)value - (uint32_t)enc->_prev));
+
+        //check there is room before writing anything
+        size_t need = 1;
+        for(uint32_t t = u >> 7; t != 0; t >>= 7) {
+            ++need;
+        }
+
+        if(enc->_bufflen - enc->_pos < need) {
+            return false;
+        }
+
+        if(checkpoint) {
+            const size_t b = enc->_count / enc->_block;
+            if(b < enc->_indexlen) {
+                enc->_index[b] = (uint32_t)enc->_pos;
+            }
+        }
+
+        while(u >= 0x80) {
+            enc->_buff[enc->_pos++] = (uint8_t)(u | 0x80);
+            u >>= 7;
+        }
+
+        enc->_buff[enc->_pos++] = (uint8_t)u;
+        enc->_prev = value;
+        ++enc->_count;
+
+        return true;
+
+}
+
+size_t codec_encoder_add_all(
+    codec_encoder_t* const enc,
+    const int32_t* const arr,
+    const size_t len) {
+
+        assert(enc != NULL);
+        assert(arr != NULL);
+
+        size_t i = 0;
+
+        while(i < len && codec_encoder_add(enc, arr[i])) {
+            ++i;
+        }
+
+        return i;
+
+}
+
+size_t codec_encoder_get_len(
+    const codec_encoder_t* const enc) {
+        assert(enc != NULL);
+        return enc->_pos;
+}
+
+size_t codec_encoder_get_count(
+    const codec_encoder_t* const enc) {
+        assert(enc != NULL);
+        return enc->_count;
+}
+
+void codec_decoder_init(
+    codec_decoder_t* const dec,
+    const uint8_t* const buff,
+    const size_t len,
+    const size_t block) {
+
+        assert(dec != NULL);
+        assert(buff != NULL || len == 0);
+        assert(block > 0);
+
+        dec->_buff = buff;
+        dec->_len = len;
+        dec->_pos = 0;
+        dec->_block = block;
+        dec->_count = 0;
+        dec->_prev = 0;
+
+}
+
+bool codec_decoder_next(
+    codec_decoder_t* const dec,
+    int32_t* const value) {
+
+        assert(dec != NULL);
+        assert(value != NULL);
+
+        uint32_t u = 0;
+        size_t pos = dec->_pos;
+
+        for(uint32_t shift = 0; ; shift += 7) {
+
+            //truncated, or longer than any encoded value
+            if(pos >= dec->_len || shift >= 7 * CODEC_VALUE_MAX) {
+                return false;
+            }
+
+            const uint8_t b = dec->_buff[pos++];
+            u |= (uint32_t)(b & 0x7f) << shift;
+
+            if((b & 0x80) == 0) {
+                break;
+            }
+
+        }
+
+        const int32_t v = codec_unzigzag(u);
+
+        *value = dec->_count % dec->_block == 0
+            ? v
+            : (int32_t)((uint32_t)dec->_prev + (uint32_t)v);
+
+        dec->_prev = *value;
+        dec->_pos = pos;
+        ++dec->_count;
+
+        return true;
+
+}
+
+size_t codec_decoder_read(
+    codec_decoder_t* const dec,
+    int32_t* const arr,
+    const size_t len) {
+
+        assert(dec != NULL);
+        assert(arr != NULL);
+
+        size_t i = 0;
+
+        while(i < len && codec_decoder_next(dec, &arr[i])) {
+            ++i;
+        }
+
+        return i;
+
+}
+
+bool codec_decoder_seek(
+    codec_decoder_t* const dec,
+    const uint32_t* const index,
+    const size_t indexlen,
+    const size_t n) {
+
+        assert(dec != NULL);
+        assert(index != NULL || indexlen == 0);
+
+        const size_t b = n / dec->_block;
+
+        if(b < indexlen && index[b] <= dec->_len) {
+            //start at the checkpoint
+            dec->_pos = index[b];
+            dec->_count = b * dec->_block;
+        }
+        else if(n < dec->_count) {
+            //no checkpoint; start again from the beginning
+            dec->_pos = 0;
+            dec->_count = 0;
+        }
+
+        int32_t v;
+
+        //decode the values before n in the block
+        while(dec->_count < n) {
+            if(!codec_decoder_next(dec, &v)) {
+                return false;
+            }
+        }
+
+        //a value must follow
+        return dec->_pos < dec->_len;
+
+}
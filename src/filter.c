@@ -0,0 +1,166 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../include/filter.h"
+
+static const double FILTER__PI = 3.14159265358979323846;
+
+void filter_notch_init(
+    filter_notch_t* const f,
+    const uint sps,
+    const filter_mains_t mains) {
+
+        assert(f != NULL);
+        assert(sps > 0);
+
+        /**
+         * Find where the mains frequency lands once it has been
+         * aliased by the sample rate. eg. 50Hz at 80 SPS appears
+         * at 30Hz and 60Hz at 80 SPS appears at 20Hz.
+         */
+        const int m = (int)mains;
+        const int s = (int)sps;
+        const int alias = abs(m - (((m + (s / 2)) / s) * s));
+
+        f->_enabled = false;
+        f->_g0 = 0;
+        f->_g1 = 0;
+
+        //anything within 5% of the sample rate from DC would
+        //need an enormous gain to keep the DC response at unity
+        if(alias * 20 < s) {
+            return;
+        }
+
+        const double w = (2.0 * FILTER__PI * alias) / s;
+        const double c = cos(w);
+        const double one = (double)(1 << FILTER_NOTCH_Q);
+
+        /**
+         * y[n] = (x[n] - 2cos(w)x[n-1] + x[n-2]) / (2 - 2cos(w))
+         * 
+         * The zeros lie on the unit circle at +/- w and the
+         * denominator normalises the gain at DC to 1.
+         */
+        const double g = 1.0 / (2.0 - (2.0 * c));
+
+        f->_g0 = (int64_t)llround(g * one);
+        f->_g1 = (int64_t)llround(-2.0 * c * g * one);
+        f->_enabled = true;
+
+}
+
+bool filter_notch_is_enabled(
+    const filter_notch_t* const f) {
+        assert(f != NULL);
+        return f->_enabled;
+}
+
+size_t filter_notch_apply(
+    const filter_notch_t* const f,
+    int32_t* const arr,
+    const size_t len) {
+
+        assert(f != NULL);
+        assert(arr != NULL);
+
+        if(!f->_enabled || len <= FILTER_NOTCH_DELAY) {
+            return len;
+        }
+
+        filter_notch_state_t st;
+
+        filter_notch_state_init(&st);
+
+        return filter_notch_apply_stream(f, &st, arr, len);
+
+}
+
+void filter_notch_state_init(
+    filter_notch_state_t* const st) {
+
+        assert(st != NULL);
+
+        st->_x1 = 0;
+        st->_x2 = 0;
+        st->_primed = 0;
+
+}
+
+size_t filter_notch_apply_stream(
+    const filter_notch_t* const f,
+    filter_notch_state_t* const st,
+    int32_t* const arr,
+    const size_t len) {
+
+        assert(f != NULL);
+        assert(st != NULL);
+        assert(arr != NULL || len == 0);
+
+        if(!f->_enabled) {
+            return len;
+        }
+
+        const int64_t round = INT64_C(1) << (FILTER_NOTCH_Q - 1);
+        int32_t x2 = st->_x2;
+        int32_t x1 = st->_x1;
+        size_t out = 0;
+
+        /**
+         * Outputs are written at or behind the input they are
+         * derived from, so the inputs still needed are kept in
+         * x1 and x2 before being overwritten.
+         */
+        for(size_t i = 0; i < len; ++i) {
+
+            const int32_t x0 = arr[i];
+
+            if(st->_primed < FILTER_NOTCH_DELAY) {
+                ++st->_primed;
+            }
+            else {
+
+                const int64_t acc =
+                    ((int64_t)x0 + x2) * f->_g0 +
+                    (int64_t)x1 * f->_g1;
+
+                arr[out++] = (int32_t)((acc + round) >> FILTER_NOTCH_Q);
+
+            }
+
+            x2 = x1;
+            x1 = x0;
+
+        }
+
+        st->_x2 = x2;
+        st->_x1 = x1;
+
+        return out;
+
+}
@@ -24,8 +24,30 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "pico/time.h"
 #include "../extern/hx711-pico-c/include/common.h"
 #include "../include/hx711_scale_adaptor.h"
+#include "../include/hx711_scale_bound.h"
+
+/**
+ * Adaptors in IRQ mode, indexed by PIO and state machine, so the
+ * shared interrupt handler can find where to put each value
+ */
+static hx711_scale_adaptor_t* hx711_scale_adaptor__irq_adaptors[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+
+/**
+ * Number of adaptors in IRQ mode on each PIO; the handler is
+ * added when the first is enabled and removed with the last
+ */
+static uint hx711_scale_adaptor__irq_counts[NUM_PIOS];
+
+static const uint hx711_scale_adaptor__irq_nums[NUM_PIOS] = {
+    PIO0_IRQ_0,
+    PIO1_IRQ_0
+};
 
 bool hx711_scale_adaptor_init(
     hx711_scale_adaptor_t* const hxa,
@@ -35,10 +57,26 @@ bool hx711_scale_adaptor_init(
         assert(hx != NULL);
 
         hxa->_hx = hx;
+        hxa->_irq_head = 0;
+        hxa->_irq_tail = 0;
+        hxa->_irq_overruns = 0;
+        hxa->_irq_enabled = false;
+        hxa->_period_nominal = 0;
+        hxa->_period_measured = 0;
+        hxa->_last_time = 0;
+        hxa->_timed = false;
+        hxa->_value_time = 0;
+        hxa->_value_timed = false;
+        hxa->_fifo_time = 0;
+        hxa->_fifo_timed = false;
+        hxa->_backlog = 0;
 
         scale_adaptor_init(&hxa->_sa, hxa);
         hxa->_sa.get_value = hx711_scale_adaptor_get_value;
         hxa->_sa.get_value_timeout = hx711_scale_adaptor_get_value_timeout;
+        hxa->_sa.get_value_noblock = hx711_scale_adaptor_get_value_noblock;
+        hxa->_sa.get_period = hx711_scale_adaptor_get_period;
+        hxa->_sa.get_time = hx711_scale_adaptor_get_time;
 
         return true;
 
@@ -50,7 +88,164 @@ scale_adaptor_t* hx711_scale_adaptor_get_base(
         return &hxa->_sa;
 }
 
+void hx711_scale_adaptor_set_rate(
+    hx711_scale_adaptor_t* const hxa,
+    const hx711_rate_t rate) {
+
+        assert(hxa != NULL);
+
+        hxa->_period_nominal = rate == hx711_rate_80
+            ? 1000000 / 80
+            : 1000000 / 10;
+
+        //any previous measurement was of a different rate
+        hxa->_period_measured = 0;
+        hxa->_timed = false;
+
+}
+
+//the runtime adaptor functions are the bound ones, called through the
+//adaptor's function pointers
+
 bool hx711_scale_adaptor_get_value_timeout(
+    scale_adaptor_t* const sa,
+    int32_t* const value,
+    const uint timeout) {
+        assert(sa != NULL);
+        return hx711_scale_bound_get_value_timeout(
+            scale_adaptor_get_data(sa),
+            value,
+            timeout);
+}
+
+bool hx711_scale_adaptor_get_value(
+    scale_adaptor_t* const sa,
+    int32_t* const value) {
+        assert(sa != NULL);
+        return hx711_scale_bound_get_value(scale_adaptor_get_data(sa), value);
+}
+
+bool hx711_scale_adaptor_get_value_noblock(
+    scale_adaptor_t* const sa,
+    int32_t* const value) {
+        assert(sa != NULL);
+        return hx711_scale_bound_get_value_noblock(scale_adaptor_get_data(sa), value);
+}
+
+bool hx711_scale_adaptor_get_period(
+    scale_adaptor_t* const sa,
+    uint* const nominal,
+    uint* const measured) {
+
+        assert(sa != NULL);
+        assert(nominal != NULL);
+        assert(measured != NULL);
+
+        const hx711_scale_adaptor_t* const hxa = scale_adaptor_get_data(sa);
+
+        *nominal = hxa->_period_nominal;
+        *measured = hxa->_period_measured;
+
+        return *nominal > 0 || *measured > 0;
+
+}
+
+bool hx711_scale_adaptor_get_time(
+    scale_adaptor_t* const sa,
+    uint32_t* const time) {
+        assert(sa != NULL);
+        return hx711_scale_bound_get_time(scale_adaptor_get_data(sa), time);
+}
+
+bool hx711_scale_adaptor_irq_enable(
+    hx711_scale_adaptor_t* const hxa) {
+
+        assert(hxa != NULL);
+        assert(hxa->_hx != NULL);
+
+        if(hxa->_irq_enabled) {
+            return true;
+        }
+
+        PIO const pio = hxa->_hx->_pio;
+        const uint sm = hxa->_hx->_reader_sm;
+        const uint idx = pio_get_index(pio);
+
+        if(hx711_scale_adaptor__irq_adaptors[idx][sm] != NULL) {
+            //another adaptor is already using this state machine
+            return false;
+        }
+
+        hxa->_irq_head = 0;
+        hxa->_irq_tail = 0;
+        hxa->_irq_overruns = 0;
+
+        hx711_scale_adaptor__irq_adaptors[idx][sm] = hxa;
+
+        if(hx711_scale_adaptor__irq_counts[idx]++ == 0) {
+            irq_add_shared_handler(
+                hx711_scale_adaptor__irq_nums[idx],
+                hx711_scale_adaptor__irq_handler,
+                PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            irq_set_enabled(hx711_scale_adaptor__irq_nums[idx], true);
+        }
+
+        pio_set_irq0_source_enabled(
+            pio,
+            (enum pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + sm),
+            true);
+
+        hxa->_sa.get_value = hx711_scale_adaptor_irq_get_value;
+        hxa->_sa.get_value_timeout = hx711_scale_adaptor_irq_get_value_timeout;
+        hxa->_sa.get_value_noblock = hx711_scale_adaptor_irq_get_value_noblock;
+        hxa->_irq_enabled = true;
+
+        return true;
+
+}
+
+void hx711_scale_adaptor_irq_disable(
+    hx711_scale_adaptor_t* const hxa) {
+
+        assert(hxa != NULL);
+        assert(hxa->_hx != NULL);
+
+        if(!hxa->_irq_enabled) {
+            return;
+        }
+
+        PIO const pio = hxa->_hx->_pio;
+        const uint sm = hxa->_hx->_reader_sm;
+        const uint idx = pio_get_index(pio);
+
+        pio_set_irq0_source_enabled(
+            pio,
+            (enum pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + sm),
+            false);
+
+        if(--hx711_scale_adaptor__irq_counts[idx] == 0) {
+            irq_set_enabled(hx711_scale_adaptor__irq_nums[idx], false);
+            irq_remove_handler(
+                hx711_scale_adaptor__irq_nums[idx],
+                hx711_scale_adaptor__irq_handler);
+        }
+
+        hx711_scale_adaptor__irq_adaptors[idx][sm] = NULL;
+
+        hxa->_sa.get_value = hx711_scale_adaptor_get_value;
+        hxa->_sa.get_value_timeout = hx711_scale_adaptor_get_value_timeout;
+        hxa->_sa.get_value_noblock = hx711_scale_adaptor_get_value_noblock;
+        hxa->_irq_enabled = false;
+
+}
+
+uint32_t hx711_scale_adaptor_irq_get_overruns(
+    const hx711_scale_adaptor_t* const hxa) {
+        assert(hxa != NULL);
+        return hxa->_irq_overruns;
+}
+
+bool hx711_scale_adaptor_irq_get_value_timeout(
     scale_adaptor_t* const sa,
     int32_t* const value,
     const uint timeout) {
@@ -59,11 +254,38 @@ bool hx711_scale_adaptor_get_value_timeout(
         assert(value != NULL);
 
         hx711_scale_adaptor_t* const hxa = scale_adaptor_get_data(sa);
-        return hx711_get_value_timeout(hxa->_hx, value, timeout);
+        const absolute_time_t end = make_timeout_time_us(timeout);
+
+        //sleep until the interrupt handler provides a value or
+        //the timeout is reached
+        while(!hx711_scale_adaptor__irq_pop(hxa, value, &hxa->_value_time)) {
+            if(best_effort_wfe_or_timeout(end)) {
+                return false;
+            }
+        }
+
+        return true;
 
 }
 
-bool hx711_scale_adaptor_get_value(
+bool hx711_scale_adaptor_irq_get_value(
+    scale_adaptor_t* const sa,
+    int32_t* const value) {
+
+        assert(sa != NULL);
+        assert(value != NULL);
+
+        hx711_scale_adaptor_t* const hxa = scale_adaptor_get_data(sa);
+
+        while(!hx711_scale_adaptor__irq_pop(hxa, value, &hxa->_value_time)) {
+            __wfe();
+        }
+
+        return true;
+
+}
+
+bool hx711_scale_adaptor_irq_get_value_noblock(
     scale_adaptor_t* const sa,
     int32_t* const value) {
 
@@ -71,8 +293,227 @@ bool hx711_scale_adaptor_get_value(
         assert(value != NULL);
 
         hx711_scale_adaptor_t* const hxa = scale_adaptor_get_data(sa);
-        *value = hx711_get_value(hxa->_hx);
+
+        return hx711_scale_adaptor__irq_pop(hxa, value, &hxa->_value_time);
+
+}
+
+void hx711_scale_adaptor__irq_handler(void) {
+
+    for(uint idx = 0; idx < NUM_PIOS; ++idx) {
+
+        if(hx711_scale_adaptor__irq_counts[idx] == 0) {
+            continue;
+        }
+
+        for(uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+
+            hx711_scale_adaptor_t* const hxa = hx711_scale_adaptor__irq_adaptors[idx][sm];
+
+            if(hxa == NULL) {
+                continue;
+            }
+
+            PIO const pio = hxa->_hx->_pio;
+            const uint32_t now = time_us_32();
+
+            //a full FIFO may have been full for some time (eg. while
+            //interrupts were disabled), so its arrival says nothing
+            //about the rate
+            bool full = pio_sm_is_rx_fifo_full(pio, sm);
+
+            if(!pio_sm_is_rx_fifo_empty(pio, sm) && !full && hxa->_backlog == 0) {
+                hx711_scale_adaptor__record_time(hxa, now);
+            }
+
+            uint queued;
+
+            while((queued = pio_sm_get_rx_fifo_level(pio, sm)) > 0) {
+
+                //values still queued behind this one were captured later
+                const uint32_t captured = hx711_scale_adaptor__capture_time(hxa, now, queued, full);
+                full = false;
+                const int32_t val = hx711_get_twos_comp(pio_sm_get(pio, sm));
+                const uint32_t head = hxa->_irq_head;
+
+                //when the buffer is full this overwrites the oldest
+                //value; the reader notices and skips past it
+                hxa->_irq_buff[head & (HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN - 1)] = val;
+                hxa->_irq_times[head & (HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN - 1)] = captured;
+
+                //make sure the value is visible before the head moves
+                __dmb();
+                hxa->_irq_head = head + 1;
+
+            }
+
+        }
+
+    }
+
+    //wake a reader waiting on the other core
+    __sev();
+
+}
+
+bool hx711_scale_adaptor__irq_pop(
+    hx711_scale_adaptor_t* const hxa,
+    int32_t* const value,
+    uint32_t* const time) {
+
+        assert(hxa != NULL);
+        assert(value != NULL);
+        assert(time != NULL);
+
+        uint32_t tail = hxa->_irq_tail;
+
+        for(;;) {
+
+            const uint32_t head = hxa->_irq_head;
+
+            if(head == tail) {
+                return false;
+            }
+
+            /**
+             * The handler never waits for the reader, so when the
+             * buffer has filled the oldest values have been (or are
+             * being) overwritten. Skip to the oldest one which is
+             * still intact.
+             */
+            if(head - tail >= HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN) {
+                const uint32_t oldest = head - HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN + 1;
+                hxa->_irq_overruns += oldest - tail;
+                tail = oldest;
+            }
+
+            __dmb();
+            *value = hxa->_irq_buff[tail & (HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN - 1)];
+            *time = hxa->_irq_times[tail & (HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN - 1)];
+            __dmb();
+
+            //if the handler has since wrapped around to this entry,
+            //it may have been torn; go round again
+            if(hxa->_irq_head - tail < HX711_SCALE_ADAPTOR_IRQ_BUFF_LEN) {
+                break;
+            }
+
+        }
+
+        hxa->_irq_tail = tail + 1;
+        hxa->_value_timed = true;
 
         return true;
 
 }
+
+void hx711_scale_adaptor__record_time(
+    hx711_scale_adaptor_t* const hxa,
+    const uint32_t now) {
+
+        assert(hxa != NULL);
+
+        if(hxa->_timed) {
+
+            const uint32_t delta = now - hxa->_last_time;
+
+            /**
+             * A gap of more than two periods means values were not
+             * being read (or were missed), so it says nothing about
+             * the rate of the HX711 and is ignored.
+             */
+            if(hxa->_period_nominal == 0 || delta < hxa->_period_nominal * 2) {
+                hxa->_period_measured = hxa->_period_measured == 0
+                    ? delta
+                    : ((hxa->_period_measured * 7) + delta) / 8;
+            }
+
+        }
+
+        hxa->_last_time = now;
+        hxa->_timed = true;
+
+}
+
+uint32_t hx711_scale_adaptor__capture_time(
+    hx711_scale_adaptor_t* const hxa,
+    const uint32_t now,
+    const uint queued,
+    const bool full) {
+
+        assert(hxa != NULL);
+
+        const uint period = hxa->_period_measured > 0
+            ? hxa->_period_measured
+            : hxa->_period_nominal;
+
+        /**
+         * The newest value in the RX FIFO arrived at about now; each
+         * one ahead of it arrived a period earlier. Without this, values
+         * which waited in the FIFO would all appear to have arrived
+         * together when they were read. This is the latest each could
+         * have been captured.
+         */
+        const uint32_t latest = queued <= 1
+            ? now
+            : now - (uint32_t)((queued - 1) * period);
+
+        /**
+         * The PIO program does not wait for room in the RX FIFO, so once
+         * it is full newer values are dropped, and the newest one left
+         * may have arrived long before now. Values which were in a full
+         * FIFO instead follow on from the last value taken from it, as
+         * nothing was dropped ahead of them. The values dropped after
+         * them leave a gap before the next fresh value, which the scale
+         * counts as missed samples.
+         */
+        if(full) {
+            hxa->_backlog = queued;
+        }
+
+        uint32_t time = latest;
+
+        if(hxa->_backlog > 0) {
+
+            --hxa->_backlog;
+
+            time = hxa->_fifo_timed
+                ? hxa->_fifo_time + period
+                : latest - period;
+
+            //never later than it could have been, however long ago the
+            //last value was taken
+            if((int32_t)(time - latest) > 0) {
+                time = latest;
+            }
+
+        }
+
+        hxa->_fifo_time = time;
+        hxa->_fifo_timed = true;
+
+        return time;
+
+}
+
+void hx711_scale_adaptor__captured(
+    hx711_scale_adaptor_t* const hxa,
+    const uint queued,
+    const bool full) {
+
+        assert(hxa != NULL);
+
+        const uint32_t now = time_us_32();
+
+        //only a value which has just arrived says anything about the
+        //rate; one which waited in the FIFO does not
+        const bool fresh = queued <= 1 && !full && hxa->_backlog == 0;
+
+        hxa->_value_time = hx711_scale_adaptor__capture_time(hxa, now, queued, full);
+        hxa->_value_timed = true;
+
+        if(fresh) {
+            hx711_scale_adaptor__record_time(hxa, now);
+        }
+
+}
@@ -0,0 +1,135 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../include/kalman.h"
+
+void kalman_init(
+    kalman_t* const kf,
+    const double r,
+    const double q_min) {
+
+        assert(kf != NULL);
+        assert(r > 0);
+        assert(q_min >= 0);
+
+        kf->r = r;
+        kf->q_min = q_min;
+        kalman_reset(kf);
+
+}
+
+void kalman_reset(
+    kalman_t* const kf) {
+
+        assert(kf != NULL);
+
+        kf->_q = kf->q_min;
+        kf->_x = 0;
+        kf->_p = 0;
+        kf->_outside = 0;
+        kf->_primed = false;
+
+}
+
+void kalman_update(
+    kalman_t* const kf,
+    const int32_t z) {
+
+        assert(kf != NULL);
+
+        const double v = z - kf->_x; //innovation
+        double p = kf->_p + kf->_q; //predicted variance
+        const double s = p + kf->r; //expected innovation variance
+
+        /**
+         * If the innovation is outside the gate it is very unlikely
+         * to be noise. A single one is most likely a spike, so it is
+         * rejected; only several in a row on the same side mean the
+         * load has changed.
+         */
+        if(kf->_primed && v * v > KALMAN_GATE * KALMAN_GATE * s) {
+
+            if(v > 0) {
+                kf->_outside = kf->_outside > 0 ? kf->_outside + 1 : 1;
+            }
+            else {
+                kf->_outside = kf->_outside < 0 ? kf->_outside - 1 : -1;
+            }
+
+            if((unsigned)abs(kf->_outside) < KALMAN_STEP_COUNT) {
+                return;
+            }
+
+            kf->_primed = false;
+
+        }
+
+        //the first value, or the first at a new load, is the best
+        //estimate available
+        if(!kf->_primed) {
+            kf->_x = z;
+            kf->_p = kf->r;
+            kf->_q = kf->q_min;
+            kf->_outside = 0;
+            kf->_primed = true;
+            return;
+        }
+
+        kf->_outside = 0;
+
+        //innovations consistently larger than expected mean the
+        //load is moving, so allow the estimate to move faster
+        kf->_q = fmax(
+            kf->q_min,
+            ((1 - KALMAN_Q_ALPHA) * kf->_q) + (KALMAN_Q_ALPHA * (v * v - s)));
+
+        const double k = p / (p + kf->r); //gain
+
+        kf->_x += k * v;
+        kf->_p = (1 - k) * p;
+
+}
+
+void kalman_update_all(
+    kalman_t* const kf,
+    const int32_t* const arr,
+    const size_t len,
+    double* const est) {
+
+        assert(kf != NULL);
+        assert(arr != NULL);
+        assert(len > 0);
+        assert(est != NULL);
+
+        for(size_t i = 0; i < len; ++i) {
+            kalman_update(kf, arr[i]);
+        }
+
+        *est = kf->_x;
+
+}
@@ -0,0 +1,211 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/peak.h"
+
+void peak_init(
+    peak_t* const pk) {
+
+        assert(pk != NULL);
+
+        peak_reset(pk);
+
+        pk->_buff = NULL;
+        pk->_bufflen = 0;
+        pk->_pre = 0;
+        pk->_level = 0;
+        pk->_trigger = peak_trigger_above;
+        pk->_state = peak__capture_off;
+        pk->_head = 0;
+        pk->_count = 0;
+        pk->_post = 0;
+        pk->_trigger_index = 0;
+
+}
+
+void peak_reset(
+    peak_t* const pk) {
+
+        assert(pk != NULL);
+
+        pk->_held = false;
+
+}
+
+void peak_feed(
+    peak_t* const pk,
+    const int32_t value,
+    const uint32_t time) {
+
+        assert(pk != NULL);
+
+        if(!pk->_held) {
+            pk->_max.value = pk->_min.value = value;
+            pk->_max.time = pk->_min.time = time;
+            pk->_held = true;
+        }
+        else if(value > pk->_max.value) {
+            pk->_max.value = value;
+            pk->_max.time = time;
+        }
+        else if(value < pk->_min.value) {
+            pk->_min.value = value;
+            pk->_min.time = time;
+        }
+
+        if(pk->_state == peak__capture_off || pk->_state == peak__capture_done) {
+            return;
+        }
+
+        if(pk->_state == peak__capture_armed) {
+
+            const bool met = pk->_trigger == peak_trigger_above
+                ? value >= pk->_level
+                : value <= pk->_level;
+
+            if(met) {
+                pk->_state = peak__capture_triggered;
+
+                //the rest of the buffer after the pre-trigger
+                //samples recorded so far is for the trigger onwards
+                pk->_trigger_index = pk->_count;
+                pk->_post = pk->_bufflen - pk->_count;
+            }
+
+        }
+
+        pk->_buff[pk->_head].value = value;
+        pk->_buff[pk->_head].time = time;
+        pk->_head = (pk->_head + 1) % pk->_bufflen;
+
+        if(pk->_state == peak__capture_armed) {
+            //keep at most pre samples from before the trigger
+            if(pk->_count < pk->_pre) {
+                ++pk->_count;
+            }
+        }
+        else {
+            ++pk->_count;
+            if(--pk->_post == 0) {
+                pk->_state = peak__capture_done;
+            }
+        }
+
+}
+
+bool peak_get_max(
+    const peak_t* const pk,
+    peak_sample_t* const s) {
+
+        assert(pk != NULL);
+        assert(s != NULL);
+
+        if(!pk->_held) {
+            return false;
+        }
+
+        *s = pk->_max;
+        return true;
+
+}
+
+bool peak_get_min(
+    const peak_t* const pk,
+    peak_sample_t* const s) {
+
+        assert(pk != NULL);
+        assert(s != NULL);
+
+        if(!pk->_held) {
+            return false;
+        }
+
+        *s = pk->_min;
+        return true;
+
+}
+
+void peak_capture_arm(
+    peak_t* const pk,
+    peak_sample_t* const buff,
+    const size_t bufflen,
+    const size_t pre,
+    const int32_t level,
+    const peak_trigger_t trigger) {
+
+        assert(pk != NULL);
+        assert(buff != NULL);
+        assert(bufflen > 0);
+        assert(pre < bufflen);
+
+        pk->_buff = buff;
+        pk->_bufflen = bufflen;
+        pk->_pre = pre;
+        pk->_level = level;
+        pk->_trigger = trigger;
+        pk->_head = 0;
+        pk->_count = 0;
+        pk->_post = 0;
+        pk->_trigger_index = 0;
+        pk->_state = peak__capture_armed;
+
+}
+
+bool peak_capture_is_done(
+    const peak_t* const pk) {
+        assert(pk != NULL);
+        return pk->_state == peak__capture_done;
+}
+
+size_t peak_capture_read(
+    const peak_t* const pk,
+    peak_sample_t* const out,
+    const size_t outlen,
+    size_t* const trigger) {
+
+        assert(pk != NULL);
+        assert(out != NULL);
+        assert(trigger != NULL);
+
+        if(pk->_state != peak__capture_done) {
+            return 0;
+        }
+
+        assert(outlen >= pk->_count);
+
+        //the newest sample is just before _head, so the oldest
+        //is _count samples before that
+        const size_t start = (pk->_head + pk->_bufflen - pk->_count) % pk->_bufflen;
+
+        for(size_t i = 0; i < pk->_count; ++i) {
+            out[i] = pk->_buff[(start + i) % pk->_bufflen];
+        }
+
+        *trigger = pk->_trigger_index;
+
+        return pk->_count;
+
+}
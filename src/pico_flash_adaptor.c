@@ -0,0 +1,155 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "hardware/flash.h"
+#include "pico/error.h"
+#include "pico/flash.h"
+#include "../include/flash_adaptor.h"
+#include "../include/pico_flash_adaptor.h"
+
+typedef struct {
+    uint32_t offset; //bytes from the start of flash
+    const uint8_t* buff;
+} pico_flash_adaptor__op_t;
+
+static void pico_flash_adaptor__program(
+    void* const param) {
+        const pico_flash_adaptor__op_t* const op = param;
+        flash_range_program(op->offset, op->buff, FLASH_PAGE_SIZE);
+}
+
+static void pico_flash_adaptor__erase(
+    void* const param) {
+        const pico_flash_adaptor__op_t* const op = param;
+        flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+}
+
+bool pico_flash_adaptor_init(
+    pico_flash_adaptor_t* const pfa,
+    const uint32_t offset,
+    const uint32_t size) {
+
+        assert(pfa != NULL);
+        assert(offset % FLASH_SECTOR_SIZE == 0);
+        assert(size % FLASH_SECTOR_SIZE == 0);
+        assert(size > 0);
+
+        pfa->_offset = offset;
+
+        flash_adaptor_init(&pfa->_fa, pfa);
+        pfa->_fa.read = pico_flash_adaptor_read;
+        pfa->_fa.program = pico_flash_adaptor_program;
+        pfa->_fa.erase = pico_flash_adaptor_erase;
+        pfa->_fa.size = size;
+        pfa->_fa.sector_size = FLASH_SECTOR_SIZE;
+        pfa->_fa.page_size = FLASH_PAGE_SIZE;
+
+        return true;
+
+}
+
+flash_adaptor_t* pico_flash_adaptor_get_base(
+    pico_flash_adaptor_t* const pfa) {
+        assert(pfa != NULL);
+        return &pfa->_fa;
+}
+
+bool pico_flash_adaptor_read(
+    flash_adaptor_t* const fa,
+    const uint32_t offset,
+    uint8_t* const buff,
+    const size_t len) {
+
+        assert(fa != NULL);
+        assert(buff != NULL);
+
+        if(offset > fa->size || len > fa->size - offset) {
+            return false;
+        }
+
+        const pico_flash_adaptor_t* const pfa =
+            (const pico_flash_adaptor_t*)flash_adaptor_get_data(fa);
+
+        //flash is memory mapped
+        memcpy(buff, (const uint8_t*)(uintptr_t)(XIP_BASE + pfa->_offset + offset), len);
+
+        return true;
+
+}
+
+bool pico_flash_adaptor_program(
+    flash_adaptor_t* const fa,
+    const uint32_t offset,
+    const uint8_t* const buff) {
+
+        assert(fa != NULL);
+        assert(buff != NULL);
+
+        if(offset % FLASH_PAGE_SIZE != 0 || offset >= fa->size) {
+            return false;
+        }
+
+        const pico_flash_adaptor_t* const pfa =
+            (const pico_flash_adaptor_t*)flash_adaptor_get_data(fa);
+
+        pico_flash_adaptor__op_t op = {
+            .offset = pfa->_offset + offset,
+            .buff = buff
+        };
+
+        //pauses the other core as well as interrupts on this one
+        return flash_safe_execute(
+            pico_flash_adaptor__program,
+            &op,
+            PICO_FLASH_ADAPTOR_SAFE_TIMEOUT) == PICO_OK;
+
+}
+
+bool pico_flash_adaptor_erase(
+    flash_adaptor_t* const fa,
+    const uint32_t offset) {
+
+        assert(fa != NULL);
+
+        if(offset % FLASH_SECTOR_SIZE != 0 || offset >= fa->size) {
+            return false;
+        }
+
+        const pico_flash_adaptor_t* const pfa =
+            (const pico_flash_adaptor_t*)flash_adaptor_get_data(fa);
+
+        pico_flash_adaptor__op_t op = {
+            .offset = pfa->_offset + offset,
+            .buff = NULL
+        };
+
+        return flash_safe_execute(
+            pico_flash_adaptor__erase,
+            &op,
+            PICO_FLASH_ADAPTOR_SAFE_TIMEOUT) == PICO_OK;
+
+}
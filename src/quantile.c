@@ -0,0 +1,185 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/quantile.h"
+
+void quantile_p2_init(
+    quantile_p2_t* const qe,
+    const double p) {
+
+        assert(qe != NULL);
+        assert(p >= 0 && p <= 1);
+
+        qe->_p = p;
+        qe->_count = 0;
+
+        for(uint32_t i = 0; i < QUANTILE_P2_MARKERS; ++i) {
+            qe->_q[i] = 0;
+            qe->_n[i] = i;
+        }
+
+        qe->_np[0] = 0;
+        qe->_np[1] = 2 * p;
+        qe->_np[2] = 4 * p;
+        qe->_np[3] = 2 + (2 * p);
+        qe->_np[4] = 4;
+
+        qe->_dn[0] = 0;
+        qe->_dn[1] = p / 2;
+        qe->_dn[2] = p;
+        qe->_dn[3] = (1 + p) / 2;
+        qe->_dn[4] = 1;
+
+}
+
+void quantile_p2_add(
+    quantile_p2_t* const qe,
+    const int32_t val) {
+
+        assert(qe != NULL);
+
+        const double x = val;
+
+        /**
+         * Until every marker has a value, just keep the values
+         * in order. An insertion sort of five values is trivial.
+         */
+        if(qe->_count < QUANTILE_P2_MARKERS) {
+
+            uint32_t i = qe->_count++;
+
+            for(; i > 0 && qe->_q[i - 1] > x; --i) {
+                qe->_q[i] = qe->_q[i - 1];
+            }
+
+            qe->_q[i] = x;
+            return;
+
+        }
+
+        ++qe->_count;
+
+        //find the cell the value falls in, extending the
+        //extreme markers if necessary
+        uint32_t k;
+
+        if(x < qe->_q[0]) {
+            qe->_q[0] = x;
+            k = 0;
+        }
+        else if(x >= qe->_q[4]) {
+            qe->_q[4] = x;
+            k = 3;
+        }
+        else {
+            k = 0;
+            while(k < 3 && x >= qe->_q[k + 1]) {
+                ++k;
+            }
+        }
+
+        for(uint32_t i = k + 1; i < QUANTILE_P2_MARKERS; ++i) {
+            ++qe->_n[i];
+        }
+
+        for(uint32_t i = 0; i < QUANTILE_P2_MARKERS; ++i) {
+            qe->_np[i] += qe->_dn[i];
+        }
+
+        //move the middle markers towards their desired positions
+        for(uint32_t i = 1; i < QUANTILE_P2_MARKERS - 1; ++i) {
+
+            const double d = qe->_np[i] - qe->_n[i];
+            const int64_t below = (int64_t)qe->_n[i] - qe->_n[i - 1];
+            const int64_t above = (int64_t)qe->_n[i + 1] - qe->_n[i];
+
+            if(!((d >= 1 && above > 1) || (d <= -1 && below > 1))) {
+                continue;
+            }
+
+            const int s = d >= 0 ? 1 : -1;
+            const double ql = qe->_q[i - 1];
+            const double qi = qe->_q[i];
+            const double qr = qe->_q[i + 1];
+
+            //piecewise-parabolic prediction
+            double qn = qi + ((double)s / (double)(below + above)) * (
+                ((below + s) * (qr - qi) / above) +
+                ((above - s) * (qi - ql) / below));
+
+            //fall back to linear prediction if the parabola would
+            //put the marker out of order
+            if(qn <= ql || qn >= qr) {
+                const uint32_t j = (uint32_t)((int)i + s);
+                qn = qi + (s * (qe->_q[j] - qi) / ((int64_t)qe->_n[j] - qe->_n[i]));
+            }
+
+            qe->_q[i] = qn;
+            qe->_n[i] = (uint32_t)((int64_t)qe->_n[i] + s);
+
+        }
+
+}
+
+void quantile_p2_add_all(
+    quantile_p2_t* const qe,
+    const int32_t* const arr,
+    const size_t len) {
+
+        assert(qe != NULL);
+        assert(arr != NULL);
+
+        for(size_t i = 0; i < len; ++i) {
+            quantile_p2_add(qe, arr[i]);
+        }
+
+}
+
+bool quantile_p2_get(
+    const quantile_p2_t* const qe,
+    double* const val) {
+
+        assert(qe != NULL);
+        assert(val != NULL);
+
+        if(qe->_count == 0) {
+            return false;
+        }
+
+        if(qe->_count <= QUANTILE_P2_MARKERS) {
+            //values are still held in order, so interpolate
+            const double pos = qe->_p * (qe->_count - 1);
+            const uint32_t lo = (uint32_t)floor(pos);
+            const uint32_t hi = (uint32_t)ceil(pos);
+            *val = qe->_q[lo] + ((pos - lo) * (qe->_q[hi] - qe->_q[lo]));
+            return true;
+        }
+
+        *val = qe->_q[2];
+        return true;
+
+}
@@ -0,0 +1,485 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/bytes.h"
+#include "../include/codec.h"
+#include "../include/flash_adaptor.h"
+#include "../include/mass.h"
+#include "../include/recorder.h"
+
+/**
+ * Room needed to start a samples record holding at least one value
+ */
+static const size_t RECORDER__SAMPLES_MIN =
+    RECORDER_SAMPLES_HEADER_LEN + CODEC_VALUE_MAX;
+
+static inline bool recorder__is_valid(
+    const uint8_t* const header) {
+
+        const uint32_t seq = bytes_get_u32(header);
+        const uint16_t used = bytes_get_u16(header + 6);
+
+        //erased flash reads as 0xff
+        return seq != 0xffffffffu &&
+            bytes_get_u16(header + 4) == RECORDER_PAGE_MAGIC &&
+            used >= RECORDER_HEADER_LEN &&
+            used <= RECORDER_PAGE_LEN;
+
+}
+
+bool recorder_init(
+    recorder_t* const rec,
+    flash_adaptor_t* const fa) {
+
+        assert(rec != NULL);
+        assert(fa != NULL);
+        assert(fa->page_size == RECORDER_PAGE_LEN);
+        assert(fa->sector_size % fa->page_size == 0);
+        assert(fa->size % fa->sector_size == 0);
+
+        uint32_t oldest;
+        uint32_t newest;
+        uint32_t seq;
+
+        rec->_fa = fa;
+        rec->_fill = 0;
+        rec->_len = RECORDER_HEADER_LEN;
+        rec->_pending = false;
+        rec->_dropped = 0;
+
+        memset(rec->_pages[0], 0xff, RECORDER_PAGE_LEN);
+
+        if(!recorder__find(fa, &oldest, &newest, &seq)) {
+            return false;
+        }
+
+        if(oldest == fa->size) {
+            //nothing recorded yet
+            rec->_head = 0;
+            rec->_seq = 0;
+        }
+        else {
+            //continue after the newest page
+            rec->_head = (newest + RECORDER_PAGE_LEN) % fa->size;
+            rec->_seq = seq + 1;
+        }
+
+        //pages are programmed in order, so the rest of a sector which
+        //has been started is still erased
+        rec->_head_erased = rec->_head % fa->sector_size != 0;
+
+        return true;
+
+}
+
+bool recorder_add_samples(
+    recorder_t* const rec,
+    const int32_t* const values,
+    const uint32_t* const times,
+    const size_t len) {
+
+        assert(rec != NULL);
+        assert(values != NULL);
+
+        codec_encoder_t enc;
+        size_t i = 0;
+
+        while(i < len) {
+
+            if(!recorder__reserve(rec, RECORDER__SAMPLES_MIN)) {
+                rec->_dropped += (uint32_t)(len - i);
+                return false;
+            }
+
+            uint8_t* const p = &rec->_pages[rec->_fill][rec->_len];
+            const size_t room = RECORDER_PAGE_LEN - rec->_len - RECORDER_SAMPLES_HEADER_LEN;
+
+            //each record is a single block, so starts with a checkpoint
+            codec_encoder_init(
+                &enc,
+                p + RECORDER_SAMPLES_HEADER_LEN,
+                room < 0xff ? room : 0xff,
+                RECORDER_MAX_SAMPLES,
+                NULL,
+                0);
+
+            const size_t n = codec_encoder_add_all(
+                &enc,
+                values + i,
+                len - i < RECORDER_MAX_SAMPLES ? len - i : RECORDER_MAX_SAMPLES);
+
+            uint32_t time = 0;
+            uint32_t period = 0;
+
+            if(times != NULL) {
+                time = times[i];
+                if(n > 1) {
+                    period = (times[i + n - 1] - time) / (uint32_t)(n - 1);
+                }
+            }
+
+            p[0] = (uint8_t)recorder_record_samples;
+            p[1] = (uint8_t)n;
+            p[2] = (uint8_t)codec_encoder_get_len(&enc);
+            bytes_put_u32(p + 3, time);
+            bytes_put_u16(p + 7, period < 0xffff ? (uint16_t)period : 0xffff);
+
+            rec->_len += RECORDER_SAMPLES_HEADER_LEN + codec_encoder_get_len(&enc);
+            i += n;
+
+        }
+
+        return true;
+
+}
+
+bool recorder_add_weight(
+    recorder_t* const rec,
+    const uint32_t time,
+    const double raw,
+    const mass_t* const m) {
+
+        assert(rec != NULL);
+        assert(m != NULL);
+
+        if(!recorder__reserve(rec, RECORDER_WEIGHT_LEN)) {
+            ++rec->_dropped;
+            return false;
+        }
+
+        uint8_t* const p = &rec->_pages[rec->_fill][rec->_len];
+
+        p[0] = (uint8_t)recorder_record_weight;
+        bytes_put_u32(p + 1, time);
+        bytes_put_f32(p + 5, (float)raw);
+        bytes_put_f64(p + 9, m->ug);
+        p[17] = (uint8_t)m->unit;
+
+        rec->_len += RECORDER_WEIGHT_LEN;
+
+        return true;
+
+}
+
+bool recorder_flush(
+    recorder_t* const rec) {
+
+        assert(rec != NULL);
+
+        if(rec->_len == RECORDER_HEADER_LEN) {
+            //nothing to write
+            return true;
+        }
+
+        return recorder__close(rec);
+
+}
+
+bool recorder_service(
+    recorder_t* const rec) {
+
+        assert(rec != NULL);
+
+        flash_adaptor_t* const fa = rec->_fa;
+
+        //erase ahead, so the sector is ready before a page is
+        if(!rec->_head_erased) {
+            if(!fa->erase(fa, rec->_head)) {
+                return false;
+            }
+            rec->_head_erased = true;
+            return true;
+        }
+
+        if(!rec->_pending) {
+            return true;
+        }
+
+        if(!fa->program(fa, rec->_head, rec->_pages[rec->_fill ^ 1])) {
+            return false;
+        }
+
+        rec->_pending = false;
+        rec->_head = (rec->_head + RECORDER_PAGE_LEN) % fa->size;
+
+        //the next sector holds the oldest pages; erase it next time
+        if(rec->_head % fa->sector_size == 0) {
+            rec->_head_erased = false;
+        }
+
+        return true;
+
+}
+
+bool recorder_is_idle(
+    const recorder_t* const rec) {
+        assert(rec != NULL);
+        return rec->_head_erased && !rec->_pending;
+}
+
+uint32_t recorder_get_dropped(
+    const recorder_t* const rec) {
+        assert(rec != NULL);
+        return rec->_dropped;
+}
+
+bool recorder_reader_init(
+    recorder_reader_t* const rd,
+    flash_adaptor_t* const fa) {
+
+        assert(rd != NULL);
+        assert(fa != NULL);
+        assert(fa->page_size == RECORDER_PAGE_LEN);
+
+        uint32_t newest;
+        uint32_t seq;
+
+        rd->_fa = fa;
+        rd->_pos = 0;
+        rd->_used = 0;
+        rd->_seq = 0;
+
+        if(!recorder__find(fa, &rd->_next, &newest, &seq)) {
+            return false;
+        }
+
+        rd->_pages_left = rd->_next == fa->size
+            ? 0
+            : fa->size / RECORDER_PAGE_LEN;
+
+        return true;
+
+}
+
+bool recorder_reader_next(
+    recorder_reader_t* const rd,
+    recorder_record_t* const r) {
+
+        assert(rd != NULL);
+        assert(r != NULL);
+
+        for(;;) {
+
+            //move to the next page with records
+            while(rd->_pos >= rd->_used) {
+
+                if(rd->_pages_left == 0) {
+                    return false;
+                }
+
+                if(!rd->_fa->read(rd->_fa, rd->_next, rd->_page, RECORDER_PAGE_LEN)) {
+                    return false;
+                }
+
+                --rd->_pages_left;
+                rd->_next = (rd->_next + RECORDER_PAGE_LEN) % rd->_fa->size;
+
+                if(recorder__is_valid(rd->_page)) {
+                    rd->_seq = bytes_get_u32(rd->_page);
+                    rd->_used = bytes_get_u16(rd->_page + 6);
+                    rd->_pos = RECORDER_HEADER_LEN;
+                }
+
+            }
+
+            const uint8_t* const p = &rd->_page[rd->_pos];
+            const size_t left = rd->_used - rd->_pos;
+
+            r->seq = rd->_seq;
+            r->type = (recorder_record_type_t)p[0];
+
+            if(r->type == recorder_record_samples &&
+                left >= RECORDER_SAMPLES_HEADER_LEN &&
+                left - RECORDER_SAMPLES_HEADER_LEN >= p[2]) {
+
+                    codec_decoder_t dec;
+
+                    codec_decoder_init(
+                        &dec,
+                        p + RECORDER_SAMPLES_HEADER_LEN,
+                        p[2],
+                        RECORDER_MAX_SAMPLES);
+
+                    r->time = bytes_get_u32(p + 3);
+                    r->period = bytes_get_u16(p + 7);
+                    r->count = codec_decoder_read(&dec, r->values, p[1]);
+                    rd->_pos += RECORDER_SAMPLES_HEADER_LEN + p[2];
+
+                    if(r->count == p[1]) {
+                        return true;
+                    }
+
+            }
+            else if(r->type == recorder_record_weight &&
+                left >= RECORDER_WEIGHT_LEN &&
+                p[17] <= (uint8_t)mass_oz) {
+
+                    r->time = bytes_get_u32(p + 1);
+                    r->raw = bytes_get_f32(p + 5);
+                    r->ug = bytes_get_f64(p + 9);
+                    r->unit = (mass_unit_t)p[17];
+                    rd->_pos += RECORDER_WEIGHT_LEN;
+
+                    return true;
+
+            }
+            else {
+                //the rest of the page cannot be trusted
+                rd->_pos = rd->_used;
+            }
+
+        }
+
+}
+
+bool recorder_dump(
+    flash_adaptor_t* const fa,
+    const recorder_write_t write,
+    void* const data) {
+
+        assert(fa != NULL);
+        assert(write != NULL);
+
+        uint8_t page[RECORDER_PAGE_LEN];
+        uint32_t offset;
+        uint32_t newest;
+        uint32_t seq;
+
+        if(!recorder__find(fa, &offset, &newest, &seq)) {
+            return false;
+        }
+
+        if(offset == fa->size) {
+            return true;
+        }
+
+        for(uint32_t i = 0; i < fa->size / RECORDER_PAGE_LEN; ++i) {
+
+            if(!fa->read(fa, offset, page, RECORDER_PAGE_LEN)) {
+                return false;
+            }
+
+            if(recorder__is_valid(page) && !write(page, RECORDER_PAGE_LEN, data)) {
+                return false;
+            }
+
+            offset = (offset + RECORDER_PAGE_LEN) % fa->size;
+
+        }
+
+        return true;
+
+}
+
+bool recorder__find(
+    flash_adaptor_t* const fa,
+    uint32_t* const oldest,
+    uint32_t* const newest,
+    uint32_t* const newest_seq) {
+
+        assert(fa != NULL);
+        assert(oldest != NULL);
+        assert(newest != NULL);
+        assert(newest_seq != NULL);
+
+        uint8_t header[RECORDER_HEADER_LEN];
+        uint32_t oldest_seq = 0;
+
+        //fa->size means not found
+        *oldest = fa->size;
+        *newest = fa->size;
+        *newest_seq = 0;
+
+        for(uint32_t offset = 0; offset < fa->size; offset += RECORDER_PAGE_LEN) {
+
+            if(!fa->read(fa, offset, header, sizeof(header))) {
+                return false;
+            }
+
+            if(!recorder__is_valid(header)) {
+                continue;
+            }
+
+            const uint32_t seq = bytes_get_u32(header);
+
+            if(*oldest == fa->size || seq < oldest_seq) {
+                *oldest = offset;
+                oldest_seq = seq;
+            }
+
+            if(*newest == fa->size || seq > *newest_seq) {
+                *newest = offset;
+                *newest_seq = seq;
+            }
+
+        }
+
+        return true;
+
+}
+
+bool recorder__reserve(
+    recorder_t* const rec,
+    const size_t len) {
+
+        assert(rec != NULL);
+        assert(len <= RECORDER_PAGE_LEN - RECORDER_HEADER_LEN);
+
+        if(RECORDER_PAGE_LEN - rec->_len >= len) {
+            return true;
+        }
+
+        return recorder__close(rec);
+
+}
+
+bool recorder__close(
+    recorder_t* const rec) {
+
+        assert(rec != NULL);
+
+        //both pages full
+        if(rec->_pending) {
+            return false;
+        }
+
+        uint8_t* const page = rec->_pages[rec->_fill];
+
+        bytes_put_u32(page, rec->_seq++);
+        bytes_put_u16(page + 4, RECORDER_PAGE_MAGIC);
+        bytes_put_u16(page + 6, (uint16_t)rec->_len);
+
+        rec->_pending = true;
+        rec->_fill ^= 1;
+        rec->_len = RECORDER_HEADER_LEN;
+
+        //unused bytes are left as erased flash
+        memset(rec->_pages[rec->_fill], 0xff, RECORDER_PAGE_LEN);
+
+        return true;
+
+}
@@ -0,0 +1,344 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pico/time.h"
+#include "../include/bytes.h"
+#include "../include/capture.h"
+#include "../include/replay_scale_adaptor.h"
+#include "../include/scale_adaptor.h"
+
+bool replay_scale_adaptor_open(
+    replay_scale_adaptor_t* const rsa,
+    const char* const path,
+    const replay_mode_t mode) {
+
+        assert(rsa != NULL);
+        assert(path != NULL);
+
+        //nothing is mapped until the file checks out, so closing after
+        //a failed open is harmless
+        rsa->_map = NULL;
+        rsa->_maplen = 0;
+        rsa->_samples = NULL;
+        rsa->_count = 0;
+        rsa->_pos = 0;
+
+        //values are used straight from the file, so must already be
+        //in the host's byte order
+        const uint16_t probe = 1;
+        if(*(const uint8_t*)&probe != 1) {
+            return false;
+        }
+
+        const int fd = open(path, O_RDONLY);
+
+        if(fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+
+        if(fstat(fd, &st) != 0 || st.st_size < (off_t)CAPTURE_HEADER_LEN) {
+            close(fd);
+            return false;
+        }
+
+        void* const map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        //the mapping stays valid after the file is closed
+        close(fd);
+
+        if(map == MAP_FAILED) {
+            return false;
+        }
+
+        const uint8_t* const header = (const uint8_t*)map;
+
+        if(bytes_get_u32(header) != CAPTURE_MAGIC ||
+            bytes_get_u16(header + 4) != CAPTURE_VERSION ||
+            bytes_get_u16(header + 6) != sizeof(capture_sample_t)) {
+                munmap(map, (size_t)st.st_size);
+                return false;
+        }
+
+        rsa->_map = map;
+        rsa->_maplen = (size_t)st.st_size;
+        rsa->_samples = (const capture_sample_t*)(header + CAPTURE_HEADER_LEN);
+        rsa->_count = (rsa->_maplen - CAPTURE_HEADER_LEN) / sizeof(capture_sample_t);
+        rsa->_mode = mode;
+        rsa->_period_nominal = bytes_get_u32(header + 8);
+        rsa->_period_measured = 0;
+
+        //the mean over the whole capture. Captures can span many timer
+        //wraps, so sum each difference modulo 2^32 rather than taking
+        //the difference between the first and last times
+        if(rsa->_count > 1) {
+
+            uint64_t span = 0;
+
+            for(size_t i = 1; i < rsa->_count; ++i) {
+                span += (uint32_t)(rsa->_samples[i].time - rsa->_samples[i - 1].time);
+            }
+
+            rsa->_period_measured = (uint32_t)(span / (rsa->_count - 1));
+
+        }
+
+        //large sequential reads
+        madvise(map, rsa->_maplen, MADV_SEQUENTIAL);
+
+        scale_adaptor_init(&rsa->_sa, rsa);
+        rsa->_sa.get_value = replay_scale_adaptor_get_value;
+        rsa->_sa.get_value_timeout = replay_scale_adaptor_get_value_timeout;
+        rsa->_sa.get_value_noblock = replay_scale_adaptor_get_value_noblock;
+        rsa->_sa.get_period = replay_scale_adaptor_get_period;
+        rsa->_sa.get_time = replay_scale_adaptor_get_time;
+
+        replay_scale_adaptor_rewind(rsa);
+
+        return true;
+
+}
+
+void replay_scale_adaptor_close(
+    replay_scale_adaptor_t* const rsa) {
+
+        assert(rsa != NULL);
+
+        if(rsa->_map != NULL) {
+            munmap(rsa->_map, rsa->_maplen);
+        }
+
+        rsa->_map = NULL;
+        rsa->_maplen = 0;
+        rsa->_samples = NULL;
+        rsa->_count = 0;
+        rsa->_pos = 0;
+        rsa->_period_measured = 0;
+
+}
+
+scale_adaptor_t* replay_scale_adaptor_get_base(
+    replay_scale_adaptor_t* const rsa) {
+        assert(rsa != NULL);
+        return &rsa->_sa;
+}
+
+void replay_scale_adaptor_rewind(
+    replay_scale_adaptor_t* const rsa) {
+
+        assert(rsa != NULL);
+
+        rsa->_pos = 0;
+        rsa->_due = time_us_64();
+
+}
+
+bool replay_scale_adaptor_is_done(
+    const replay_scale_adaptor_t* const rsa) {
+        assert(rsa != NULL);
+        return rsa->_pos >= rsa->_count;
+}
+
+size_t replay_scale_adaptor_get_count(
+    const replay_scale_adaptor_t* const rsa) {
+        assert(rsa != NULL);
+        return rsa->_count;
+}
+
+size_t replay_scale_adaptor_get_batch(
+    replay_scale_adaptor_t* const rsa,
+    const capture_sample_t** const samples,
+    const size_t len) {
+
+        assert(rsa != NULL);
+        assert(samples != NULL);
+
+        size_t n = rsa->_count - rsa->_pos;
+
+        if(n > len) {
+            n = len;
+        }
+
+        const uint64_t now = time_us_64();
+
+        *samples = &rsa->_samples[rsa->_pos];
+
+        for(size_t i = 0; i < n; ++i) {
+            if(rsa->_mode == replay_mode_realtime && rsa->_due > now) {
+                return i;
+            }
+            replay_scale_adaptor__take(rsa);
+        }
+
+        return n;
+
+}
+
+bool replay_scale_adaptor_get_value(
+    scale_adaptor_t* const sa,
+    int32_t* const value) {
+
+        assert(sa != NULL);
+        assert(value != NULL);
+
+        replay_scale_adaptor_t* const rsa =
+            (replay_scale_adaptor_t*)scale_adaptor_get_data(sa);
+
+        //the capture has ended; there will never be another value
+        if(replay_scale_adaptor_is_done(rsa)) {
+            return false;
+        }
+
+        if(rsa->_mode == replay_mode_realtime) {
+            const uint64_t now = time_us_64();
+            if(rsa->_due > now) {
+                sleep_us(rsa->_due - now);
+            }
+        }
+
+        *value = replay_scale_adaptor__take(rsa);
+
+        return true;
+
+}
+
+bool replay_scale_adaptor_get_value_timeout(
+    scale_adaptor_t* const sa,
+    int32_t* const value,
+    const uint timeout) {
+
+        assert(sa != NULL);
+        assert(value != NULL);
+
+        replay_scale_adaptor_t* const rsa =
+            (replay_scale_adaptor_t*)scale_adaptor_get_data(sa);
+
+        if(replay_scale_adaptor_is_done(rsa)) {
+            return false;
+        }
+
+        if(rsa->_mode == replay_mode_realtime) {
+
+            const uint64_t now = time_us_64();
+
+            //the value will not arrive in time, so wait as the
+            //device would and give up
+            if(rsa->_due > now + timeout) {
+                sleep_us(timeout);
+                return false;
+            }
+
+            if(rsa->_due > now) {
+                sleep_us(rsa->_due - now);
+            }
+
+        }
+
+        *value = replay_scale_adaptor__take(rsa);
+
+        return true;
+
+}
+
+bool replay_scale_adaptor_get_value_noblock(
+    scale_adaptor_t* const sa,
+    int32_t* const value) {
+        return replay_scale_adaptor_get_value_timeout(sa, value, 0);
+}
+
+bool replay_scale_adaptor_get_period(
+    scale_adaptor_t* const sa,
+    uint* const nominal,
+    uint* const measured) {
+
+        assert(sa != NULL);
+        assert(nominal != NULL);
+        assert(measured != NULL);
+
+        const replay_scale_adaptor_t* const rsa =
+            (const replay_scale_adaptor_t*)scale_adaptor_get_data(sa);
+
+        *nominal = rsa->_period_nominal;
+        *measured = rsa->_period_measured;
+
+        return true;
+
+}
+
+bool replay_scale_adaptor_get_time(
+    scale_adaptor_t* const sa,
+    uint32_t* const time) {
+
+        assert(sa != NULL);
+        assert(time != NULL);
+
+        const replay_scale_adaptor_t* const rsa =
+            (const replay_scale_adaptor_t*)scale_adaptor_get_data(sa);
+
+        if(rsa->_pos == 0) {
+            return false;
+        }
+
+        *time = rsa->_time;
+
+        return true;
+
+}
+
+int32_t replay_scale_adaptor__take(
+    replay_scale_adaptor_t* const rsa) {
+
+        assert(rsa != NULL);
+        assert(rsa->_pos < rsa->_count);
+
+        const size_t i = rsa->_pos++;
+
+        //in fast mode nothing waits for values to fall due, so one
+        //already overdue (eg. after the caller was idle) is taken to be
+        //captured now, as it would otherwise look stale
+        if(rsa->_mode == replay_mode_fast) {
+            const uint64_t now = time_us_64();
+            if(rsa->_due < now) {
+                rsa->_due = now;
+            }
+        }
+
+        rsa->_time = (uint32_t)rsa->_due;
+
+        //the next value is due as long after this one as it was when
+        //captured; modulo 2^32, so a capture can span a timer wrap
+        if(rsa->_pos < rsa->_count) {
+            rsa->_due += rsa->_samples[rsa->_pos].time - rsa->_samples[i].time;
+        }
+
+        return rsa->_samples[i].value;
+
+}
@@ -25,11 +25,40 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include "hardware/sync.h"
 #include "pico/time.h"
+#include "../include/filter.h"
+#include "../include/kalman.h"
+#include "../include/quantile.h"
 #include "../include/scale.h"
+#include "../include/scale_acquire.h"
 #include "../include/scale_adaptor.h"
+#include "../include/scale_internal.h"
+#include "../include/scale_perf.h"
 #include "../include/util.h"
 
+static inline bool scale__dynamic_get_value(
+    scale_adaptor_t* const sa,
+    int32_t* const value) {
+        return sa->get_value(sa, value);
+}
+
+static inline bool scale__dynamic_get_value_timeout(
+    scale_adaptor_t* const sa,
+    int32_t* const value,
+    const uint timeout) {
+        return sa->get_value_timeout(sa, value, timeout);
+}
+
+//the runtime acquisition loops, through the adaptor's function pointers
+SCALE__ACQUIRE_DEFINE(
+    scale__dynamic,
+    scale_adaptor_t,
+    scale__dynamic_get_value,
+    scale__dynamic_get_value_timeout,
+    scale_adaptor_get_value_noblock,
+    scale_adaptor_get_time)
+
 void scale_options_get_default(
     scale_options_t* const opt) {
         assert(opt != NULL);
@@ -51,6 +80,37 @@ void scale_init(
         sc->unit = unit;
         sc->ref_unit = ref_unit;
         sc->offset = offset;
+        sc->stable_tol = (uint32_t)abs(ref_unit);
+        sc->_seq = 0;
+        sc->_timing._follow = false;
+
+        scale_reset_timing(sc);
+
+#if SCALE_PERF_ENABLED
+        scale_perf_reset(&sc->_perf);
+#endif
+
+        kalman_init(&sc->_kalman, KALMAN_DEFAULT_R, KALMAN_DEFAULT_Q);
+
+}
+
+kalman_t* scale_get_kalman(
+    scale_t* const sc) {
+        assert(sc != NULL);
+        return &sc->_kalman;
+}
+
+int64_t scale_mass_to_counts(
+    const scale_t* const sc,
+    const mass_t* const m) {
+
+        assert(sc != NULL);
+        assert(m != NULL);
+
+        double val;
+        mass_convert(&m->ug, &val, mass_ug, sc->unit);
+
+        return (int64_t)llround(val * fabs((double)sc->ref_unit));
 
 }
 
@@ -76,19 +136,29 @@ bool scale_normalise(
 bool scale_get_values_samples(
     scale_t* const sc,
     int32_t* const arr,
+    const size_t len) {
+        return scale_get_values_samples_ts(sc, arr, NULL, len);
+}
+
+bool scale_get_values_samples_ts(
+    scale_t* const sc,
+    int32_t* const arr,
+    uint32_t* const ts,
     const size_t len) {
 
         assert(sc != NULL);
         assert(sc->_adaptor != NULL);
         assert(arr != NULL);
 
-        for(size_t i = 0; i < len; ++i) {
-            if(!sc->_adaptor->get_value(sc->_adaptor, &(arr[i]))) {
-                return false;
-            }
-        }
+        const uint period = scale__window_begin(sc);
 
-        return true;
+        return scale__dynamic__get_values_samples(
+            sc,
+            sc->_adaptor,
+            arr,
+            ts,
+            len,
+            period);
 
 }
 
@@ -97,6 +167,16 @@ bool scale_get_values_timeout(
     int32_t* const arr,
     const size_t arrlen,
     size_t* const len,
+    const uint timeout) {
+        return scale_get_values_timeout_ts(sc, arr, NULL, arrlen, len, timeout);
+}
+
+bool scale_get_values_timeout_ts(
+    scale_t* const sc,
+    int32_t* const arr,
+    uint32_t* const ts,
+    const size_t arrlen,
+    size_t* const len,
     const uint timeout) {
 
         assert(sc != NULL);
@@ -107,102 +187,669 @@ bool scale_get_values_timeout(
 
         //the absolute end time for seeking values (now + timeout)
         const absolute_time_t end = make_timeout_time_us(timeout);
-        int32_t val; //temporary value from the adaptor
-        int64_t diff; //difference in us from current time to end; updated
+        const uint period = scale__window_begin(sc);
+
+        return scale__dynamic__get_values_timeout(
+            sc,
+            sc->_adaptor,
+            arr,
+            ts,
+            arrlen,
+            len,
+            end,
+            period);
 
-        //reset len to 0
-        *len = 0;
+}
 
-        for(;;) {
+bool scale__get_values_aligned(
+    scale_t* const sc,
+    int32_t* const arr,
+    uint32_t* const ts,
+    const size_t arrlen,
+    size_t* const len,
+    const uint timeout) {
 
-            if(*len >= arrlen) {
-                //no more room left
-                break;
-            }
+        assert(sc != NULL);
+        assert(sc->_adaptor != NULL);
+        assert(arr != NULL);
+        assert(arrlen > 0);
+        assert(len != NULL);
 
-            //update the time diff between now and the end
-            diff = absolute_time_diff_us(get_absolute_time(), end);
+        const uint period = scale__window_begin(sc);
 
-            if(diff <= 0) {
-                //timeout reached
-                break;
-            }
+        return scale__dynamic__get_values_aligned(
+            sc,
+            sc->_adaptor,
+            arr,
+            ts,
+            arrlen,
+            len,
+            timeout,
+            period);
+
+}
+
+void scale_get_timing(
+    const scale_t* const sc,
+    scale_timing_t* const timing) {
+
+        assert(sc != NULL);
+        assert(timing != NULL);
+
+        *timing = sc->_timing;
+
+}
+
+void scale_reset_timing(
+    scale_t* const sc) {
+
+        assert(sc != NULL);
+
+        sc->_timing.samples = 0;
+        sc->_timing.missed = 0;
+        sc->_timing.period = 0;
+        sc->_timing.jitter = 0;
+        sc->_timing._timed = false;
+
+}
+
+void scale__timing_begin(
+    scale_t* const sc) {
+
+        assert(sc != NULL);
+
+        //a window following on from the last already has its start
+        if(sc->_timing._follow) {
+            sc->_timing._follow = false;
+            return;
+        }
+
+        //time between separate reads is not time between samples
+        sc->_timing._timed = false;
+        sc->_timing._start = time_us_32();
+
+}
+
+void scale__timing_follow(
+    scale_t* const sc,
+    const size_t len) {
+
+        assert(sc != NULL);
+
+        //the next window starts where this one of len values ended,
+        //not when it is begun, so values captured while this one was
+        //being processed are kept. A window which took values ended
+        //with the last, and any captured since are still waiting
+        sc->_timing._start = len > 0
+            ? sc->_timing._last
+            : time_us_32();
+
+        sc->_timing._follow = true;
+
+}
+
+bool scale__timing_is_stale(
+    const scale_t* const sc,
+    const uint32_t captured) {
+
+        assert(sc != NULL);
+
+        //a value captured before the window began was left over from
+        //an earlier one (eg. buffered by an adaptor while nothing was
+        //reading) and does not belong in it
+        return (int32_t)(captured - sc->_timing._start) < 0;
+
+}
+
+void scale__timing_record(
+    scale_t* const sc,
+    const uint32_t now,
+    const uint period) {
+
+        assert(sc != NULL);
+
+        scale_timing_t* const t = &sc->_timing;
 
-            if(sc->_adaptor->get_value_timeout(sc->_adaptor, &val, (uint)diff)) {
+        ++t->samples;
 
-                //new value available, so increase the counter
-                //this is the actual number of values obtained
-                ++(*len);
+        if(t->_timed) {
 
-                //store the value in the array
-                arr[(*len) - 1] = val;
+            const uint32_t delta = now - t->_last;
 
+            //the adaptor knows when values should arrive; without it,
+            //fall back to what has been measured so far. Values served
+            //faster than the period (eg. from a simulator) are never
+            //counted as missed
+            const double expected = period > 0 ? (double)period : t->period;
+
+            if(expected > 0 && delta > expected * 1.5) {
+                //count the samples that should have arrived in the gap
+                t->missed += (uint32_t)lround(delta / expected) - 1;
+            }
+            else if(t->period > 0) {
+                t->jitter += (fabs(delta - t->period) - t->jitter) / SCALE_TIMING_WEIGHT;
+                t->period += (delta - t->period) / SCALE_TIMING_WEIGHT;
             }
             else {
-                /* the last get_value_timeout call might fail because there is little time
-                   left until the timeout is reached, so fail only if no values were read at all. */
-                break;
+                t->period = delta;
             }
 
         }
 
-        return *len > 0;
+        t->_last = now;
+        t->_timed = true;
 
 }
 
 bool scale_read(
     scale_t* const sc,
     double* const val,
+    const scale_options_t* const opt) {
+        return scale_read_stats(sc, val, NULL, opt);
+}
+
+bool scale_read_stats(
+    scale_t* const sc,
+    double* const val,
+    util_stats_t* const stats,
     const scale_options_t* const opt) {
 
         assert(sc != NULL);
         assert(val != NULL);
         assert(opt != NULL);
 
+        //streamed reads do not hold the whole window in the buffer,
+        //so there is nothing to calculate statistics from
+        if(opt->read == read_type_quantile) {
+            if(stats != NULL) {
+                stats->len = 0;
+            }
+
+            //values are reduced as they arrive, so it is all acquisition
+            SCALE_PERF_COUNT(&sc->_perf, reads);
+            SCALE_PERF_BEGIN(start);
+            const bool ok = scale__read_quantile(sc, val, opt);
+            SCALE_PERF_END(&sc->_perf, scale_perf_stage_acquire, start);
+
+            if(!ok) {
+                SCALE_PERF_COUNT(&sc->_perf, timeouts);
+            }
+
+            return ok;
+        }
+
         size_t len;
-        bool ok = false; //assume error
+
+        //exit early if fail
+        if(!scale_acquire(sc, opt, &len)) {
+            return false;
+        }
+
+        return scale_reduce(sc, val, stats, opt, len);
+
+}
+
+bool scale_acquire(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    size_t* const len) {
+
+        assert(sc != NULL);
+        assert(sc->_adaptor != NULL);
+        assert(opt != NULL);
+        assert(len != NULL);
+
+        return scale__dynamic__acquire(sc, sc->_adaptor, opt, len);
+
+}
+
+bool scale_reduce(
+    scale_t* const sc,
+    double* const val,
+    util_stats_t* const stats,
+    const scale_options_t* const opt,
+    const size_t len) {
+
+        assert(sc != NULL);
+
+        SCALE_PERF_BEGIN(start);
+        const bool ok = scale__reduce(sc, val, stats, opt, len);
+        SCALE_PERF_END(&sc->_perf, scale_perf_stage_reduce, start);
+
+        return ok;
+
+}
+
+bool scale__reduce(
+    scale_t* const sc,
+    double* const val,
+    util_stats_t* const stats,
+    const scale_options_t* const opt,
+    size_t len) {
+
+        assert(sc != NULL);
+        assert(val != NULL);
+        assert(opt != NULL);
+        assert(opt->buffer != NULL);
+
+        if(len == 0) {
+            return false;
+        }
+
+        //remove mains interference before the values are reduced
+        if(opt->notch != NULL) {
+            len = filter_notch_apply(opt->notch, opt->buffer, len);
+        }
+
+        if(stats != NULL) {
+
+            util_stats(opt->buffer, len, stats);
+
+            //the statistics already include the mean and median
+            if(opt->read == read_type_average) {
+                *val = stats->mean;
+                return true;
+            }
+
+            if(opt->read == read_type_median) {
+                *val = stats->median;
+                return true;
+            }
+
+        }
+
+        switch(opt->read) {
+            case read_type_average:
+                util_average(opt->buffer, len, val);
+                break;
+
+            case read_type_kalman:
+                kalman_update_all(&sc->_kalman, opt->buffer, len, val);
+                break;
+
+            case read_type_trimmed_mean:
+                util_trimmed_mean(opt->buffer, len, opt->trim, val);
+                break;
+
+            case read_type_mad_mean:
+                util_mad_mean(opt->buffer, len, opt->mad_k, val);
+                break;
+
+            case read_type_median:
+            default:
+                util_median(opt->buffer, len, val);
+                break;
+        }
+
+        return true;
+
+}
+
+bool scale__read_quantile(
+    scale_t* const sc,
+    double* const val,
+    const scale_options_t* const opt) {
+
+        assert(sc != NULL);
+        assert(val != NULL);
+        assert(opt != NULL);
+        assert(opt->buffer != NULL);
+        assert(opt->bufflen > 0);
+
+        quantile_p2_t qe;
+        filter_notch_state_t notch;
+        size_t len;
+        size_t filtered = 0;
+
+        quantile_p2_init(&qe, opt->quantile);
+
+        //the window is filtered as one stream, so only its first
+        //FILTER_NOTCH_DELAY values are lost rather than those of
+        //every refill
+        filter_notch_state_init(&notch);
+
+        //each refill continues the same window, so the timing is not
+        //reset between them
+        const uint period = scale__window_begin(sc);
 
         switch(opt->strat) {
-            case strategy_type_time:
-                ok = scale_get_values_timeout(
-                    sc,
-                    opt->buffer,
-                    opt->bufflen,
-                    &len,
-                    opt->timeout);
+            case strategy_type_time: {
+
+                const absolute_time_t end = make_timeout_time_us(opt->timeout);
+
+                for(;;) {
+
+                    //refill the buffer with whatever arrives in the time left
+                    const bool ok = scale__dynamic__get_values_timeout(
+                        sc,
+                        sc->_adaptor,
+                        opt->buffer,
+                        NULL,
+                        opt->bufflen,
+                        &len,
+                        end,
+                        period);
+
+                    if(!ok) {
+                        break;
+                    }
+
+                    //a partly filled buffer means the window has ended
+                    const bool last = len < opt->bufflen;
+
+                    if(opt->notch != NULL) {
+                        len = filter_notch_apply_stream(opt->notch, &notch, opt->buffer, len);
+                    }
+
+                    quantile_p2_add_all(&qe, opt->buffer, len);
+                    filtered += len;
+
+                    if(last) {
+                        break;
+                    }
+
+                }
+
                 break;
 
+            }
+
             case strategy_type_samples:
             default:
-                assert(opt->bufflen >= opt->samples);
-                len = opt->samples;
-                ok = scale_get_values_samples(
-                    sc,
-                    opt->buffer,
-                    len);
+                for(size_t remaining = opt->samples; remaining > 0;) {
+
+                    len = remaining < opt->bufflen ? remaining : opt->bufflen;
+
+                    const bool ok = scale__dynamic__get_values_samples(
+                        sc,
+                        sc->_adaptor,
+                        opt->buffer,
+                        NULL,
+                        len,
+                        period);
+
+                    if(!ok) {
+                        return false;
+                    }
+
+                    remaining -= len;
+
+                    if(opt->notch != NULL) {
+                        len = filter_notch_apply_stream(opt->notch, &notch, opt->buffer, len);
+                    }
+
+                    quantile_p2_add_all(&qe, opt->buffer, len);
+                    filtered += len;
+
+                }
                 break;
         }
 
-        //exit early if fail
-        if(!ok) {
+        //as with filter_notch_apply, a window too short to be
+        //filtered is used as it is
+        if(filtered == 0 && notch._primed > 1) {
+            quantile_p2_add(&qe, notch._x2);
+        }
+
+        if(filtered == 0 && notch._primed > 0) {
+            quantile_p2_add(&qe, notch._x1);
+        }
+
+        //fails if no values were obtained
+        return quantile_p2_get(&qe, val);
+
+}
+
+bool scale_plan_init(
+    scale_plan_t* const plan,
+    const scale_options_t* const opt) {
+
+        assert(plan != NULL);
+        assert(opt != NULL);
+
+        scale_plan_acquire_t acquire;
+        scale_plan_reduce_t reduce;
+
+        if(opt->buffer == NULL || opt->bufflen == 0) {
             return false;
         }
 
+        switch(opt->strat) {
+            case strategy_type_samples:
+                //streamed reads refill the buffer as often as needed
+                if(opt->samples == 0 ||
+                    (opt->read != read_type_quantile && opt->samples > opt->bufflen)) {
+                        return false;
+                }
+                acquire = scale__plan_acquire_samples;
+                break;
+
+            case strategy_type_time:
+                if(opt->timeout == 0) {
+                    return false;
+                }
+                acquire = opt->align
+                    ? scale__plan_acquire_aligned
+                    : scale__plan_acquire_time;
+                break;
+
+            default:
+                return false;
+        }
+
         switch(opt->read) {
+            case read_type_median:
+                reduce = scale__plan_reduce_median;
+                break;
+
             case read_type_average:
-                util_average(opt->buffer, len, val);
+                reduce = scale__plan_reduce_average;
                 break;
 
-            case read_type_median:
-            default:
-                util_median(opt->buffer, len, val);
+            case read_type_kalman:
+                reduce = scale__plan_reduce_kalman;
+                break;
+
+            case read_type_trimmed_mean:
+                if(!(opt->trim >= 0 && opt->trim < 0.5)) {
+                    return false;
+                }
+                reduce = scale__plan_reduce_trimmed_mean;
                 break;
+
+            case read_type_mad_mean:
+                if(!(opt->mad_k > 0)) {
+                    return false;
+                }
+                reduce = scale__plan_reduce_mad_mean;
+                break;
+
+            case read_type_quantile:
+                if(!(opt->quantile >= 0 && opt->quantile <= 1)) {
+                    return false;
+                }
+                reduce = NULL;
+                break;
+
+            default:
+                return false;
+        }
+
+        plan->opt = *opt;
+        plan->_acquire = acquire;
+        plan->_reduce = reduce;
+
+        //a filter which would not modify the values need not be applied
+        if(opt->notch != NULL && !filter_notch_is_enabled(opt->notch)) {
+            plan->opt.notch = NULL;
         }
 
         return true;
 
 }
 
+bool scale_plan_read(
+    scale_t* const sc,
+    const scale_plan_t* const plan,
+    double* const val) {
+
+        assert(sc != NULL);
+        assert(plan != NULL);
+        assert(val != NULL);
+
+        const scale_options_t* const opt = &plan->opt;
+        size_t len;
+
+        SCALE_PERF_COUNT(&sc->_perf, reads);
+        SCALE_PERF_BEGIN(acquire_start);
+
+        if(plan->_reduce == NULL) {
+
+            //values are reduced as they arrive, so it is all acquisition
+            const bool ok = scale__read_quantile(sc, val, opt);
+            SCALE_PERF_END(&sc->_perf, scale_perf_stage_acquire, acquire_start);
+
+            if(!ok) {
+                SCALE_PERF_COUNT(&sc->_perf, timeouts);
+            }
+
+            return ok;
+
+        }
+
+        if(!plan->_acquire(sc, opt, &len)) {
+
+            SCALE_PERF_END(&sc->_perf, scale_perf_stage_acquire, acquire_start);
+
+            //see scale_acquire
+            if(opt->strat == strategy_type_time) {
+                SCALE_PERF_COUNT(&sc->_perf, timeouts);
+            }
+            else {
+                SCALE_PERF_COUNT(&sc->_perf, failures);
+            }
+
+            return false;
+
+        }
+
+        SCALE_PERF_END(&sc->_perf, scale_perf_stage_acquire, acquire_start);
+        SCALE_PERF_BEGIN(reduce_start);
+
+        if(opt->notch != NULL) {
+            len = filter_notch_apply(opt->notch, opt->buffer, len);
+        }
+
+        const bool ok = plan->_reduce(sc, opt, len, val);
+
+        SCALE_PERF_END(&sc->_perf, scale_perf_stage_reduce, reduce_start);
+
+        return ok;
+
+}
+
+bool scale_plan_weight(
+    scale_t* const sc,
+    const scale_plan_t* const plan,
+    mass_t* const m) {
+
+        assert(sc != NULL);
+        assert(plan != NULL);
+        assert(m != NULL);
+
+        double raw;
+
+        if(!scale_plan_read(sc, plan, &raw)) {
+            return false;
+        }
+
+        return scale__complete(sc, &raw, m);
+
+}
+
+bool scale__plan_acquire_samples(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    size_t* const len) {
+        *len = opt->samples;
+        return scale_get_values_samples_ts(sc, opt->buffer, opt->timestamps, *len);
+}
+
+bool scale__plan_acquire_time(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    size_t* const len) {
+        return scale_get_values_timeout_ts(
+            sc,
+            opt->buffer,
+            opt->timestamps,
+            opt->bufflen,
+            len,
+            opt->timeout);
+}
+
+bool scale__plan_acquire_aligned(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    size_t* const len) {
+        return scale__get_values_aligned(
+            sc,
+            opt->buffer,
+            opt->timestamps,
+            opt->bufflen,
+            len,
+            opt->timeout);
+}
+
+bool scale__plan_reduce_median(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val) {
+        (void)sc;
+        util_median(opt->buffer, len, val);
+        return true;
+}
+
+bool scale__plan_reduce_average(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val) {
+        (void)sc;
+        util_average(opt->buffer, len, val);
+        return true;
+}
+
+bool scale__plan_reduce_kalman(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val) {
+        kalman_update_all(&sc->_kalman, opt->buffer, len, val);
+        return true;
+}
+
+bool scale__plan_reduce_trimmed_mean(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val) {
+        (void)sc;
+        util_trimmed_mean(opt->buffer, len, opt->trim, val);
+        return true;
+}
+
+bool scale__plan_reduce_mad_mean(
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const size_t len,
+    double* const val) {
+        (void)sc;
+        util_mad_mean(opt->buffer, len, opt->mad_k, val);
+        return true;
+}
+
 bool scale_zero(
     scale_t* const sc,
     const scale_options_t* const opt) {
@@ -237,20 +884,131 @@ bool scale_weight(
         assert(m != NULL);
         assert(opt != NULL);
 
-        double val;
+        double raw;
 
         //if the read fails, return false
-        if(!scale_read(sc, &val, opt)) {
+        if(!scale_read(sc, &raw, opt)) {
             return false;
         }
 
+        return scale__complete(sc, &raw, m);
+
+}
+
+bool scale__complete(
+    scale_t* const sc,
+    const double* const raw,
+    mass_t* const m) {
+
+        assert(sc != NULL);
+        assert(raw != NULL);
+        assert(m != NULL);
+
+        double val;
+
+        SCALE_PERF_BEGIN(start);
+
         //if normalising the value fails, return false
-        if(!scale_normalise(sc, &val, &val)) {
+        if(!scale_normalise(sc, raw, &val)) {
             return false;
         }
 
         mass_init(m, sc->unit, val);
 
+        SCALE_PERF_END(&sc->_perf, scale_perf_stage_convert, start);
+
+        scale_publish(sc, raw, m);
+
         return true;
 
-}
\ No newline at end of file
+}
+
+void scale_publish(
+    scale_t* const sc,
+    const double* const raw,
+    const mass_t* const m) {
+
+        assert(sc != NULL);
+        assert(raw != NULL);
+        assert(m != NULL);
+
+        const uint32_t seq = sc->_seq;
+
+        //nothing has been published yet if seq is 0
+        const bool stable = seq != 0 &&
+            fabs(*raw - sc->_latest.raw) <= sc->stable_tol;
+
+        //keep the write as short as possible; readers spin while
+        //it is in progress
+        const uint64_t now = time_us_64();
+
+        //odd sequence tells readers a write is in progress
+        sc->_seq = seq + 1;
+        __dmb();
+
+        sc->_latest.mass = *m;
+        sc->_latest.raw = *raw;
+        sc->_latest.time = now;
+        sc->_latest.stable = stable;
+
+        __dmb();
+
+        //0 is reserved for nothing published, so skip it on wrap
+        sc->_seq = seq + 2 != 0 ? seq + 2 : 2;
+
+}
+
+bool scale_get_latest(
+    const scale_t* const sc,
+    scale_reading_t* const r) {
+
+        assert(sc != NULL);
+        assert(r != NULL);
+
+        uint32_t start = 0;
+        bool timed = false;
+
+        /**
+         * Spin until a copy is made while no write is in progress. The
+         * publisher may be on the other core, in which case it finishes
+         * quickly, so the wait is bounded by time rather than attempts.
+         * The clock is only read once the first attempt has failed.
+         */
+        for(;;) {
+
+            const uint32_t seq = sc->_seq;
+
+            //an odd sequence means a write is in progress
+            if(!(seq & 1)) {
+
+                __dmb();
+                *r = sc->_latest;
+                __dmb();
+
+                //if the sequence is unchanged, nothing was written
+                //while the reading was being copied
+                if(sc->_seq == seq) {
+                    return seq != 0;
+                }
+
+            }
+
+            if(!timed) {
+                start = time_us_32();
+                timed = true;
+            }
+            else if(time_us_32() - start >= SCALE_LATEST_TIMEOUT) {
+                return false;
+            }
+
+        }
+
+}
+
+#if SCALE_PERF_ENABLED
+scale_perf_t* scale_get_perf(
+    scale_t* const sc) {
+        assert(sc != NULL);
+        return &sc->_perf;
+}
+#endif
@@ -29,6 +29,9 @@ bool scale_adaptor_init(
     void* data) {
         assert(sa != NULL);
         sa->_data = data;
+        sa->get_value_noblock = NULL;
+        sa->get_period = NULL;
+        sa->get_time = NULL;
         return true;
 }
 
@@ -37,3 +40,48 @@ void* scale_adaptor_get_data(
         assert(sa != NULL);
         return sa->_data;
 }
+
+bool scale_adaptor_get_value_noblock(
+    scale_adaptor_t* const sa,
+    int32_t* const value) {
+
+        assert(sa != NULL);
+        assert(value != NULL);
+
+        if(sa->get_value_noblock != NULL) {
+            return sa->get_value_noblock(sa, value);
+        }
+
+        return sa->get_value_timeout(sa, value, 0);
+
+}
+
+bool scale_adaptor_get_period(
+    scale_adaptor_t* const sa,
+    uint* const period) {
+
+        assert(sa != NULL);
+        assert(period != NULL);
+
+        uint nominal = 0;
+        uint measured = 0;
+
+        if(sa->get_period == NULL || !sa->get_period(sa, &nominal, &measured)) {
+            return false;
+        }
+
+        *period = measured > 0 ? measured : nominal;
+        return *period > 0;
+
+}
+
+bool scale_adaptor_get_time(
+    scale_adaptor_t* const sa,
+    uint32_t* const time) {
+
+        assert(sa != NULL);
+        assert(time != NULL);
+
+        return sa->get_time != NULL && sa->get_time(sa, time);
+
+}
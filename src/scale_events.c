@@ -0,0 +1,289 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/mass.h"
+#include "../include/scale.h"
+#include "../include/scale_events.h"
+
+void scale_events_init(
+    scale_events_t* const evs,
+    scale_t* const sc) {
+
+        assert(evs != NULL);
+        assert(sc != NULL);
+
+        evs->_sc = sc;
+        evs->_count = 0;
+
+}
+
+bool scale_events_subscribe_threshold(
+    scale_events_t* const evs,
+    const mass_t* const level,
+    const mass_t* const hysteresis,
+    const uint debounce,
+    const scale_event_callback_t callback,
+    void* const data) {
+
+        assert(evs != NULL);
+        assert(level != NULL);
+        assert(hysteresis != NULL);
+
+        scale_subscription_t* const sub = scale_events__add(
+            evs,
+            scale_subscription_threshold,
+            debounce,
+            callback,
+            data);
+
+        if(sub == NULL) {
+            return false;
+        }
+
+        sub->_lo = scale_mass_to_counts(evs->_sc, level);
+        sub->_hyst = scale_mass_to_counts(evs->_sc, hysteresis);
+
+        return true;
+
+}
+
+bool scale_events_subscribe_band(
+    scale_events_t* const evs,
+    const mass_t* const lo,
+    const mass_t* const hi,
+    const mass_t* const hysteresis,
+    const uint debounce,
+    const scale_event_callback_t callback,
+    void* const data) {
+
+        assert(evs != NULL);
+        assert(lo != NULL);
+        assert(hi != NULL);
+        assert(hysteresis != NULL);
+        assert(mass_lteq(lo, hi));
+
+        scale_subscription_t* const sub = scale_events__add(
+            evs,
+            scale_subscription_band,
+            debounce,
+            callback,
+            data);
+
+        if(sub == NULL) {
+            return false;
+        }
+
+        sub->_lo = scale_mass_to_counts(evs->_sc, lo);
+        sub->_hi = scale_mass_to_counts(evs->_sc, hi);
+        sub->_hyst = scale_mass_to_counts(evs->_sc, hysteresis);
+
+        return true;
+
+}
+
+bool scale_events_subscribe_delta(
+    scale_events_t* const evs,
+    const mass_t* const delta,
+    const uint debounce,
+    const scale_event_callback_t callback,
+    void* const data) {
+
+        assert(evs != NULL);
+        assert(delta != NULL);
+
+        scale_subscription_t* const sub = scale_events__add(
+            evs,
+            scale_subscription_delta,
+            debounce,
+            callback,
+            data);
+
+        if(sub == NULL) {
+            return false;
+        }
+
+        sub->_lo = scale_mass_to_counts(evs->_sc, delta);
+
+        return true;
+
+}
+
+void scale_events_feed(
+    scale_events_t* const evs,
+    const int32_t raw) {
+
+        assert(evs != NULL);
+
+        const int64_t n = scale_raw_to_counts(evs->_sc, raw);
+
+        for(size_t i = 0; i < evs->_count; ++i) {
+
+            scale_subscription_t* const sub = &evs->_subs[i];
+
+            if(!sub->_primed) {
+                //the first sample sets the state without an event
+                sub->_state = sub->_type == scale_subscription_band
+                    ? (n >= sub->_lo && n <= sub->_hi)
+                    : n >= sub->_lo;
+                sub->_ref = n;
+                sub->_primed = true;
+                continue;
+            }
+
+            switch(sub->_type) {
+                case scale_subscription_threshold: {
+                    const bool changing = sub->_state
+                        ? n < sub->_lo - sub->_hyst
+                        : n >= sub->_lo;
+                    if(scale_events__debounce(sub, changing)) {
+                        sub->_state = !sub->_state;
+                        scale_events__raise(
+                            evs,
+                            sub,
+                            sub->_state ? scale_event_rise : scale_event_fall,
+                            raw);
+                    }
+                    break;
+                }
+
+                case scale_subscription_band: {
+                    const bool changing = sub->_state
+                        ? (n < sub->_lo - sub->_hyst || n > sub->_hi + sub->_hyst)
+                        : (n >= sub->_lo && n <= sub->_hi);
+                    if(scale_events__debounce(sub, changing)) {
+                        sub->_state = !sub->_state;
+                        scale_events__raise(
+                            evs,
+                            sub,
+                            sub->_state ? scale_event_enter : scale_event_exit,
+                            raw);
+                    }
+                    break;
+                }
+
+                case scale_subscription_delta:
+                default: {
+                    const int64_t d = n - sub->_ref;
+                    const bool changing = d >= sub->_lo || -d >= sub->_lo;
+                    if(scale_events__debounce(sub, changing)) {
+                        sub->_ref = n;
+                        scale_events__raise(evs, sub, scale_event_delta, raw);
+                    }
+                    break;
+                }
+            }
+
+        }
+
+}
+
+void scale_events_feed_all(
+    scale_events_t* const evs,
+    const int32_t* const arr,
+    const size_t len) {
+
+        assert(evs != NULL);
+        assert(arr != NULL);
+
+        for(size_t i = 0; i < len; ++i) {
+            scale_events_feed(evs, arr[i]);
+        }
+
+}
+
+scale_subscription_t* scale_events__add(
+    scale_events_t* const evs,
+    const scale_subscription_type_t type,
+    const uint debounce,
+    const scale_event_callback_t callback,
+    void* const data) {
+
+        assert(evs != NULL);
+        assert(callback != NULL);
+
+        if(evs->_count >= SCALE_EVENTS_MAX_SUBS) {
+            return NULL;
+        }
+
+        scale_subscription_t* const sub = &evs->_subs[evs->_count++];
+
+        sub->_type = type;
+        sub->_callback = callback;
+        sub->_data = data;
+        sub->_lo = 0;
+        sub->_hi = 0;
+        sub->_hyst = 0;
+        sub->_debounce = debounce;
+        sub->_pending = 0;
+        sub->_ref = 0;
+        sub->_state = false;
+        sub->_primed = false;
+
+        return sub;
+
+}
+
+bool scale_events__debounce(
+    scale_subscription_t* const sub,
+    const bool changing) {
+
+        assert(sub != NULL);
+
+        if(!changing) {
+            sub->_pending = 0;
+            return false;
+        }
+
+        //a debounce of 0 or 1 changes state on the first sample
+        if(++sub->_pending < sub->_debounce) {
+            return false;
+        }
+
+        sub->_pending = 0;
+        return true;
+
+}
+
+void scale_events__raise(
+    const scale_events_t* const evs,
+    const scale_subscription_t* const sub,
+    const scale_event_type_t ev,
+    const int32_t raw) {
+
+        assert(evs != NULL);
+        assert(sub != NULL);
+
+        //only convert to a mass_t when there is an event to report
+        const double r = raw;
+        double val = 0;
+        mass_t m;
+
+        scale_normalise(evs->_sc, &r, &val);
+        mass_init(&m, evs->_sc->unit, val);
+
+        sub->_callback(ev, &m, sub->_data);
+
+}
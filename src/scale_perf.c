@@ -0,0 +1,95 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../include/scale_perf.h"
+
+static const char* const scale_perf__stage_names[scale_perf_stage_count] = {
+    "acquire",
+    "reduce",
+    "convert"
+};
+
+void scale_perf_reset(
+    scale_perf_t* const perf) {
+
+        assert(perf != NULL);
+
+        memset(perf, 0, sizeof(scale_perf_t));
+
+}
+
+void scale_perf_record(
+    scale_perf_t* const perf,
+    const scale_perf_stage_t stage,
+    const uint32_t ticks) {
+
+        assert(perf != NULL);
+        assert(stage < scale_perf_stage_count);
+
+        ++perf->hist[stage][scale_perf_bucket(ticks)];
+
+        if(ticks > perf->max[stage]) {
+            perf->max[stage] = ticks;
+        }
+
+}
+
+void scale_perf_dump(
+    const scale_perf_t* const perf) {
+
+        assert(perf != NULL);
+
+        printf("reads %lu, timeouts %lu, failures %lu\n",
+            (unsigned long)perf->reads,
+            (unsigned long)perf->timeouts,
+            (unsigned long)perf->failures);
+
+        for(uint s = 0; s < scale_perf_stage_count; ++s) {
+
+            printf("%s: max %lu\n",
+                scale_perf__stage_names[s],
+                (unsigned long)perf->max[s]);
+
+            for(uint b = 0; b < SCALE_PERF_BUCKETS; ++b) {
+
+                if(perf->hist[s][b] == 0) {
+                    continue;
+                }
+
+                //the range of durations in the bucket
+                const unsigned long lo = b == 0 ? 0 : 1ul << (b - 1);
+                const unsigned long hi = b == 0 ? 0 : (b == 32 ? 0xfffffffful : (1ul << b) - 1);
+
+                printf("  [%lu, %lu] %lu\n",
+                    lo,
+                    hi,
+                    (unsigned long)perf->hist[s][b]);
+
+            }
+
+        }
+
+}
@@ -0,0 +1,313 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "pico/time.h"
+#include "../include/scale.h"
+#include "../include/scale_internal.h"
+#include "../include/scale_perf.h"
+#include "../include/scale_pipeline.h"
+
+/**
+ * Core 1's entry point takes no arguments, so the pipeline it
+ * runs is passed through here
+ */
+static scale_pipeline_t* volatile scale_pipeline__core1_pipeline = NULL;
+
+void scale_pipeline_init(
+    scale_pipeline_t* const pl,
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    int32_t* const buff0,
+    int32_t* const buff1,
+    const size_t bufflen) {
+
+        assert(pl != NULL);
+        assert(sc != NULL);
+        assert(opt != NULL);
+        assert(opt->read != read_type_quantile);
+        assert(buff0 != NULL);
+        assert(buff1 != NULL);
+        assert(bufflen > 0);
+
+        int32_t* const buffs[SCALE_PIPELINE_BUFFS] = { buff0, buff1 };
+
+        pl->_sc = sc;
+
+        for(uint i = 0; i < SCALE_PIPELINE_BUFFS; ++i) {
+            pl->_opts[i] = *opt;
+            pl->_opts[i].buffer = buffs[i];
+            pl->_opts[i].bufflen = bufflen;
+            pl->_lens[i] = 0;
+            pl->_oks[i] = false;
+            pl->_seqs[i] = 0;
+            pl->_states[i] = scale_pipeline_buff_free;
+        }
+
+        pl->_seq = 0;
+        pl->_lock = spin_lock_instance((uint)spin_lock_claim_unused(true));
+        pl->_running = false;
+        pl->_stopped = true;
+
+}
+
+void scale_pipeline_start(
+    scale_pipeline_t* const pl) {
+
+        assert(pl != NULL);
+        assert(scale_pipeline__core1_pipeline == NULL);
+
+        //core 1 acquires through its own copy, so core 0 can go on
+        //reading the scale's timing and counters
+        pl->_acq = *pl->_sc;
+
+        for(uint i = 0; i < SCALE_PIPELINE_BUFFS; ++i) {
+            pl->_states[i] = scale_pipeline_buff_free;
+        }
+
+        pl->_running = true;
+        pl->_stopped = false;
+        scale_pipeline__core1_pipeline = pl;
+
+        multicore_launch_core1(scale_pipeline__core1_entry);
+
+}
+
+void scale_pipeline_stop(
+    scale_pipeline_t* const pl) {
+
+        assert(pl != NULL);
+
+        const scale_options_t* const opt = &pl->_opts[0];
+        const uint window = opt->strat == strategy_type_time
+            ? opt->timeout
+            : 0;
+
+        const absolute_time_t end = make_timeout_time_us(
+            (uint64_t)window + SCALE_PIPELINE_STOP_TIMEOUT);
+
+        pl->_running = false;
+        __sev();
+
+        //core 1 may be blocked on an adaptor which has stopped
+        //providing values, so do not wait for it forever
+        while(!pl->_stopped) {
+            if(best_effort_wfe_or_timeout(end)) {
+                break;
+            }
+        }
+
+        multicore_reset_core1();
+        pl->_stopped = true;
+        scale_pipeline__core1_pipeline = NULL;
+
+}
+
+bool scale_pipeline_read(
+    scale_pipeline_t* const pl,
+    double* const val,
+    util_stats_t* const stats) {
+
+        assert(pl != NULL);
+        assert(val != NULL);
+
+        uint i = SCALE_PIPELINE_BUFFS;
+
+        //wait for core 1 to complete a window, and take the newest
+        for(;;) {
+
+            const uint32_t save = spin_lock_blocking(pl->_lock);
+
+            for(uint j = 0; j < SCALE_PIPELINE_BUFFS; ++j) {
+                if(pl->_states[j] == scale_pipeline_buff_ready &&
+                    (i == SCALE_PIPELINE_BUFFS || (int32_t)(pl->_seqs[j] - pl->_seqs[i]) > 0)) {
+                        i = j;
+                }
+            }
+
+            if(i < SCALE_PIPELINE_BUFFS) {
+                pl->_states[i] = scale_pipeline_buff_reading;
+            }
+
+            spin_unlock(pl->_lock, save);
+
+            if(i < SCALE_PIPELINE_BUFFS) {
+                break;
+            }
+
+            if(pl->_stopped) {
+                return false;
+            }
+
+            __wfe();
+
+        }
+
+        //core 1 finished with the buffer before handing it over
+        __dmb();
+
+        pl->_sc->_timing = pl->_timings[i];
+
+        //only core 1's windows follow on from each other; a read on
+        //core 0 still begins afresh
+        pl->_sc->_timing._follow = false;
+
+#if SCALE_PERF_ENABLED
+        //core 0 keeps its own reduce and convert figures
+        scale_perf_t* const perf = &pl->_sc->_perf;
+        const scale_perf_t* const acq = &pl->_perfs[i];
+
+        perf->reads = acq->reads;
+        perf->timeouts = acq->timeouts;
+        perf->failures = acq->failures;
+        perf->max[scale_perf_stage_acquire] = acq->max[scale_perf_stage_acquire];
+
+        memcpy(
+            perf->hist[scale_perf_stage_acquire],
+            acq->hist[scale_perf_stage_acquire],
+            sizeof(perf->hist[scale_perf_stage_acquire]));
+#endif
+
+        const bool ok = pl->_oks[i] && scale_reduce(
+            pl->_sc,
+            val,
+            stats,
+            &pl->_opts[i],
+            pl->_lens[i]);
+
+        //hand the buffer back to core 1
+        const uint32_t save = spin_lock_blocking(pl->_lock);
+        pl->_states[i] = scale_pipeline_buff_free;
+        spin_unlock(pl->_lock, save);
+
+        return ok;
+
+}
+
+bool scale_pipeline_weight(
+    scale_pipeline_t* const pl,
+    mass_t* const m) {
+
+        assert(pl != NULL);
+        assert(m != NULL);
+
+        double raw;
+
+        if(!scale_pipeline_read(pl, &raw, NULL)) {
+            return false;
+        }
+
+        return scale__complete(pl->_sc, &raw, m);
+
+}
+
+/**
+ * @brief Claims a buffer for core 1 to fill: a free one if there is one,
+ * otherwise the one holding the older window, which is overwritten
+ * rather than waiting for core 0 to read it
+ * 
+ * @param pl 
+ * @return uint 
+ */
+static uint scale_pipeline__claim_fill(
+    scale_pipeline_t* const pl) {
+
+        uint i = SCALE_PIPELINE_BUFFS;
+
+        const uint32_t save = spin_lock_blocking(pl->_lock);
+
+        for(uint j = 0; j < SCALE_PIPELINE_BUFFS; ++j) {
+
+            if(pl->_states[j] == scale_pipeline_buff_free) {
+                i = j;
+                break;
+            }
+
+            if(pl->_states[j] == scale_pipeline_buff_ready &&
+                (i == SCALE_PIPELINE_BUFFS || (int32_t)(pl->_seqs[j] - pl->_seqs[i]) < 0)) {
+                    i = j;
+            }
+
+        }
+
+        //core 0 only ever reads one buffer at a time
+        assert(i < SCALE_PIPELINE_BUFFS);
+
+        pl->_states[i] = scale_pipeline_buff_filling;
+
+        spin_unlock(pl->_lock, save);
+
+        return i;
+
+}
+
+void scale_pipeline__core1_entry(void) {
+
+    scale_pipeline_t* const pl = scale_pipeline__core1_pipeline;
+
+    assert(pl != NULL);
+
+    //core 1 runs from flash, so it must be paused while core 0
+    //writes to flash (eg. with a pico_flash_adaptor_t)
+    multicore_lockout_victim_init();
+
+    while(pl->_running) {
+
+        const uint i = scale_pipeline__claim_fill(pl);
+
+        size_t len = 0;
+        const bool ok = scale_acquire(&pl->_acq, &pl->_opts[i], &len);
+
+        //the next window follows straight on, so nothing captured while
+        //this one is handed over is discarded
+        scale__timing_follow(&pl->_acq, ok ? len : 0);
+
+        pl->_lens[i] = len;
+        pl->_oks[i] = ok;
+        pl->_timings[i] = pl->_acq._timing;
+
+#if SCALE_PERF_ENABLED
+        pl->_perfs[i] = pl->_acq._perf;
+#endif
+
+        //make sure the window is visible before handing it over
+        __dmb();
+
+        const uint32_t save = spin_lock_blocking(pl->_lock);
+        pl->_seqs[i] = ++pl->_seq;
+        pl->_states[i] = scale_pipeline_buff_ready;
+        spin_unlock(pl->_lock, save);
+
+        __sev();
+
+    }
+
+    pl->_stopped = true;
+    __sev();
+
+}
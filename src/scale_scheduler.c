@@ -0,0 +1,211 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "../include/scale.h"
+#include "../include/scale_adaptor.h"
+#include "../include/scale_events.h"
+#include "../include/scale_internal.h"
+#include "../include/scale_scheduler.h"
+
+void scale_scheduler_init(
+    scale_scheduler_t* const ss) {
+
+        assert(ss != NULL);
+
+        ss->_count = 0;
+        ss->_next = 0;
+
+}
+
+bool scale_scheduler_add(
+    scale_scheduler_t* const ss,
+    scale_t* const sc,
+    const scale_options_t* const opt,
+    const scale_scheduler_callback_t callback,
+    void* const data,
+    size_t* const index) {
+
+        assert(ss != NULL);
+        assert(sc != NULL);
+        assert(sc->_adaptor != NULL);
+        assert(opt != NULL);
+        assert(opt->read != read_type_quantile);
+        assert(opt->buffer != NULL);
+        assert(opt->bufflen > 0);
+        assert(callback != NULL);
+
+        if(ss->_count >= SCALE_SCHEDULER_MAX_SCALES) {
+            return false;
+        }
+
+        //a window the buffer cannot hold would never be full
+        if(opt->strat == strategy_type_samples &&
+            (opt->samples == 0 || opt->samples > opt->bufflen)) {
+                return false;
+        }
+
+        scale_scheduler_entry_t* const e = &ss->_entries[ss->_count];
+
+        e->_sc = sc;
+        e->_opt = opt;
+        e->_callback = callback;
+        e->_data = data;
+        e->_events = NULL;
+
+        scale_scheduler__begin(e);
+
+        if(index != NULL) {
+            *index = ss->_count;
+        }
+
+        ++ss->_count;
+
+        return true;
+
+}
+
+void scale_scheduler_set_events(
+    scale_scheduler_t* const ss,
+    const size_t index,
+    scale_events_t* const evs) {
+
+        assert(ss != NULL);
+        assert(index < ss->_count);
+
+        ss->_entries[index]._events = evs;
+
+}
+
+size_t scale_scheduler_poll(
+    scale_scheduler_t* const ss) {
+
+        assert(ss != NULL);
+
+        size_t completed = 0;
+
+        //rotate the starting scale so none is always serviced last
+        for(size_t n = 0; n < ss->_count; ++n) {
+            const size_t i = (ss->_next + n) % ss->_count;
+            if(scale_scheduler__service(&ss->_entries[i], i)) {
+                ++completed;
+            }
+        }
+
+        if(ss->_count > 0) {
+            ss->_next = (ss->_next + 1) % ss->_count;
+        }
+
+        return completed;
+
+}
+
+void scale_scheduler__begin(
+    scale_scheduler_entry_t* const e) {
+
+        assert(e != NULL);
+
+        e->_len = 0;
+        e->_end = make_timeout_time_us(e->_opt->timeout);
+
+        scale__timing_begin(e->_sc);
+
+}
+
+bool scale_scheduler__service(
+    scale_scheduler_entry_t* const e,
+    const size_t index) {
+
+        assert(e != NULL);
+
+        const scale_options_t* const opt = e->_opt;
+
+        //a strategy_type_samples window is full at opt->samples
+        const size_t want = opt->strat == strategy_type_time
+            ? opt->bufflen
+            : opt->samples;
+
+        uint period = 0;
+
+        scale_adaptor_get_period(e->_sc->_adaptor, &period);
+
+        //take everything the adaptor already has
+        while(e->_len < want &&
+            scale_adaptor_get_value_noblock(e->_sc->_adaptor, &opt->buffer[e->_len])) {
+
+                //when the adaptor cannot say when the value was captured,
+                //use when it was seen, which is only as precise as the
+                //polling rate
+                uint32_t now;
+
+                if(!scale_adaptor_get_time(e->_sc->_adaptor, &now)) {
+                    now = time_us_32();
+                }
+
+                if(scale__timing_is_stale(e->_sc, now)) {
+                    continue;
+                }
+
+                if(opt->timestamps != NULL) {
+                    opt->timestamps[e->_len] = now;
+                }
+
+                scale__timing_record(e->_sc, now, period);
+
+                if(e->_events != NULL) {
+                    scale_events_feed(e->_events, opt->buffer[e->_len]);
+                }
+
+                ++e->_len;
+
+        }
+
+        const bool full = e->_len >= want;
+        const bool expired = opt->strat == strategy_type_time &&
+            time_reached(e->_end);
+
+        if(!full && !expired) {
+            return false;
+        }
+
+        double raw;
+        mass_t m = {0};
+
+        const bool ok =
+            scale_reduce(e->_sc, &raw, NULL, opt, e->_len) &&
+            scale__complete(e->_sc, &raw, &m);
+
+        //the window ends here rather than after the callback, which may
+        //take longer than a sample period
+        scale__timing_follow(e->_sc, e->_len);
+
+        e->_callback(index, e->_sc, ok, &m, e->_data);
+
+        scale_scheduler__begin(e);
+
+        return true;
+
+}
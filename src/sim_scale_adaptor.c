@@ -0,0 +1,357 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "../include/scale_adaptor.h"
+#include "../include/sim_scale_adaptor.h"
+
+static const double SIM_SCALE_ADAPTOR__PI = 3.14159265358979323846;
+static const int32_t SIM_SCALE_ADAPTOR__MAX = 0x7fffff;
+static const int32_t SIM_SCALE_ADAPTOR__MIN = -0x800000;
+
+void sim_scale_adaptor_get_default_config(
+    sim_scale_adaptor_config_t* const cfg) {
+
+        assert(cfg != NULL);
+
+        cfg->seed = 1;
+        cfg->period = 12500;
+        cfg->realtime = false;
+        cfg->offset = -367539;
+        cfg->ref_unit = 432;
+        cfg->steps = NULL;
+        cfg->steps_len = 0;
+        cfg->settle = 50000;
+        cfg->ring_hz = 0;
+        cfg->creep = 0;
+        cfg->creep_tau = 10000000;
+        cfg->drift = 0;
+        cfg->vibration = 0;
+        cfg->vibration_hz = 0;
+        cfg->mains = 0;
+        cfg->mains_hz = 50;
+        cfg->noise = 60;
+        cfg->spike_p = 0;
+        cfg->drop_p = 0;
+
+}
+
+bool sim_scale_adaptor_init(
+    sim_scale_adaptor_t* const sim,
+    const sim_scale_adaptor_config_t* const cfg) {
+
+        assert(sim != NULL);
+        assert(cfg != NULL);
+        assert(cfg->period > 0);
+        assert(cfg->steps != NULL || cfg->steps_len == 0);
+        //at 1 every value is dropped and a read never returns
+        assert(cfg->drop_p >= 0 && cfg->drop_p < 1);
+
+        sim->_cfg = *cfg;
+        sim->_state = cfg->seed;
+        sim->_time = 0;
+        sim->_spikes = 0;
+        sim->_drops = 0;
+        sim->_start = time_us_64();
+        sim->_served_time = 0;
+
+        scale_adaptor_init(&sim->_sa, sim);
+        sim->_sa.get_value = sim_scale_adaptor_get_value;
+        sim->_sa.get_value_timeout = sim_scale_adaptor_get_value_timeout;
+        sim->_sa.get_value_noblock = sim_scale_adaptor_get_value_noblock;
+        sim->_sa.get_period = sim_scale_adaptor_get_period;
+        sim->_sa.get_time = sim_scale_adaptor_get_time;
+
+        //always one value ahead, so dropped values can be skipped
+        //before anyone waits for them
+        while(!sim_scale_adaptor__next(sim, &sim->_value)) {
+        }
+
+        return true;
+
+}
+
+scale_adaptor_t* sim_scale_adaptor_get_base(
+    sim_scale_adaptor_t* const sim) {
+        assert(sim != NULL);
+        return &sim->_sa;
+}
+
+uint64_t sim_scale_adaptor_get_clock(
+    const sim_scale_adaptor_t* const sim) {
+        assert(sim != NULL);
+        return sim->_value_time;
+}
+
+double sim_scale_adaptor_get_load(
+    const sim_scale_adaptor_t* const sim,
+    const uint64_t t) {
+
+        assert(sim != NULL);
+
+        double load = 0;
+
+        for(size_t i = 0; i < sim->_cfg.steps_len && sim->_cfg.steps[i].time <= t; ++i) {
+            load = sim->_cfg.steps[i].load;
+        }
+
+        return load;
+
+}
+
+void sim_scale_adaptor_get_calibration(
+    const sim_scale_adaptor_t* const sim,
+    int32_t* const ref_unit,
+    int32_t* const offset) {
+
+        assert(sim != NULL);
+        assert(ref_unit != NULL);
+        assert(offset != NULL);
+
+        *ref_unit = (int32_t)lround(sim->_cfg.ref_unit);
+        *offset = sim->_cfg.offset;
+
+}
+
+void sim_scale_adaptor_get_faults(
+    const sim_scale_adaptor_t* const sim,
+    uint32_t* const spikes,
+    uint32_t* const drops) {
+
+        assert(sim != NULL);
+        assert(spikes != NULL);
+        assert(drops != NULL);
+
+        *spikes = sim->_spikes;
+        *drops = sim->_drops;
+
+}
+
+bool sim_scale_adaptor_get_value(
+    scale_adaptor_t* const sa,
+    int32_t* const value) {
+
+        assert(sa != NULL);
+        assert(value != NULL);
+
+        sim_scale_adaptor_t* const sim =
+            (sim_scale_adaptor_t*)scale_adaptor_get_data(sa);
+
+        if(sim->_cfg.realtime) {
+            sleep_until(from_us_since_boot(sim->_start + sim->_value_time));
+        }
+
+        *value = sim->_value;
+        sim->_served_time = sim->_value_time;
+
+        while(!sim_scale_adaptor__next(sim, &sim->_value)) {
+        }
+
+        return true;
+
+}
+
+bool sim_scale_adaptor_get_value_timeout(
+    scale_adaptor_t* const sa,
+    int32_t* const value,
+    const uint timeout) {
+
+        assert(sa != NULL);
+        assert(value != NULL);
+
+        const sim_scale_adaptor_t* const sim =
+            (const sim_scale_adaptor_t*)scale_adaptor_get_data(sa);
+
+        if(sim->_cfg.realtime) {
+
+            const uint64_t due = sim->_start + sim->_value_time;
+            const uint64_t now = time_us_64();
+
+            //the value will not arrive in time
+            if(due > now + timeout) {
+                sleep_us(timeout);
+                return false;
+            }
+
+        }
+
+        return sim_scale_adaptor_get_value(sa, value);
+
+}
+
+bool sim_scale_adaptor_get_value_noblock(
+    scale_adaptor_t* const sa,
+    int32_t* const value) {
+        return sim_scale_adaptor_get_value_timeout(sa, value, 0);
+}
+
+bool sim_scale_adaptor_get_period(
+    scale_adaptor_t* const sa,
+    uint* const nominal,
+    uint* const measured) {
+
+        assert(sa != NULL);
+        assert(nominal != NULL);
+        assert(measured != NULL);
+
+        const sim_scale_adaptor_t* const sim =
+            (const sim_scale_adaptor_t*)scale_adaptor_get_data(sa);
+
+        *nominal = sim->_cfg.period;
+        *measured = 0;
+
+        return true;
+
+}
+
+bool sim_scale_adaptor_get_time(
+    scale_adaptor_t* const sa,
+    uint32_t* const time) {
+
+        assert(sa != NULL);
+        assert(time != NULL);
+
+        const sim_scale_adaptor_t* const sim =
+            (const sim_scale_adaptor_t*)scale_adaptor_get_data(sa);
+
+        //simulated time only maps onto the host clock when values are
+        //served as they fall due
+        if(!sim->_cfg.realtime) {
+            return false;
+        }
+
+        *time = (uint32_t)(sim->_start + sim->_served_time);
+
+        return true;
+
+}
+
+double sim_scale_adaptor__model(
+    sim_scale_adaptor_t* const sim,
+    const uint64_t t) {
+
+        assert(sim != NULL);
+
+        const sim_scale_adaptor_config_t* const cfg = &sim->_cfg;
+        const double secs = t / 1e6;
+        double response = 0;
+        double prev = 0;
+
+        //each step's change in load responds on its own
+        for(size_t i = 0; i < cfg->steps_len && cfg->steps[i].time <= t; ++i) {
+
+            const double delta = cfg->steps[i].load - prev;
+            const double dt = (double)(t - cfg->steps[i].time);
+            double r = 1;
+
+            if(cfg->settle > 0) {
+                r -= exp(-dt / cfg->settle) *
+                    cos(2 * SIM_SCALE_ADAPTOR__PI * cfg->ring_hz * dt / 1e6);
+            }
+
+            if(cfg->creep_tau > 0) {
+                r += cfg->creep * (1 - exp(-dt / cfg->creep_tau));
+            }
+
+            response += delta * r;
+            prev = cfg->steps[i].load;
+
+        }
+
+        //gaussian noise by Box-Muller
+        const double u1 = sim_scale_adaptor__uniform(sim);
+        const double u2 = sim_scale_adaptor__uniform(sim);
+        const double noise = sqrt(-2 * log(1 - u1)) *
+            cos(2 * SIM_SCALE_ADAPTOR__PI * u2);
+
+        return cfg->offset +
+            (cfg->ref_unit * response) +
+            (cfg->drift * secs) +
+            (cfg->vibration * sin(2 * SIM_SCALE_ADAPTOR__PI * cfg->vibration_hz * secs)) +
+            (cfg->mains * sin(2 * SIM_SCALE_ADAPTOR__PI * cfg->mains_hz * secs)) +
+            (cfg->noise * noise);
+
+}
+
+bool sim_scale_adaptor__next(
+    sim_scale_adaptor_t* const sim,
+    int32_t* const value) {
+
+        assert(sim != NULL);
+        assert(value != NULL);
+
+        const uint64_t t = sim->_time;
+        const double raw = sim_scale_adaptor__model(sim, t);
+        const double fault = sim_scale_adaptor__uniform(sim);
+
+        sim->_time += sim->_cfg.period;
+
+        if(fault < sim->_cfg.drop_p) {
+            ++sim->_drops;
+            return false;
+        }
+
+        if(fault < sim->_cfg.drop_p + sim->_cfg.spike_p) {
+            ++sim->_spikes;
+            *value = sim_scale_adaptor__rand(sim) & 1
+                ? SIM_SCALE_ADAPTOR__MAX
+                : SIM_SCALE_ADAPTOR__MIN;
+        }
+        else if(raw >= SIM_SCALE_ADAPTOR__MAX) {
+            *value = SIM_SCALE_ADAPTOR__MAX;
+        }
+        else if(raw <= SIM_SCALE_ADAPTOR__MIN) {
+            *value = SIM_SCALE_ADAPTOR__MIN;
+        }
+        else {
+            *value = (int32_t)lround(raw);
+        }
+
+        sim->_value_time = t;
+
+        return true;
+
+}
+
+uint64_t sim_scale_adaptor__rand(
+    sim_scale_adaptor_t* const sim) {
+
+        assert(sim != NULL);
+
+        //splitmix64
+        uint64_t z = (sim->_state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+
+}
+
+double sim_scale_adaptor__uniform(
+    sim_scale_adaptor_t* const sim) {
+        //53 random bits in [0, 1)
+        return (sim_scale_adaptor__rand(sim) >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,235 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/bytes.h"
+#include "../include/cobs.h"
+#include "../include/mass.h"
+#include "../include/telemetry.h"
+
+void telemetry_init(
+    telemetry_t* const tm,
+    const telemetry_write_t write,
+    void* const data) {
+
+        assert(tm != NULL);
+        assert(write != NULL);
+
+        tm->_write = write;
+        tm->_data = data;
+        tm->_seq = 0;
+
+}
+
+bool telemetry_send_samples(
+    telemetry_t* const tm,
+    const int32_t* const values,
+    const uint32_t* const times,
+    const size_t len) {
+
+        assert(tm != NULL);
+        assert(values != NULL);
+
+        uint8_t pkt[TELEMETRY_PACKET_MAX];
+
+        for(size_t i = 0; i < len; i += TELEMETRY_MAX_SAMPLES) {
+
+            const size_t count = len - i < TELEMETRY_MAX_SAMPLES
+                ? len - i
+                : TELEMETRY_MAX_SAMPLES;
+
+            pkt[0] = (uint8_t)telemetry_packet_samples;
+            pkt[3] = (uint8_t)count;
+
+            for(size_t j = 0; j < count; ++j) {
+                uint8_t* const p = &pkt[TELEMETRY_SAMPLES_LEN(j)];
+                bytes_put_u32(p, times != NULL ? times[i + j] : 0);
+                bytes_put_u32(p + 4, (uint32_t)values[i + j]);
+            }
+
+            if(!telemetry__send(tm, pkt, TELEMETRY_SAMPLES_LEN(count))) {
+                return false;
+            }
+
+        }
+
+        return true;
+
+}
+
+bool telemetry_send_reading(
+    telemetry_t* const tm,
+    const uint32_t time,
+    const double raw,
+    const mass_t* const m,
+    const bool stable) {
+
+        assert(tm != NULL);
+        assert(m != NULL);
+
+        uint8_t pkt[TELEMETRY_READING_LEN];
+        uint8_t* p = &pkt[TELEMETRY_HEADER_LEN];
+
+        pkt[0] = (uint8_t)telemetry_packet_reading;
+
+        bytes_put_u32(p, time);
+        bytes_put_f32(p + 4, (float)raw);
+        bytes_put_f64(p + 8, m->ug);
+        p[16] = (uint8_t)m->unit;
+        p[17] = stable ? 1 : 0;
+
+        return telemetry__send(tm, pkt, sizeof(pkt));
+
+}
+
+bool telemetry_parse(
+    const uint8_t* const buff,
+    const size_t len,
+    telemetry_packet_t* const pkt) {
+
+        assert(buff != NULL);
+        assert(pkt != NULL);
+
+        if(len < TELEMETRY_HEADER_LEN) {
+            return false;
+        }
+
+        const uint8_t* const p = &buff[TELEMETRY_HEADER_LEN];
+
+        pkt->type = (telemetry_packet_type_t)buff[0];
+        pkt->seq = bytes_get_u16(&buff[1]);
+
+        switch(pkt->type) {
+            case telemetry_packet_samples:
+
+                if(len < TELEMETRY_SAMPLES_LEN(0)) {
+                    return false;
+                }
+
+                pkt->count = p[0];
+
+                if(pkt->count > TELEMETRY_MAX_SAMPLES ||
+                    len != TELEMETRY_SAMPLES_LEN(pkt->count)) {
+                        return false;
+                }
+
+                for(size_t i = 0; i < pkt->count; ++i) {
+                    const uint8_t* const s = &buff[TELEMETRY_SAMPLES_LEN(i)];
+                    pkt->times[i] = bytes_get_u32(s);
+                    pkt->values[i] = (int32_t)bytes_get_u32(s + 4);
+                }
+
+                return true;
+
+            case telemetry_packet_reading: {
+
+                if(len != TELEMETRY_READING_LEN || p[16] > (uint8_t)mass_oz) {
+                    return false;
+                }
+
+                pkt->time = bytes_get_u32(p);
+                pkt->raw = bytes_get_f32(p + 4);
+                pkt->ug = bytes_get_f64(p + 8);
+                pkt->unit = (mass_unit_t)p[16];
+                pkt->stable = p[17] != 0;
+
+                return true;
+
+            }
+
+            default:
+                return false;
+        }
+
+}
+
+void telemetry_decoder_init(
+    telemetry_decoder_t* const dec) {
+
+        assert(dec != NULL);
+
+        dec->_len = 0;
+        dec->_overflow = false;
+
+}
+
+bool telemetry_decoder_feed(
+    telemetry_decoder_t* const dec,
+    const uint8_t byte,
+    telemetry_packet_t* const pkt) {
+
+        assert(dec != NULL);
+        assert(pkt != NULL);
+
+        if(byte != 0) {
+
+            if(dec->_len < sizeof(dec->_buff)) {
+                dec->_buff[dec->_len++] = byte;
+            }
+            else {
+                dec->_overflow = true;
+            }
+
+            return false;
+
+        }
+
+        //end of frame
+        uint8_t decoded[sizeof(dec->_buff)];
+        size_t len;
+
+        const bool ok = !dec->_overflow &&
+            dec->_len > 0 &&
+            cobs_decode(dec->_buff, dec->_len, decoded, &len) &&
+            telemetry_parse(decoded, len, pkt);
+
+        telemetry_decoder_init(dec);
+
+        return ok;
+
+}
+
+bool telemetry__send(
+    telemetry_t* const tm,
+    uint8_t* const pkt,
+    const size_t len) {
+
+        assert(tm != NULL);
+        assert(pkt != NULL);
+        assert(len <= TELEMETRY_PACKET_MAX);
+
+        uint8_t frame[TELEMETRY_FRAME_MAX];
+
+        //the sequence number is used whether or not the write succeeds,
+        //so a failed write shows up as a lost packet
+        bytes_put_u16(&pkt[1], tm->_seq++);
+
+        size_t flen = cobs_encode(pkt, len, frame);
+        frame[flen++] = 0;
+
+        return tm->_write(frame, flen, tm->_data);
+
+}
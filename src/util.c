@@ -21,6 +21,10 @@
 // SOFTWARE.
 
 #include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include "../include/util.h"
 
@@ -52,40 +56,328 @@ void util_median(
         assert(len > 0);
         assert(med != NULL);
 
-        qsort(
-            arr,
-            len,
-            sizeof(int32_t),
-            util__median_compare_func);
+        const size_t mid = len / 2;
+
+        //only the middle of the array needs to be in order
+        util_select(arr, len, mid);
 
         /**
          * If the number of elements is even, the median is
          * the average of the middle two elements. Otherwise
          * it is the middle element.
          */
-        if (len % 2 == 0) {
-            *med = (arr[(len / 2) - 1] + arr[len / 2]) / 2.0;
-        }
-        else if (len > 1) {
-            *med = (double)arr[(len / 2) + 1];
+        if(len % 2 == 0) {
+            *med = (util__max(arr, mid) + (double)arr[mid]) / 2.0;
         }
         else {
-            *med = (double)arr[0];
+            *med = (double)arr[mid];
+        }
+
+}
+
+void util_stats(
+    int32_t* const arr,
+    const size_t len,
+    util_stats_t* const stats) {
+
+        assert(arr != NULL);
+        assert(len > 0);
+        assert(stats != NULL);
+
+        /**
+         * Values are shifted by the first value before being
+         * accumulated. Samples from a load cell are clustered, so
+         * this keeps the sum of squares small and avoids the
+         * cancellation of the naive variance formula.
+         */
+        const int32_t shift = arr[0];
+        int32_t lo = arr[0];
+        int32_t hi = arr[0];
+        long long int total = 0;
+        double squares = 0;
+
+        for(size_t i = 0; i < len; ++i) {
+
+            const int32_t v = arr[i];
+            const long long int d = (long long int)v - shift;
+
+            total += d;
+            squares += (double)d * d;
+
+            if(v < lo) {
+                lo = v;
+            }
+
+            if(v > hi) {
+                hi = v;
+            }
+
+        }
+
+        const double dmean = (double)total / len;
+
+        stats->len = len;
+        stats->mean = shift + dmean;
+        stats->variance = len > 1
+            ? (squares - (dmean * total)) / (len - 1)
+            : 0;
+        stats->min = lo;
+        stats->max = hi;
+
+        util_median(arr, len, &stats->median);
+
+}
+
+void util_select(
+    int32_t* const arr,
+    const size_t len,
+    const size_t k) {
+        util__select(arr, len, k, false);
+}
+
+void util_trimmed_mean(
+    int32_t* const arr,
+    const size_t len,
+    const double trim,
+    double* const avg) {
+
+        assert(arr != NULL);
+        assert(len > 0);
+        assert(trim >= 0 && trim < 0.5);
+        assert(avg != NULL);
+
+        //number of values to discard from each end
+        size_t k = (size_t)(len * trim);
+
+        //always keep at least one value
+        if(k * 2 >= len) {
+            k = (len - 1) / 2;
+        }
+
+        /**
+         * Selecting indices k and len - k - 1 together puts the k
+         * lowest values before the first and the k highest after
+         * the second. What lies between is the trimmed set, and no
+         * full sort is needed.
+         */
+        if(k > 0) {
+            util__select_pair(arr, len, k, len - k - 1);
+        }
+
+        util_average(arr + k, len - (2 * k), avg);
+
+}
+
+void util_mad_mean(
+    int32_t* const arr,
+    const size_t len,
+    const double k,
+    double* const avg) {
+
+        assert(arr != NULL);
+        assert(len > 0);
+        assert(k > 0);
+        assert(avg != NULL);
+
+        const size_t mid = len / 2;
+
+        util_select(arr, len, mid);
+        const int32_t med = arr[mid];
+
+        /**
+         * Replace each value with its signed deviation from the
+         * median. Selecting on the magnitude of the deviations then
+         * gives the median absolute deviation, and the sign is kept
+         * so the values can be restored afterwards.
+         */
+        for(size_t i = 0; i < len; ++i) {
+            arr[i] -= med;
+        }
+
+        util__select(arr, len, mid, true);
+
+        const double mad = (double)abs(arr[mid]);
+        const double limit = k * UTIL_MAD_TO_SD * mad;
+        long long int total = 0;
+        size_t count = 0;
+
+        for(size_t i = 0; i < len; ++i) {
+            if(fabs((double)arr[i]) <= limit) {
+                total += arr[i];
+                ++count;
+            }
+            arr[i] += med;
         }
 
+        //the median itself has no deviation, so count >= 1
+        *avg = med + ((double)total / count);
+
 }
 
-int util__median_compare_func(
-    const void* a,
-    const void* b) {
+static inline uint32_t util__select_key(
+    const int32_t val,
+    const bool absolute) {
+
+        if(absolute) {
+            return val < 0 ? 0u - (uint32_t)val : (uint32_t)val;
+        }
+
+        //flipping the sign bit keeps the order of signed values
+        return (uint32_t)val ^ UINT32_C(0x80000000);
+
+}
+
+/**
+ * Partitions [*lo, *hi] of arr around a median of three pivot using
+ * Hoare's scheme. Afterwards [lo, j] <= pivot, (j, i) == pivot and
+ * [i, hi] >= pivot.
+ */
+static inline void util__partition(
+    int32_t* const arr,
+    const ptrdiff_t lo,
+    const ptrdiff_t hi,
+    const bool absolute,
+    ptrdiff_t* const pi,
+    ptrdiff_t* const pj) {
+
+        //median of three pivot guards against already
+        //ordered runs of values
+        const uint32_t a = util__select_key(arr[lo], absolute);
+        const uint32_t b = util__select_key(arr[lo + ((hi - lo) / 2)], absolute);
+        const uint32_t c = util__select_key(arr[hi], absolute);
+        const uint32_t pivot = a < b
+            ? (b < c ? b : (a < c ? c : a))
+            : (a < c ? a : (b < c ? c : b));
+
+        ptrdiff_t i = lo;
+        ptrdiff_t j = hi;
+
+        while(i <= j) {
+
+            while(util__select_key(arr[i], absolute) < pivot) {
+                ++i;
+            }
+
+            while(util__select_key(arr[j], absolute) > pivot) {
+                --j;
+            }
+
+            if(i <= j) {
+                const int32_t tmp = arr[i];
+                arr[i] = arr[j];
+                arr[j] = tmp;
+                ++i;
+                --j;
+            }
+
+        }
+
+        *pi = i;
+        *pj = j;
+
+}
+
+void util__select(
+    int32_t* const arr,
+    const size_t len,
+    const size_t k,
+    const bool absolute) {
+
+        assert(arr != NULL);
+        assert(k < len);
+
+        ptrdiff_t lo = 0;
+        ptrdiff_t hi = (ptrdiff_t)len - 1;
+        const ptrdiff_t target = (ptrdiff_t)k;
+
+        //quickselect
+        while(hi > lo) {
+
+            ptrdiff_t i;
+            ptrdiff_t j;
+
+            util__partition(arr, lo, hi, absolute, &i, &j);
 
-        assert(a != NULL);
-        assert(b != NULL);
+            if(target <= j) {
+                hi = j;
+            }
+            else if(target >= i) {
+                lo = i;
+            }
+            else {
+                break;
+            }
+
+        }
+
+}
+
+void util__select_pair(
+    int32_t* const arr,
+    const size_t len,
+    const size_t k1,
+    const size_t k2) {
+
+        assert(arr != NULL);
+        assert(k1 <= k2);
+        assert(k2 < len);
+
+        ptrdiff_t lo = 0;
+        ptrdiff_t hi = (ptrdiff_t)len - 1;
+        const ptrdiff_t t1 = (ptrdiff_t)k1;
+        const ptrdiff_t t2 = (ptrdiff_t)k2;
+
+        /**
+         * Partition as a single quickselect would while both indices
+         * are on the same side. Once a pivot separates them, each side
+         * is finished with its own selection over what is left.
+         */
+        while(hi > lo) {
+
+            ptrdiff_t i;
+            ptrdiff_t j;
+
+            util__partition(arr, lo, hi, false, &i, &j);
+
+            if(t2 <= j) {
+                hi = j;
+            }
+            else if(t1 >= i) {
+                lo = i;
+            }
+            else {
+
+                if(t1 <= j) {
+                    util__select(arr + lo, (size_t)(j - lo + 1), (size_t)(t1 - lo), false);
+                }
+
+                if(t2 >= i) {
+                    util__select(arr + i, (size_t)(hi - i + 1), (size_t)(t2 - i), false);
+                }
+
+                break;
+
+            }
+
+        }
+
+}
+
+int32_t util__max(
+    const int32_t* const arr,
+    const size_t len) {
+
+        assert(arr != NULL);
+        assert(len > 0);
+
+        int32_t m = arr[0];
+
+        for(size_t i = 1; i < len; ++i) {
+            if(arr[i] > m) {
+                m = arr[i];
+            }
+        }
 
-        const int32_t* restrict const pA = (const int32_t* const)a;
-        const int32_t* restrict const pB = (const int32_t* const)b;
-        
-        //https://stackoverflow.com/a/10996555/570787
-        return (*pA < *pB) ? -1 : (*pA > *pB);
+        return m;
 
 }
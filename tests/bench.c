@@ -0,0 +1,469 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Benchmarks reading, weighing and zeroing a simulated scale with
+ * each strategy, read type and buffer size. Builds for the pico and
+ * for the host (PICO_PLATFORM=host).
+ * 
+ * cost: CPU time per reading, not including time spent generating
+ * the simulated values, and the readings per second that allows.
+ * On the pico, the cycles to reduce a full buffer are also given.
+ * 
+ * settle: simulated time from a step in load to the first reading
+ * after which every reading is within BENCH_TOLERANCE of the load,
+ * for each simulated signal. "-" if that never happens.
+ * 
+ * Exits with a failure status, and marks the line with "FAIL", if a
+ * read fails, if the cost per value of the largest buffer is more than
+ * BENCH_MAX_SCALING times that of the smallest (so a reduction has
+ * become worse than n log n), or if a read type settles later than its
+ * entry in BENCH_SETTLE_BASELINE. The simulation is seeded and its time
+ * is simulated, so settle times are the same on every machine; update
+ * the baseline when a change is meant to alter them.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "../include/scale.h"
+#include "../include/sim_scale_adaptor.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/structs/systick.h"
+#endif
+
+#define BENCH_MAX_BUFF 128u
+#define BENCH_STEP_TIME 1000000u //us
+#define BENCH_STEP_LOAD 100.0
+
+static const size_t BENCH_BUFFS[] = { 8, 32, 128 };
+
+static const read_type_t BENCH_READS[] = {
+    read_type_median,
+    read_type_average,
+    read_type_kalman,
+    read_type_trimmed_mean,
+    read_type_mad_mean,
+    read_type_quantile
+};
+
+static const char* const BENCH_READ_NAMES[] = {
+    "median",
+    "average",
+    "kalman",
+    "trimmed",
+    "mad",
+    "quantile"
+};
+
+static const char* const BENCH_STRAT_NAMES[] = {
+    "samples",
+    "time"
+};
+
+typedef enum {
+    bench_signal_quiet = 0,
+    bench_signal_mains,
+    bench_signal_spikes,
+    bench_signal_count
+} bench_signal_t;
+
+static const char* const BENCH_SIGNAL_NAMES[] = {
+    "quiet",
+    "mains",
+    "spikes"
+};
+
+static const uint64_t BENCH_SETTLE_END = 4000000; //us
+static const double BENCH_TOLERANCE = 0.25;
+static const uint64_t BENCH_MIN_TIME = 200000; //us of CPU time per cost
+static const size_t BENCH_MIN_READS = 20;
+static const double BENCH_MAX_SCALING = 4.0;
+
+/**
+ * Latest each read type may settle, in ms, indexed by read type (as
+ * BENCH_READS), buffer (as BENCH_BUFFS) and signal; -1 where it is not
+ * expected to settle at all
+ */
+static const int32_t BENCH_SETTLE_BASELINE[6][3][bench_signal_count] = {
+    { {  400,  900,  400 }, {  600,  600,  600 }, { 2200, 2200, 2200 } }, //median
+    { {  200,  200, 2300 }, {  600,  600, 2600 }, { 2200, 2200,   -1 } }, //average
+    { {  400,   -1, 1600 }, {  600,   -1,  600 }, {  600,   -1,  600 } }, //kalman
+    { {  400,  300,  400 }, {  600,  600,  600 }, { 2200, 2200, 2200 } }, //trimmed
+    { {  400,  300,  400 }, {  600,  600,  600 }, { 2200, 2200, 2200 } }, //mad
+    { {  400, 2000,  400 }, {  600,  600,  600 }, { 2200, 2200,   -1 } }  //quantile
+};
+
+static const sim_step_t BENCH_STEPS[] = {
+    { .time = BENCH_STEP_TIME, .load = BENCH_STEP_LOAD }
+};
+
+static int32_t bench_buff[BENCH_MAX_BUFF];
+
+static void bench_sim_init(
+    sim_scale_adaptor_t* const sim,
+    const bench_signal_t signal) {
+
+        sim_scale_adaptor_config_t cfg;
+
+        sim_scale_adaptor_get_default_config(&cfg);
+        cfg.steps = BENCH_STEPS;
+        cfg.steps_len = 1;
+        cfg.ring_hz = 6;
+
+        switch(signal) {
+            case bench_signal_mains:
+                cfg.mains = 400;
+                break;
+
+            case bench_signal_spikes:
+                cfg.spike_p = 0.02;
+                break;
+
+            case bench_signal_quiet:
+            default:
+                break;
+        }
+
+        sim_scale_adaptor_init(sim, &cfg);
+
+}
+
+static void bench_scale_init(
+    scale_t* const sc,
+    sim_scale_adaptor_t* const sim,
+    scale_options_t* const opt,
+    const strategy_type_t strat,
+    const read_type_t read,
+    const size_t len) {
+
+        int32_t ref_unit;
+        int32_t offset;
+
+        sim_scale_adaptor_get_calibration(sim, &ref_unit, &offset);
+
+        scale_init(
+            sc,
+            sim_scale_adaptor_get_base(sim),
+            mass_g,
+            ref_unit,
+            offset);
+
+        scale_options_get_default(opt);
+        opt->strat = strat;
+        opt->read = read;
+        opt->buffer = bench_buff;
+        opt->bufflen = len;
+        opt->samples = len;
+
+        //with values served at once, a window only ends when the
+        //buffer is full; the timeout just has to be long enough
+        opt->timeout = 1000000;
+
+}
+
+/**
+ * @brief Returns the CPU time in ns to generate one simulated value,
+ * so it can be taken out of the cost of reading
+ */
+static double bench_sim_cost(void) {
+
+    sim_scale_adaptor_t sim;
+    int32_t v;
+    size_t n = 0;
+
+    bench_sim_init(&sim, bench_signal_quiet);
+
+    const uint64_t start = time_us_64();
+    uint64_t elapsed;
+
+    do {
+        for(size_t i = 0; i < 1000; ++i) {
+            sim_scale_adaptor_get_value(sim_scale_adaptor_get_base(&sim), &v);
+        }
+        n += 1000;
+    } while((elapsed = time_us_64() - start) < BENCH_MIN_TIME);
+
+    return elapsed * 1000.0 / n;
+
+}
+
+#if PICO_ON_DEVICE
+/**
+ * @brief Returns the cycles to reduce a full buffer, counted by
+ * SysTick, which runs at the processor clock
+ */
+static uint32_t bench_reduce_cycles(
+    scale_t* const sc,
+    const scale_options_t* const opt) {
+
+        double val;
+
+        systick_hw->rvr = 0xffffff;
+        systick_hw->cvr = 0;
+        systick_hw->csr = 0x5; //enable, processor clock
+
+        //SysTick counts down
+        const uint32_t start = systick_hw->cvr;
+        scale_reduce(sc, &val, NULL, opt, opt->bufflen);
+        const uint32_t end = systick_hw->cvr;
+
+        return (start - end) & 0xffffff;
+
+}
+#endif
+
+typedef enum {
+    bench_op_read = 0,
+    bench_op_weight,
+    bench_op_zero,
+    bench_op_plan
+} bench_op_t;
+
+static const char* const BENCH_OP_NAMES[] = {
+    "read",
+    "weight",
+    "zero",
+    "plan"
+};
+
+/**
+ * @brief Prints the cost of an operation and sets ns to the CPU time in
+ * ns per reading. Returns false if any reading failed.
+ */
+static bool bench_cost(
+    const bench_op_t op,
+    const strategy_type_t strat,
+    const read_type_t read,
+    const size_t len,
+    const double sim_ns,
+    double* const ns) {
+
+        sim_scale_adaptor_t sim;
+        scale_t sc;
+        scale_options_t opt;
+        scale_plan_t plan;
+        double val;
+        mass_t m;
+        size_t reads = 0;
+        bool ok = true;
+
+        bench_sim_init(&sim, bench_signal_quiet);
+        bench_scale_init(&sc, &sim, &opt, strat, read, len);
+        scale_plan_init(&plan, &opt);
+
+        const uint64_t start = time_us_64();
+        uint64_t elapsed;
+
+        do {
+            switch(op) {
+                case bench_op_weight:
+                    ok &= scale_weight(&sc, &m, &opt);
+                    break;
+                case bench_op_zero:
+                    ok &= scale_zero(&sc, &opt);
+                    break;
+                case bench_op_plan:
+                    ok &= scale_plan_read(&sc, &plan, &val);
+                    break;
+                case bench_op_read:
+                default:
+                    ok &= scale_read(&sc, &val, &opt);
+                    break;
+            }
+            ++reads;
+        } while((elapsed = time_us_64() - start) < BENCH_MIN_TIME || reads < BENCH_MIN_READS);
+
+        *ns = elapsed * 1000.0 / reads - (sim_ns * len);
+
+        printf("%-7s %-8s %-9s %5u %12.0f %12.0f",
+            BENCH_OP_NAMES[op],
+            BENCH_STRAT_NAMES[strat],
+            BENCH_READ_NAMES[read],
+            (unsigned)len,
+            *ns,
+            *ns > 0 ? 1e9 / *ns : 0.0);
+
+#if PICO_ON_DEVICE
+        //the buffer still holds the last window
+        if(read != read_type_quantile) {
+            printf(" %10lu", (unsigned long)bench_reduce_cycles(&sc, &opt));
+        }
+#endif
+
+        printf(ok ? "\n" : " FAIL\n");
+
+        return ok;
+
+}
+
+/**
+ * @brief Returns the us from the step to the reading after which every
+ * reading is within tolerance, or -1 if there is none
+ */
+static int64_t bench_settle(
+    const bench_signal_t signal,
+    const read_type_t read,
+    const size_t len) {
+
+        sim_scale_adaptor_t sim;
+        scale_t sc;
+        scale_options_t opt;
+        mass_t m;
+        double val;
+        int64_t settled = -1;
+
+        bench_sim_init(&sim, signal);
+        bench_scale_init(&sc, &sim, &opt, strategy_type_samples, read, len);
+
+        while(sim_scale_adaptor_get_clock(&sim) < BENCH_SETTLE_END) {
+
+            if(!scale_weight(&sc, &m, &opt)) {
+                return -1;
+            }
+
+            //the reading is available once its last value is
+            const uint64_t now = sim_scale_adaptor_get_clock(&sim);
+
+            if(now <= BENCH_STEP_TIME) {
+                continue;
+            }
+
+            mass_get_value(&m, &val);
+
+            if(val < BENCH_STEP_LOAD - BENCH_TOLERANCE ||
+                val > BENCH_STEP_LOAD + BENCH_TOLERANCE) {
+                    settled = -1;
+            }
+            else if(settled < 0) {
+                settled = (int64_t)(now - BENCH_STEP_TIME);
+            }
+
+        }
+
+        return settled;
+
+}
+
+int main(void) {
+
+    stdio_init_all();
+
+    const double sim_ns = bench_sim_cost();
+    bool ok = true;
+    double ns;
+
+    printf("simulated value: %.0f ns\n\n", sim_ns);
+
+    printf("%-7s %-8s %-9s %5s %12s %12s",
+        "op", "strategy", "read", "buff", "ns/reading", "readings/s");
+#if PICO_ON_DEVICE
+    printf(" %10s", "cycles");
+#endif
+    printf("\n");
+
+    for(size_t s = 0; s < 2; ++s) {
+        for(size_t r = 0; r < count_of(BENCH_READS); ++r) {
+
+            //streamed reads run until the timeout rather than until the
+            //buffer is full, so their cost is the timeout
+            if(s == strategy_type_time && BENCH_READS[r] == read_type_quantile) {
+                continue;
+            }
+
+            double first = 0;
+
+            for(size_t b = 0; b < count_of(BENCH_BUFFS); ++b) {
+
+                ok &= bench_cost(bench_op_read, (strategy_type_t)s, BENCH_READS[r], BENCH_BUFFS[b], sim_ns, &ns);
+
+                //cost per value
+                ns /= BENCH_BUFFS[b];
+
+                if(b == 0) {
+                    first = ns;
+                }
+                else if(b == count_of(BENCH_BUFFS) - 1 && ns > first * BENCH_MAX_SCALING) {
+                    printf("FAIL: %s %s costs %.0f ns per value with %u values, %.0f with %u\n",
+                        BENCH_STRAT_NAMES[s],
+                        BENCH_READ_NAMES[r],
+                        ns,
+                        (unsigned)BENCH_BUFFS[b],
+                        first,
+                        (unsigned)BENCH_BUFFS[0]);
+                    ok = false;
+                }
+
+            }
+        }
+    }
+
+    ok &= bench_cost(bench_op_weight, strategy_type_samples, read_type_median, 32, sim_ns, &ns);
+    ok &= bench_cost(bench_op_zero, strategy_type_samples, read_type_median, 32, sim_ns, &ns);
+    ok &= bench_cost(bench_op_plan, strategy_type_samples, read_type_median, 32, sim_ns, &ns);
+
+    printf("\nsettle to within %.2f of a %.0f step, ms\n", BENCH_TOLERANCE, BENCH_STEP_LOAD);
+    printf("%-9s %5s", "read", "buff");
+    for(size_t g = 0; g < bench_signal_count; ++g) {
+        printf(" %8s", BENCH_SIGNAL_NAMES[g]);
+    }
+    printf("\n");
+
+    for(size_t r = 0; r < count_of(BENCH_READS); ++r) {
+        for(size_t b = 0; b < count_of(BENCH_BUFFS); ++b) {
+
+            printf("%-9s %5u", BENCH_READ_NAMES[r], (unsigned)BENCH_BUFFS[b]);
+
+            bool settled = true;
+
+            for(size_t g = 0; g < bench_signal_count; ++g) {
+
+                const int64_t us = bench_settle((bench_signal_t)g, BENCH_READS[r], BENCH_BUFFS[b]);
+                const int32_t baseline = BENCH_SETTLE_BASELINE[r][b][g];
+
+                if(us < 0) {
+                    printf(" %8s", "-");
+                }
+                else {
+                    printf(" %8.1f", us / 1000.0);
+                }
+
+                if(baseline >= 0 && (us < 0 || us > (int64_t)baseline * 1000)) {
+                    settled = false;
+                }
+
+            }
+
+            printf(settled ? "\n" : " FAIL\n");
+            ok &= settled;
+
+        }
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
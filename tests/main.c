@@ -26,6 +26,27 @@
 #include "pico/stdio.h"
 #include "../include/hx711_scale_adaptor.h"
 #include "../include/scale.h"
+#include "../include/telemetry.h"
+
+//set to 1 to stream every raw sample and each weight as binary
+//telemetry instead of text; decode it with tools/telemetry_decode
+#define USE_TELEMETRY 0
+
+static bool write_frame(
+    const uint8_t* const buff,
+    const size_t len,
+    void* const data) {
+
+        (void)data;
+
+        //putchar_raw does not turn \n into \r\n
+        for(size_t i = 0; i < len; ++i) {
+            putchar_raw(buff[i]);
+        }
+
+        return true;
+
+}
 
 int main(void) {
 
@@ -40,19 +61,25 @@ int main(void) {
     hx711_config_t hxcfg = {0};
     hx711_scale_adaptor_t hxsa = {0};
 
-    scale_t sc = {0};
-    scale_options_t opt = {0};
-    scale_options_get_default(&opt);
-
-    //2. provide a read buffer for the scale
-    //NOTE: YOU MUST DO THIS
-    const size_t valbufflen = 1000;
-    int32_t valbuff[valbufflen];
-    opt.buffer = valbuff;
-    opt.bufflen = valbufflen;
+    //2. declare the scale with a read buffer for up to
+    //1000 values, and a copy of the default options
+    //which use it to change
+    static SCALE_DEFINE(scale, 1000);
+    scale_t* const sc = &scale.sc;
+    scale_options_t options = *scale.opt;
+    scale_options_t* const opt = &options;
 
     char str[MASS_TO_STRING_BUFF_SIZE];
 
+    //when each value was obtained
+    static uint32_t timebuff[count_of(scale.buffer)];
+    telemetry_t tm;
+
+    if(USE_TELEMETRY) {
+        opt->timestamps = timebuff;
+        telemetry_init(&tm, write_frame, NULL);
+    }
+
     //3. in this example a hx711 is used, so initialise it
     hx711_get_default_config(&hxcfg);
     hxcfg.clock_pin = 14;
@@ -63,11 +90,13 @@ int main(void) {
     hx711_wait_settle(hx711_rate_80);
 
     //4. provide a pointer to the hx711 to the adaptor
+    //and tell it the rate the hx711 is operating at
     hx711_scale_adaptor_init(&hxsa, &hx);
+    hx711_scale_adaptor_set_rate(&hxsa, hx711_rate_80);
 
     //5. initalise the scale
     scale_init(
-        &sc,
+        sc,
         hx711_scale_adaptor_get_base(&hxsa),
         unit,
         refUnit,
@@ -77,10 +106,10 @@ int main(void) {
     //possible to zero (aka. tare) the scale. The max
     //number of samples will be limited to the size of
     //the buffer allocated above
-    opt.strat = strategy_type_time;
-    opt.timeout = 10000000;
+    opt->strat = strategy_type_time;
+    opt->timeout = 10000000;
 
-    if(scale_zero(&sc, &opt)) {
+    if(scale_zero(sc, opt)) {
         printf("Scale zeroed successfully\n");
     }
     else {
@@ -92,45 +121,84 @@ int main(void) {
     mass_t min;
 
     //change to spending 250 milliseconds obtaining
-    opt.timeout = 250000;
+    //each weight, and check the options once here
+    //rather than every time the scale is read
+    opt->timeout = 250000;
+
+    if(!scale_plan_init(&scale.plan, opt)) {
+        printf("Invalid scale options\n");
+        return EXIT_FAILURE;
+    }
 
     mass_init(&max, mass_g, 0);
     mass_init(&min, mass_g, 0);
 
     for(;;) {
 
-        memset(str, 0, MASS_TO_STRING_BUFF_SIZE);
+        if(USE_TELEMETRY) {
 
-        //obtain a mass from the scale
-        if(scale_weight(&sc, &mass, &opt)) {
+            double raw;
+            double val;
+            size_t len;
+            scale_reading_t r;
 
-            //check if the newly obtained mass
-            //is less than the existing minimum mass
-            if(mass_lt(&mass, &min)) {
-                min = mass;
+            //acquire and reduce separately so the values can be sent
+            //as they were obtained; reducing filters and reorders them
+            //in place
+            if(!scale_acquire(sc, opt, &len)) {
+                continue;
             }
 
-            //check if the newly obtained mass
-            //is greater than the existing maximum mass
-            if(mass_gt(&mass, &max)) {
-                max = mass;
-            }
+            telemetry_send_samples(&tm, scale.buffer, timebuff, len);
+
+            if(scale_reduce(sc, &raw, NULL, opt, len) &&
+                scale_normalise(sc, &raw, &val)) {
 
-            //display the newly obtained mass...
-            mass_to_string(&mass, str);
-            printf("%s", str);
+                    mass_init(&mass, sc->unit, val);
+                    scale_publish(sc, &raw, &mass);
+                    scale_get_latest(sc, &r);
 
-            //...the current minimum mass...
-            mass_to_string(&min, str);
-            printf(" min: %s", str);
+                    telemetry_send_reading(&tm, (uint32_t)r.time, raw, &mass, r.stable);
 
-            //...and the current maximum mass
-            mass_to_string(&max, str);
-            printf(" max: %s\n", str);
+            }
 
         }
         else {
-            printf("Failed to read weight\n");
+
+            memset(str, 0, MASS_TO_STRING_BUFF_SIZE);
+
+            //obtain a mass from the scale
+            if(scale_plan_weight(sc, &scale.plan, &mass)) {
+
+                //check if the newly obtained mass
+                //is less than the existing minimum mass
+                if(mass_lt(&mass, &min)) {
+                    min = mass;
+                }
+
+                //check if the newly obtained mass
+                //is greater than the existing maximum mass
+                if(mass_gt(&mass, &max)) {
+                    max = mass;
+                }
+
+                //display the newly obtained mass...
+                mass_to_string(&mass, str);
+                printf("%s", str);
+
+                //...the current minimum mass...
+                mass_to_string(&min, str);
+                printf(" min: %s", str);
+
+                //...and the current maximum mass
+                mass_to_string(&max, str);
+                printf(" max: %s\n", str);
+
+            }
+            else {
+                printf("Failed to read weight\n");
+            }
+
         }
 
     }
@@ -0,0 +1,83 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TEST_H_6C2E8F41_93A7_4B5D_8E10_D47A2B9C5F36
+#define TEST_H_6C2E8F41_93A7_4B5D_8E10_D47A2B9C5F36
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Checks shared by the host unit tests. A failed check prints where
+ * it failed and is counted; the test carries on so every failure is
+ * reported, then test_result gives the exit status.
+ */
+
+static unsigned test__checks = 0;
+static unsigned test__failures = 0;
+
+static bool test__check(
+    const bool ok,
+    const char* const expr,
+    const char* const file,
+    const int line) {
+
+        ++test__checks;
+
+        if(!ok) {
+            ++test__failures;
+            fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+        }
+
+        return ok;
+
+}
+
+#define TEST_CHECK(cond) \
+    test__check((cond), #cond, __FILE__, __LINE__)
+
+#define TEST_CHECK_NEAR(a, b, tol) \
+    test__check(fabs((double)(a) - (double)(b)) <= (tol), \
+        #a " is within " #tol " of " #b, __FILE__, __LINE__)
+
+/**
+ * @brief Prints a summary of the checks made and returns the exit status
+ * 
+ * @param name 
+ * @return int 
+ */
+static int test_result(
+    const char* const name) {
+
+        printf("%s: %u/%u checks passed\n",
+            name,
+            test__checks - test__failures,
+            test__checks);
+
+        return test__failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
+
+#endif
@@ -0,0 +1,244 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for the checkweigher
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/checkweigher.h"
+#include "../include/mass.h"
+#include "../include/scale.h"
+#include "../include/sim_scale_adaptor.h"
+#include "test.h"
+
+#define TEST_CW_SETTLE 2u
+#define TEST_CW_SAMPLES 4u
+#define TEST_CW_GAP 3u //empty samples between items
+
+/**
+ * Raw counts for a weight in grams on the test scale
+ */
+#define TEST_CW_RAW(sc, g) ((int32_t)((sc)->offset + ((g) * (sc)->ref_unit)))
+
+typedef struct {
+    sim_scale_adaptor_t sim;
+    scale_t sc;
+    checkweigher_t cw;
+} test_cw_t;
+
+/**
+ * A 100g target, under below 98g, over above 103g, and an item on the
+ * scale above 20g
+ */
+static void test_cw_init(
+    test_cw_t* const t) {
+
+        sim_scale_adaptor_config_t simcfg;
+        checkweigher_config_t cfg;
+
+        sim_scale_adaptor_get_default_config(&simcfg);
+        sim_scale_adaptor_init(&t->sim, &simcfg);
+        scale_init(&t->sc, sim_scale_adaptor_get_base(&t->sim), mass_g, 100, 50);
+
+        mass_init(&cfg.target, mass_g, 100);
+        mass_init(&cfg.under, mass_g, 2);
+        mass_init(&cfg.over, mass_g, 3);
+        mass_init(&cfg.empty, mass_g, 20);
+        cfg.settle = TEST_CW_SETTLE;
+        cfg.samples = TEST_CW_SAMPLES;
+
+        checkweigher_init(&t->cw, &t->sc, &cfg);
+
+}
+
+/**
+ * Feeds an empty scale, then len samples of an item. Returns the
+ * number of decisions made and sets result and at to the last one
+ * and the index of the sample which made it.
+ */
+static size_t test_cw_item(
+    test_cw_t* const t,
+    const double* const grams,
+    const size_t len,
+    checkweigher_result_t* const result,
+    size_t* const at) {
+
+        checkweigher_result_t r;
+        size_t decisions = 0;
+
+        for(size_t i = 0; i < TEST_CW_GAP; ++i) {
+            if(checkweigher_feed(&t->cw, TEST_CW_RAW(&t->sc, 0), &r)) {
+                ++decisions;
+            }
+        }
+
+        for(size_t i = 0; i < len; ++i) {
+            if(checkweigher_feed(&t->cw, TEST_CW_RAW(&t->sc, grams[i]), &r)) {
+                *result = r;
+                *at = i;
+                ++decisions;
+            }
+        }
+
+        return decisions;
+
+}
+
+static void test_cw_classifies(void) {
+
+    //the band edges themselves are accepted
+    static const double weights[] = { 100, 97.5, 103.5, 98, 103, 97.99, 103.01 };
+    static const checkweigher_result_t expect[] = {
+        checkweigher_accept,
+        checkweigher_under,
+        checkweigher_over,
+        checkweigher_accept,
+        checkweigher_accept,
+        checkweigher_under,
+        checkweigher_over
+    };
+
+    test_cw_t t;
+
+    test_cw_init(&t);
+
+    for(size_t k = 0; k < sizeof(weights) / sizeof(weights[0]); ++k) {
+
+        double grams[2 * (TEST_CW_SETTLE + TEST_CW_SAMPLES)];
+        checkweigher_result_t r = checkweigher_accept;
+        size_t at = 0;
+
+        for(size_t i = 0; i < sizeof(grams) / sizeof(grams[0]); ++i) {
+            grams[i] = weights[k];
+        }
+
+        //one decision per item, once it has settled and been measured,
+        //however long it then stays on the scale
+        TEST_CHECK(test_cw_item(&t, grams, sizeof(grams) / sizeof(grams[0]), &r, &at) == 1);
+        TEST_CHECK(r == expect[k]);
+        TEST_CHECK(at == TEST_CW_SETTLE + TEST_CW_SAMPLES);
+
+    }
+
+    TEST_CHECK(checkweigher_get_count(&t.cw, checkweigher_accept) == 3);
+    TEST_CHECK(checkweigher_get_count(&t.cw, checkweigher_under) == 2);
+    TEST_CHECK(checkweigher_get_count(&t.cw, checkweigher_over) == 2);
+
+}
+
+static void test_cw_averages_samples(void) {
+
+    //the arriving and settling samples are discarded, and the rest
+    //are averaged so no single sample decides
+    static const double grams[] = { 150, 150, 60, 97, 99.2, 97, 99.2 };
+
+    test_cw_t t;
+    checkweigher_result_t r = checkweigher_under;
+    size_t at = 0;
+
+    test_cw_init(&t);
+
+    TEST_CHECK(test_cw_item(&t, grams, sizeof(grams) / sizeof(grams[0]), &r, &at) == 1);
+    TEST_CHECK(r == checkweigher_accept);
+
+}
+
+static void test_cw_removed_while_settling(void) {
+
+    //an item which leaves before it settles is not decided, and the
+    //next one starts afresh
+    static const double bounce[] = { 100, 0, 0 };
+    static const double item[] = { 104, 104, 104, 104, 104, 104, 104 };
+
+    test_cw_t t;
+    checkweigher_result_t r = checkweigher_accept;
+    size_t at = 0;
+
+    test_cw_init(&t);
+
+    TEST_CHECK(test_cw_item(&t, bounce, sizeof(bounce) / sizeof(bounce[0]), &r, &at) == 0);
+    TEST_CHECK(test_cw_item(&t, item, sizeof(item) / sizeof(item[0]), &r, &at) == 1);
+    TEST_CHECK(r == checkweigher_over);
+
+}
+
+static void test_cw_follows_offset(void) {
+
+    //weights are relative to the offset when each sample is fed, so
+    //zeroing with a tray on the scale weighs what is put on the tray
+    static const double item[] = { 97, 97, 97, 97, 97, 97, 97 };
+
+    test_cw_t t;
+    checkweigher_result_t r = checkweigher_accept;
+    size_t at = 0;
+
+    test_cw_init(&t);
+    t.sc.offset = TEST_CW_RAW(&t.sc, 500);
+
+    TEST_CHECK(test_cw_item(&t, item, sizeof(item) / sizeof(item[0]), &r, &at) == 1);
+    TEST_CHECK(r == checkweigher_under);
+
+}
+
+static void test_cw_stats(void) {
+
+    static const double item[] = { 100, 100, 100, 100, 100, 100, 100 };
+
+    test_cw_t t;
+    checkweigher_result_t r;
+    size_t at;
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;
+
+    test_cw_init(&t);
+
+    TEST_CHECK(!checkweigher_get_latency(&t.cw, &min, &max, &mean));
+
+    test_cw_item(&t, item, sizeof(item) / sizeof(item[0]), &r, &at);
+    test_cw_item(&t, item, sizeof(item) / sizeof(item[0]), &r, &at);
+
+    TEST_CHECK(checkweigher_get_latency(&t.cw, &min, &max, &mean));
+    TEST_CHECK(min <= mean && mean <= max);
+
+    checkweigher_reset_stats(&t.cw);
+
+    TEST_CHECK(checkweigher_get_count(&t.cw, checkweigher_accept) == 0);
+    TEST_CHECK(!checkweigher_get_latency(&t.cw, &min, &max, &mean));
+
+}
+
+int main(void) {
+
+    test_cw_classifies();
+    test_cw_averages_samples();
+    test_cw_removed_while_settling();
+    test_cw_follows_offset();
+    test_cw_stats();
+
+    return test_result("checkweigher");
+
+}
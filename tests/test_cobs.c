@@ -0,0 +1,196 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for Consistent Overhead Byte Stuffing
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/cobs.h"
+#include "test.h"
+
+#define TEST_COBS_MAX_LEN 600u
+
+typedef struct {
+    const uint8_t* raw;
+    size_t rawlen;
+    const uint8_t* enc;
+    size_t enclen;
+} test_cobs_vector_t;
+
+static uint32_t test_cobs_seed = 1;
+
+static uint8_t test_cobs_rand(void) {
+    test_cobs_seed = (test_cobs_seed * 1103515245u) + 12345u;
+    return (uint8_t)(test_cobs_seed >> 16);
+}
+
+static bool test_cobs_has_zero(
+    const uint8_t* const buff,
+    const size_t len) {
+        return memchr(buff, 0, len) != NULL;
+}
+
+static void test_cobs_vectors(void) {
+
+    //the usual examples of short frames, and an empty one
+    static const uint8_t r0[] = { 0x00 };
+    static const uint8_t e0[] = { 0x01, 0x01 };
+    static const uint8_t r1[] = { 0x00, 0x00 };
+    static const uint8_t e1[] = { 0x01, 0x01, 0x01 };
+    static const uint8_t r2[] = { 0x00, 0x11, 0x00 };
+    static const uint8_t e2[] = { 0x01, 0x02, 0x11, 0x01 };
+    static const uint8_t r3[] = { 0x11, 0x22, 0x00, 0x33 };
+    static const uint8_t e3[] = { 0x03, 0x11, 0x22, 0x02, 0x33 };
+    static const uint8_t r4[] = { 0x11, 0x22, 0x33, 0x44 };
+    static const uint8_t e4[] = { 0x05, 0x11, 0x22, 0x33, 0x44 };
+    static const uint8_t r5[] = { 0x11, 0x00, 0x00, 0x00 };
+    static const uint8_t e5[] = { 0x02, 0x11, 0x01, 0x01, 0x01 };
+    static const uint8_t e6[] = { 0x01 };
+
+    static const test_cobs_vector_t vectors[] = {
+        { r0, sizeof(r0), e0, sizeof(e0) },
+        { r1, sizeof(r1), e1, sizeof(e1) },
+        { r2, sizeof(r2), e2, sizeof(e2) },
+        { r3, sizeof(r3), e3, sizeof(e3) },
+        { r4, sizeof(r4), e4, sizeof(e4) },
+        { r5, sizeof(r5), e5, sizeof(e5) },
+        { NULL, 0, e6, sizeof(e6) }
+    };
+
+    for(size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); ++i) {
+
+        const test_cobs_vector_t* const v = &vectors[i];
+        uint8_t enc[COBS_ENCODED_MAX(8)];
+        uint8_t dec[8];
+        size_t declen = 0;
+
+        TEST_CHECK(cobs_encode(v->raw, v->rawlen, enc) == v->enclen);
+        TEST_CHECK(memcmp(enc, v->enc, v->enclen) == 0);
+        TEST_CHECK(cobs_decode(v->enc, v->enclen, dec, &declen));
+        TEST_CHECK(declen == v->rawlen);
+        TEST_CHECK(v->rawlen == 0 || memcmp(dec, v->raw, v->rawlen) == 0);
+
+    }
+
+}
+
+static void test_cobs_full_blocks(void) {
+
+    uint8_t raw[256];
+    uint8_t enc[COBS_ENCODED_MAX(256)];
+    uint8_t dec[COBS_ENCODED_MAX(256)];
+    size_t declen = 0;
+
+    //01..fe is one full block, with no empty block after it
+    for(size_t i = 0; i < 254; ++i) {
+        raw[i] = (uint8_t)(i + 1);
+    }
+
+    TEST_CHECK(cobs_encode(raw, 254, enc) == 255);
+    TEST_CHECK(enc[0] == 0xff);
+    TEST_CHECK(memcmp(enc + 1, raw, 254) == 0);
+    TEST_CHECK(cobs_decode(enc, 255, dec, &declen) && declen == 254);
+    TEST_CHECK(memcmp(dec, raw, 254) == 0);
+
+    //00 01..fe
+    memmove(raw + 1, raw, 254);
+    raw[0] = 0;
+
+    TEST_CHECK(cobs_encode(raw, 255, enc) == 256);
+    TEST_CHECK(enc[0] == 0x01 && enc[1] == 0xff);
+    TEST_CHECK(cobs_decode(enc, 256, dec, &declen) && declen == 255);
+    TEST_CHECK(memcmp(dec, raw, 255) == 0);
+
+    //01..ff spills one byte into a second block
+    for(size_t i = 0; i < 255; ++i) {
+        raw[i] = (uint8_t)(i + 1);
+    }
+
+    TEST_CHECK(cobs_encode(raw, 255, enc) == 257);
+    TEST_CHECK(enc[0] == 0xff && enc[255] == 0x02 && enc[256] == 0xff);
+    TEST_CHECK(cobs_decode(enc, 257, dec, &declen) && declen == 255);
+    TEST_CHECK(memcmp(dec, raw, 255) == 0);
+
+}
+
+static void test_cobs_round_trip(void) {
+
+    static uint8_t raw[TEST_COBS_MAX_LEN];
+    static uint8_t enc[COBS_ENCODED_MAX(TEST_COBS_MAX_LEN)];
+    static uint8_t dec[COBS_ENCODED_MAX(TEST_COBS_MAX_LEN)];
+
+    //from mostly zeroes to no zeroes at all
+    for(uint32_t zeroes = 0; zeroes <= 256; zeroes += 32) {
+        for(size_t len = 0; len <= TEST_COBS_MAX_LEN; len += 7) {
+
+            size_t declen = 0;
+
+            for(size_t i = 0; i < len; ++i) {
+                const uint8_t b = test_cobs_rand();
+                raw[i] = test_cobs_rand() < zeroes ? 0 : (uint8_t)(b | 1);
+            }
+
+            const size_t enclen = cobs_encode(raw, len, enc);
+
+            TEST_CHECK(enclen <= COBS_ENCODED_MAX(len));
+            TEST_CHECK(!test_cobs_has_zero(enc, enclen));
+            TEST_CHECK(cobs_decode(enc, enclen, dec, &declen));
+            TEST_CHECK(declen == len);
+            TEST_CHECK(memcmp(dec, raw, len) == 0);
+
+        }
+    }
+
+}
+
+static void test_cobs_malformed(void) {
+
+    //a zero is a delimiter, never part of a frame
+    static const uint8_t zero[] = { 0x03, 0x11, 0x00, 0x01 };
+
+    //a block which runs past the end of the frame
+    static const uint8_t overrun[] = { 0x05, 0x11, 0x22 };
+
+    uint8_t dec[8];
+    size_t declen;
+
+    TEST_CHECK(!cobs_decode(zero, sizeof(zero), dec, &declen));
+    TEST_CHECK(!cobs_decode(zero + 2, 1, dec, &declen));
+    TEST_CHECK(!cobs_decode(overrun, sizeof(overrun), dec, &declen));
+
+}
+
+int main(void) {
+
+    test_cobs_vectors();
+    test_cobs_full_blocks();
+    test_cobs_round_trip();
+    test_cobs_malformed();
+
+    return test_result("cobs");
+
+}
@@ -0,0 +1,233 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for the delta/varint codec
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/codec.h"
+#include "test.h"
+
+#define TEST_CODEC_LEN 500u
+#define TEST_CODEC_INDEX_LEN TEST_CODEC_LEN
+
+static const size_t TEST_CODEC_BLOCKS[] = { 1, 7, 64, TEST_CODEC_LEN };
+
+static uint32_t test_codec_seed = 1;
+
+static uint32_t test_codec_rand(void) {
+    test_codec_seed = (test_codec_seed * 1103515245u) + 12345u;
+    return test_codec_seed >> 8;
+}
+
+/**
+ * A slowly changing 24 bit value, like a load cell's, with full
+ * scale jumps between the extremes of int32_t near the end
+ */
+static void test_codec_fill(
+    int32_t* const arr,
+    const size_t len) {
+
+        int32_t v = -367539;
+
+        for(size_t i = 0; i < len; ++i) {
+            v += (int32_t)(test_codec_rand() % 401u) - 200;
+            arr[i] = v;
+        }
+
+        arr[len - 5] = INT32_MIN;
+        arr[len - 4] = INT32_MAX;
+        arr[len - 3] = INT32_MIN;
+        arr[len - 2] = 0;
+        arr[len - 1] = -1;
+
+}
+
+static void test_codec_zigzag(void) {
+
+    static const int32_t values[] = { 0, -1, 1, -2, 2, INT32_MAX, INT32_MIN };
+    static const uint32_t mapped[] = { 0, 1, 2, 3, 4, 0xfffffffeu, 0xffffffffu };
+
+    for(size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        TEST_CHECK(codec_zigzag(values[i]) == mapped[i]);
+        TEST_CHECK(codec_unzigzag(mapped[i]) == values[i]);
+    }
+
+}
+
+static void test_codec_round_trip(void) {
+
+    static int32_t arr[TEST_CODEC_LEN];
+    static int32_t out[TEST_CODEC_LEN];
+    static uint8_t buff[CODEC_ENCODED_MAX(TEST_CODEC_LEN)];
+
+    test_codec_fill(arr, TEST_CODEC_LEN);
+
+    for(size_t k = 0; k < sizeof(TEST_CODEC_BLOCKS) / sizeof(TEST_CODEC_BLOCKS[0]); ++k) {
+
+        codec_encoder_t enc;
+        codec_decoder_t dec;
+
+        codec_encoder_init(&enc, buff, sizeof(buff), TEST_CODEC_BLOCKS[k], NULL, 0);
+
+        TEST_CHECK(codec_encoder_add_all(&enc, arr, TEST_CODEC_LEN) == TEST_CODEC_LEN);
+        TEST_CHECK(codec_encoder_get_count(&enc) == TEST_CODEC_LEN);
+        TEST_CHECK(codec_encoder_get_len(&enc) <= CODEC_ENCODED_MAX(TEST_CODEC_LEN));
+
+        codec_decoder_init(&dec, buff, codec_encoder_get_len(&enc), TEST_CODEC_BLOCKS[k]);
+
+        TEST_CHECK(codec_decoder_read(&dec, out, TEST_CODEC_LEN) == TEST_CODEC_LEN);
+        TEST_CHECK(memcmp(out, arr, sizeof(arr)) == 0);
+
+        //nothing follows the last value
+        int32_t v;
+        TEST_CHECK(!codec_decoder_next(&dec, &v));
+
+    }
+
+}
+
+static void test_codec_compresses(void) {
+
+    static int32_t arr[TEST_CODEC_LEN];
+    static uint8_t buff[CODEC_ENCODED_MAX(TEST_CODEC_LEN)];
+
+    codec_encoder_t enc;
+
+    //differences of up to 200 counts take 2 bytes; checkpoints
+    //of a 24 bit value take up to 4
+    test_codec_fill(arr, TEST_CODEC_LEN);
+    codec_encoder_init(&enc, buff, sizeof(buff), 64, NULL, 0);
+    codec_encoder_add_all(&enc, arr, TEST_CODEC_LEN - 5);
+
+    TEST_CHECK(codec_encoder_get_len(&enc) <= (TEST_CODEC_LEN - 5) * 2 + 8 * 2);
+
+}
+
+static void test_codec_full_buffer(void) {
+
+    static int32_t arr[TEST_CODEC_LEN];
+    static int32_t out[TEST_CODEC_LEN];
+    uint8_t buff[101];
+
+    codec_encoder_t enc;
+    codec_decoder_t dec;
+
+    test_codec_fill(arr, TEST_CODEC_LEN);
+    codec_encoder_init(&enc, buff, sizeof(buff), 16, NULL, 0);
+
+    //values are added until one does not fit, and that one is not
+    //partly written
+    const size_t n = codec_encoder_add_all(&enc, arr, TEST_CODEC_LEN);
+    const size_t len = codec_encoder_get_len(&enc);
+
+    TEST_CHECK(n > 0 && n < TEST_CODEC_LEN);
+    TEST_CHECK(codec_encoder_get_count(&enc) == n);
+    TEST_CHECK(len <= sizeof(buff));
+    TEST_CHECK(!codec_encoder_add(&enc, arr[n]));
+    TEST_CHECK(codec_encoder_get_len(&enc) == len);
+
+    codec_decoder_init(&dec, buff, len, 16);
+
+    TEST_CHECK(codec_decoder_read(&dec, out, TEST_CODEC_LEN) == n);
+    TEST_CHECK(memcmp(out, arr, n * sizeof(int32_t)) == 0);
+
+}
+
+static void test_codec_seek(void) {
+
+    static int32_t arr[TEST_CODEC_LEN];
+    static uint8_t buff[CODEC_ENCODED_MAX(TEST_CODEC_LEN)];
+    static uint32_t index[TEST_CODEC_INDEX_LEN];
+
+    test_codec_fill(arr, TEST_CODEC_LEN);
+
+    for(size_t k = 0; k < sizeof(TEST_CODEC_BLOCKS) / sizeof(TEST_CODEC_BLOCKS[0]); ++k) {
+
+        const size_t block = TEST_CODEC_BLOCKS[k];
+        const size_t blocks = (TEST_CODEC_LEN + block - 1) / block;
+        codec_encoder_t enc;
+        codec_decoder_t dec;
+
+        codec_encoder_init(&enc, buff, sizeof(buff), block, index, TEST_CODEC_INDEX_LEN);
+        codec_encoder_add_all(&enc, arr, TEST_CODEC_LEN);
+        codec_decoder_init(&dec, buff, codec_encoder_get_len(&enc), block);
+
+        //backwards, so every seek moves to an earlier value, both with
+        //the block offsets and without them
+        for(size_t n = TEST_CODEC_LEN; n > 0; --n) {
+
+            int32_t v = 0;
+
+            TEST_CHECK(codec_decoder_seek(&dec, index, blocks, n - 1));
+            TEST_CHECK(codec_decoder_next(&dec, &v) && v == arr[n - 1]);
+
+            if(n % 37 == 0) {
+                TEST_CHECK(codec_decoder_seek(&dec, NULL, 0, n - 1));
+                TEST_CHECK(codec_decoder_next(&dec, &v) && v == arr[n - 1]);
+            }
+
+        }
+
+        TEST_CHECK(!codec_decoder_seek(&dec, index, blocks, TEST_CODEC_LEN));
+
+    }
+
+}
+
+static void test_codec_malformed(void) {
+
+    //a value cut short, and a value longer than any encoded value
+    static const uint8_t truncated[] = { 0x02, 0x80, 0x80 };
+    static const uint8_t overlong[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+
+    codec_decoder_t dec;
+    int32_t v;
+
+    codec_decoder_init(&dec, truncated, sizeof(truncated), 8);
+
+    TEST_CHECK(codec_decoder_next(&dec, &v) && v == 1);
+    TEST_CHECK(!codec_decoder_next(&dec, &v));
+
+    codec_decoder_init(&dec, overlong, sizeof(overlong), 8);
+
+    TEST_CHECK(!codec_decoder_next(&dec, &v));
+
+}
+
+int main(void) {
+
+    test_codec_zigzag();
+    test_codec_round_trip();
+    test_codec_compresses();
+    test_codec_full_buffer();
+    test_codec_seek();
+    test_codec_malformed();
+
+    return test_result("codec");
+
+}
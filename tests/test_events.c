@@ -0,0 +1,263 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for weight event subscriptions
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/mass.h"
+#include "../include/scale.h"
+#include "../include/scale_events.h"
+#include "../include/sim_scale_adaptor.h"
+#include "test.h"
+
+#define TEST_EVENTS_MAX 16u
+
+/**
+ * Raw counts for a weight in grams on the test scale, which reads
+ * lower as the load increases
+ */
+#define TEST_EVENTS_RAW(sc, g) ((int32_t)((sc)->offset + ((g) * (sc)->ref_unit)))
+
+typedef struct {
+    size_t count;
+    scale_event_type_t types[TEST_EVENTS_MAX];
+    double grams[TEST_EVENTS_MAX];
+} test_events_log_t;
+
+static void test_events_record(
+    const scale_event_type_t ev,
+    const mass_t* const m,
+    void* const data) {
+
+        test_events_log_t* const log = (test_events_log_t*)data;
+
+        if(log->count < TEST_EVENTS_MAX) {
+            log->types[log->count] = ev;
+            mass_get_value(m, &log->grams[log->count]);
+        }
+
+        ++log->count;
+
+}
+
+static void test_events_scale(
+    scale_t* const sc,
+    sim_scale_adaptor_t* const sim) {
+
+        sim_scale_adaptor_config_t cfg;
+
+        sim_scale_adaptor_get_default_config(&cfg);
+        sim_scale_adaptor_init(sim, &cfg);
+        scale_init(sc, sim_scale_adaptor_get_base(sim), mass_g, -100, 1000);
+
+}
+
+static void test_events_feed(
+    scale_events_t* const evs,
+    const double* const grams,
+    const size_t len) {
+
+        for(size_t i = 0; i < len; ++i) {
+            scale_events_feed(evs, TEST_EVENTS_RAW(evs->_sc, grams[i]));
+        }
+
+}
+
+static void test_events_threshold(void) {
+
+    //rises at 10g once two samples in a row are there, and falls
+    //below 9g once two samples in a row are there
+    static const double grams[] = {
+        0, 10.5, 9.5, 10.5, 10.5, 12, 9.5, 9.5, 8.9, 9.5, 8.9, 8.9, 0
+    };
+
+    sim_scale_adaptor_t sim;
+    scale_t sc;
+    scale_events_t evs;
+    test_events_log_t log = { 0 };
+    mass_t level;
+    mass_t hyst;
+
+    test_events_scale(&sc, &sim);
+    scale_events_init(&evs, &sc);
+    mass_init(&level, mass_g, 10);
+    mass_init(&hyst, mass_g, 1);
+
+    TEST_CHECK(scale_events_subscribe_threshold(&evs, &level, &hyst, 2, test_events_record, &log));
+
+    test_events_feed(&evs, grams, sizeof(grams) / sizeof(grams[0]));
+
+    TEST_CHECK(log.count == 2);
+    TEST_CHECK(log.types[0] == scale_event_rise);
+    TEST_CHECK_NEAR(log.grams[0], 10.5, 1e-9);
+    TEST_CHECK(log.types[1] == scale_event_fall);
+    TEST_CHECK_NEAR(log.grams[1], 8.9, 1e-9);
+
+    //levels are relative to the offset when each sample is fed, so
+    //zeroing with 50g on the scale moves the threshold to 60g
+    sc.offset = TEST_EVENTS_RAW(&sc, 50);
+    log.count = 0;
+
+    scale_events_feed(&evs, TEST_EVENTS_RAW(&sc, 10.5));
+    scale_events_feed(&evs, TEST_EVENTS_RAW(&sc, 10.5));
+
+    TEST_CHECK(log.count == 1);
+    TEST_CHECK(log.types[0] == scale_event_rise);
+    TEST_CHECK_NEAR(log.grams[0], 10.5, 1e-9);
+
+}
+
+static void test_events_primed_without_event(void) {
+
+    //a load already above the threshold sets the state, so the
+    //first event is the fall rather than a rise
+    static const double grams[] = { 20, 20, 20, 5, 20 };
+
+    sim_scale_adaptor_t sim;
+    scale_t sc;
+    scale_events_t evs;
+    test_events_log_t log = { 0 };
+    mass_t level;
+    mass_t hyst;
+
+    test_events_scale(&sc, &sim);
+    scale_events_init(&evs, &sc);
+    mass_init(&level, mass_g, 10);
+    mass_init(&hyst, mass_g, 1);
+
+    scale_events_subscribe_threshold(&evs, &level, &hyst, 0, test_events_record, &log);
+    test_events_feed(&evs, grams, sizeof(grams) / sizeof(grams[0]));
+
+    TEST_CHECK(log.count == 2);
+    TEST_CHECK(log.types[0] == scale_event_fall);
+    TEST_CHECK(log.types[1] == scale_event_rise);
+
+}
+
+static void test_events_band(void) {
+
+    //enters [5g, 8g] and leaves [4g, 9g]
+    static const double grams[] = { 0, 4.5, 6, 8.5, 4.1, 9.5, 7, 3.9 };
+    static const scale_event_type_t expect[] = {
+        scale_event_enter, scale_event_exit, scale_event_enter, scale_event_exit
+    };
+    static const double expect_grams[] = { 6, 9.5, 7, 3.9 };
+
+    sim_scale_adaptor_t sim;
+    scale_t sc;
+    scale_events_t evs;
+    test_events_log_t log = { 0 };
+    mass_t lo;
+    mass_t hi;
+    mass_t hyst;
+
+    test_events_scale(&sc, &sim);
+    scale_events_init(&evs, &sc);
+    mass_init(&lo, mass_g, 5);
+    mass_init(&hi, mass_g, 8);
+    mass_init(&hyst, mass_g, 1);
+
+    TEST_CHECK(scale_events_subscribe_band(&evs, &lo, &hi, &hyst, 1, test_events_record, &log));
+
+    test_events_feed(&evs, grams, sizeof(grams) / sizeof(grams[0]));
+
+    TEST_CHECK(log.count == 4);
+
+    for(size_t i = 0; i < 4 && i < log.count; ++i) {
+        TEST_CHECK(log.types[i] == expect[i]);
+        TEST_CHECK_NEAR(log.grams[i], expect_grams[i], 1e-9);
+    }
+
+}
+
+static void test_events_delta(void) {
+
+    //changes of 3g or more from the last event, in either direction
+    static const double grams[] = { 0, 2, 3, 1, 0.5, -0.5, 2.4, 2.5 };
+    static const double expect_grams[] = { 3, -0.5, 2.5 };
+
+    sim_scale_adaptor_t sim;
+    scale_t sc;
+    scale_events_t evs;
+    test_events_log_t log = { 0 };
+    mass_t delta;
+
+    test_events_scale(&sc, &sim);
+    scale_events_init(&evs, &sc);
+    mass_init(&delta, mass_g, 3);
+
+    TEST_CHECK(scale_events_subscribe_delta(&evs, &delta, 1, test_events_record, &log));
+
+    test_events_feed(&evs, grams, sizeof(grams) / sizeof(grams[0]));
+
+    TEST_CHECK(log.count == 3);
+
+    for(size_t i = 0; i < 3 && i < log.count; ++i) {
+        TEST_CHECK(log.types[i] == scale_event_delta);
+        TEST_CHECK_NEAR(log.grams[i], expect_grams[i], 1e-9);
+    }
+
+}
+
+static void test_events_full(void) {
+
+    sim_scale_adaptor_t sim;
+    scale_t sc;
+    scale_events_t evs;
+    test_events_log_t log = { 0 };
+    mass_t delta;
+
+    test_events_scale(&sc, &sim);
+    scale_events_init(&evs, &sc);
+    mass_init(&delta, mass_g, 1);
+
+    for(size_t i = 0; i < SCALE_EVENTS_MAX_SUBS; ++i) {
+        TEST_CHECK(scale_events_subscribe_delta(&evs, &delta, 1, test_events_record, &log));
+    }
+
+    TEST_CHECK(!scale_events_subscribe_delta(&evs, &delta, 1, test_events_record, &log));
+
+    //every subscription sees every sample
+    const int32_t raw[] = { TEST_EVENTS_RAW(&sc, 0), TEST_EVENTS_RAW(&sc, 2) };
+
+    scale_events_feed_all(&evs, raw, 2);
+
+    TEST_CHECK(log.count == SCALE_EVENTS_MAX_SUBS);
+
+}
+
+int main(void) {
+
+    test_events_threshold();
+    test_events_primed_without_event();
+    test_events_band();
+    test_events_delta();
+    test_events_full();
+
+    return test_result("events");
+
+}
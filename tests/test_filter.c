@@ -0,0 +1,194 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for the mains notch filter
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/filter.h"
+#include "test.h"
+
+#define TEST_FILTER_LEN 40u
+
+static const double TEST_FILTER_PI = 3.14159265358979323846;
+static const int32_t TEST_FILTER_DC = 100000;
+
+/**
+ * A constant load with mains interference as it appears after being
+ * aliased by the sample rate
+ */
+static void test_filter_fill(
+    int32_t* const arr,
+    const size_t len,
+    const uint sps,
+    const filter_mains_t mains) {
+
+        for(size_t i = 0; i < len; ++i) {
+            const double w = (2.0 * TEST_FILTER_PI * (int)mains * (double)i) / sps;
+            arr[i] = TEST_FILTER_DC + (int32_t)lround(5000.0 * sin(w + 0.3));
+        }
+
+}
+
+static void test_filter_removes_mains(void) {
+
+    static const uint sps[] = { 80, 80, 320 };
+    static const filter_mains_t mains[] = { filter_mains_50, filter_mains_60, filter_mains_50 };
+
+    for(size_t k = 0; k < sizeof(sps) / sizeof(sps[0]); ++k) {
+
+        filter_notch_t f;
+        int32_t arr[TEST_FILTER_LEN];
+
+        filter_notch_init(&f, sps[k], mains[k]);
+        test_filter_fill(arr, TEST_FILTER_LEN, sps[k], mains[k]);
+
+        TEST_CHECK(filter_notch_is_enabled(&f));
+        TEST_CHECK(filter_notch_apply(&f, arr, TEST_FILTER_LEN) ==
+            TEST_FILTER_LEN - FILTER_NOTCH_DELAY);
+
+        //the interference was rounded to whole counts, and the filter
+        //gain above DC amplifies that rounding by up to a few counts
+        for(size_t i = 0; i < TEST_FILTER_LEN - FILTER_NOTCH_DELAY; ++i) {
+            TEST_CHECK_NEAR(arr[i], TEST_FILTER_DC, 3);
+        }
+
+    }
+
+}
+
+static void test_filter_unity_dc_gain(void) {
+
+    filter_notch_t f;
+    int32_t arr[TEST_FILTER_LEN];
+
+    filter_notch_init(&f, 80, filter_mains_50);
+
+    for(size_t i = 0; i < TEST_FILTER_LEN; ++i) {
+        arr[i] = -8388608;
+    }
+
+    const size_t n = filter_notch_apply(&f, arr, TEST_FILTER_LEN);
+
+    for(size_t i = 0; i < n; ++i) {
+        TEST_CHECK(arr[i] == -8388608);
+    }
+
+}
+
+static void test_filter_disabled_near_dc(void) {
+
+    //50Hz at 10 SPS aliases to DC, which the HX711 already rejects
+    filter_notch_t f;
+    int32_t arr[TEST_FILTER_LEN];
+    int32_t orig[TEST_FILTER_LEN];
+
+    filter_notch_init(&f, 10, filter_mains_50);
+    test_filter_fill(arr, TEST_FILTER_LEN, 10, filter_mains_50);
+    memcpy(orig, arr, sizeof(arr));
+
+    TEST_CHECK(!filter_notch_is_enabled(&f));
+    TEST_CHECK(filter_notch_apply(&f, arr, TEST_FILTER_LEN) == TEST_FILTER_LEN);
+    TEST_CHECK(memcmp(arr, orig, sizeof(arr)) == 0);
+
+}
+
+static void test_filter_too_short(void) {
+
+    filter_notch_t f;
+    int32_t arr[] = { 1, 2 };
+
+    filter_notch_init(&f, 80, filter_mains_50);
+
+    TEST_CHECK(filter_notch_apply(&f, arr, FILTER_NOTCH_DELAY) == FILTER_NOTCH_DELAY);
+    TEST_CHECK(arr[0] == 1 && arr[1] == 2);
+
+}
+
+static void test_filter_stream_matches_whole(void) {
+
+    //filtering a stream in parts of every length, including parts
+    //shorter than the delay, gives the same values as filtering it
+    //in one go
+    static const size_t parts[] = { 1, 2, 3, 7, 13 };
+
+    filter_notch_t f;
+    int32_t whole[TEST_FILTER_LEN];
+
+    filter_notch_init(&f, 80, filter_mains_60);
+    test_filter_fill(whole, TEST_FILTER_LEN, 80, filter_mains_60);
+
+    for(size_t i = 0; i < TEST_FILTER_LEN; ++i) {
+        whole[i] += (int32_t)(i * 37);
+    }
+
+    int32_t raw[TEST_FILTER_LEN];
+    memcpy(raw, whole, sizeof(raw));
+
+    const size_t expect = filter_notch_apply(&f, whole, TEST_FILTER_LEN);
+
+    for(size_t k = 0; k < sizeof(parts) / sizeof(parts[0]); ++k) {
+
+        int32_t arr[TEST_FILTER_LEN];
+        int32_t out[TEST_FILTER_LEN];
+        filter_notch_state_t st;
+        size_t total = 0;
+
+        memcpy(arr, raw, sizeof(arr));
+        filter_notch_state_init(&st);
+
+        for(size_t i = 0; i < TEST_FILTER_LEN; i += parts[k]) {
+
+            const size_t len = TEST_FILTER_LEN - i < parts[k]
+                ? TEST_FILTER_LEN - i
+                : parts[k];
+
+            const size_t n = filter_notch_apply_stream(&f, &st, arr + i, len);
+
+            memcpy(out + total, arr + i, n * sizeof(int32_t));
+            total += n;
+
+        }
+
+        TEST_CHECK(total == expect);
+        TEST_CHECK(memcmp(out, whole, expect * sizeof(int32_t)) == 0);
+
+    }
+
+}
+
+int main(void) {
+
+    test_filter_removes_mains();
+    test_filter_unity_dc_gain();
+    test_filter_disabled_near_dc();
+    test_filter_too_short();
+    test_filter_stream_matches_whole();
+
+    return test_result("filter");
+
+}
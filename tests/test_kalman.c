@@ -0,0 +1,203 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for the adaptive Kalman filter
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/kalman.h"
+#include "test.h"
+
+#define TEST_KALMAN_LEN 200u
+
+static uint32_t test_kalman_seed = 1;
+
+/**
+ * Repeatable noise uniformly distributed in [-20, 20] counts
+ */
+static int32_t test_kalman_noise(void) {
+    test_kalman_seed = (test_kalman_seed * 1103515245u) + 12345u;
+    return (int32_t)((test_kalman_seed >> 16) % 41u) - 20;
+}
+
+static void test_kalman_seeds_from_first_value(void) {
+
+    kalman_t kf;
+
+    kalman_init(&kf, KALMAN_DEFAULT_R, KALMAN_DEFAULT_Q);
+    kalman_update(&kf, -123456);
+
+    TEST_CHECK_NEAR(kf._x, -123456, 0);
+
+    //a reset discards the estimate, however settled it was
+    for(size_t i = 0; i < TEST_KALMAN_LEN; ++i) {
+        kalman_update(&kf, 1000 + test_kalman_noise());
+    }
+
+    kalman_reset(&kf);
+    kalman_update(&kf, 5000000);
+
+    TEST_CHECK_NEAR(kf._x, 5000000, 0);
+
+}
+
+static void test_kalman_converges_on_static_load(void) {
+
+    kalman_t kf;
+
+    kalman_init(&kf, KALMAN_DEFAULT_R, KALMAN_DEFAULT_Q);
+
+    for(size_t i = 0; i < TEST_KALMAN_LEN; ++i) {
+        kalman_update(&kf, 1000 + test_kalman_noise());
+    }
+
+    TEST_CHECK_NEAR(kf._x, 1000, 5);
+    TEST_CHECK(kf._p < kf.r / 10);
+    TEST_CHECK_NEAR(kf._q, kf.q_min, 1e-9);
+
+}
+
+static void test_kalman_jumps_to_new_load(void) {
+
+    kalman_t kf;
+
+    kalman_init(&kf, KALMAN_DEFAULT_R, KALMAN_DEFAULT_Q);
+
+    for(size_t i = 0; i < TEST_KALMAN_LEN; ++i) {
+        kalman_update(&kf, 1000 + test_kalman_noise());
+    }
+
+    //a step far outside the noise is held off until it is clearly
+    //not a spike, then followed at once rather than averaged in over
+    //many values
+    for(unsigned i = 1; i < KALMAN_STEP_COUNT; ++i) {
+        kalman_update(&kf, 51000 + test_kalman_noise());
+    }
+
+    TEST_CHECK_NEAR(kf._x, 1000, 5);
+
+    kalman_update(&kf, 51000 + test_kalman_noise());
+
+    TEST_CHECK_NEAR(kf._x, 51000, 20);
+
+    for(size_t i = 0; i < TEST_KALMAN_LEN; ++i) {
+        kalman_update(&kf, 51000 + test_kalman_noise());
+    }
+
+    TEST_CHECK_NEAR(kf._x, 51000, 5);
+
+}
+
+static void test_kalman_rejects_spikes(void) {
+
+    kalman_t kf;
+
+    kalman_init(&kf, KALMAN_DEFAULT_R, KALMAN_DEFAULT_Q);
+
+    for(size_t i = 0; i < TEST_KALMAN_LEN; ++i) {
+        kalman_update(&kf, 1000 + test_kalman_noise());
+    }
+
+    const double before = kf._x;
+
+    //a single full scale spike leaves the estimate alone
+    kalman_update(&kf, 0x7fffff);
+
+    TEST_CHECK_NEAR(kf._x, before, 0);
+
+    kalman_update(&kf, 1000 + test_kalman_noise());
+
+    TEST_CHECK_NEAR(kf._x, 1000, 5);
+
+    //as do spikes which alternate in sign, however many there are
+    for(unsigned i = 0; i < KALMAN_STEP_COUNT * 2; ++i) {
+        kalman_update(&kf, i % 2 == 0 ? 0x7fffff : -0x800000);
+    }
+
+    TEST_CHECK_NEAR(kf._x, 1000, 5);
+
+}
+
+static void test_kalman_follows_creep(void) {
+
+    kalman_t kf;
+
+    kalman_init(&kf, KALMAN_DEFAULT_R, KALMAN_DEFAULT_Q);
+
+    for(size_t i = 0; i < TEST_KALMAN_LEN; ++i) {
+        kalman_update(&kf, 1000 + test_kalman_noise());
+    }
+
+    //a drift within the gate raises the process noise so the
+    //estimate keeps up rather than lagging ever further behind
+    int32_t load = 1000;
+
+    for(size_t i = 0; i < TEST_KALMAN_LEN; ++i) {
+        load += 30;
+        kalman_update(&kf, load + test_kalman_noise());
+    }
+
+    TEST_CHECK(kf._q > kf.q_min);
+    TEST_CHECK_NEAR(kf._x, load, 100);
+
+}
+
+static void test_kalman_update_all(void) {
+
+    int32_t arr[TEST_KALMAN_LEN];
+    kalman_t a;
+    kalman_t b;
+    double est;
+
+    for(size_t i = 0; i < TEST_KALMAN_LEN; ++i) {
+        arr[i] = (i < TEST_KALMAN_LEN / 2 ? -70000 : 20000) + test_kalman_noise();
+    }
+
+    kalman_init(&a, KALMAN_DEFAULT_R, KALMAN_DEFAULT_Q);
+    kalman_init(&b, KALMAN_DEFAULT_R, KALMAN_DEFAULT_Q);
+
+    for(size_t i = 0; i < TEST_KALMAN_LEN; ++i) {
+        kalman_update(&a, arr[i]);
+    }
+
+    kalman_update_all(&b, arr, TEST_KALMAN_LEN, &est);
+
+    TEST_CHECK_NEAR(est, a._x, 0);
+    TEST_CHECK_NEAR(est, 20000, 5);
+
+}
+
+int main(void) {
+
+    test_kalman_seeds_from_first_value();
+    test_kalman_converges_on_static_load();
+    test_kalman_jumps_to_new_load();
+    test_kalman_rejects_spikes();
+    test_kalman_follows_creep();
+    test_kalman_update_all();
+
+    return test_result("kalman");
+
+}
@@ -0,0 +1,187 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for the peak/valley hold and triggered capture
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/peak.h"
+#include "test.h"
+
+#define TEST_PEAK_CAPTURE 8u
+#define TEST_PEAK_PRE 3u
+#define TEST_PEAK_LEVEL 100
+
+/**
+ * Feeds a rising ramp of len samples 10us apart, with a spike of
+ * 150 at index spike
+ */
+static void test_peak_feed_ramp(
+    peak_t* const pk,
+    const size_t len,
+    const size_t spike) {
+
+        for(size_t i = 0; i < len; ++i) {
+            peak_feed(pk, i == spike ? 150 : (int32_t)i, (uint32_t)(i * 10));
+        }
+
+}
+
+static void test_peak_hold(void) {
+
+    static const int32_t values[] = { 5, -3, 12, 12, -3, 7, -8388608, 8388607, 0 };
+
+    peak_t pk;
+    peak_sample_t s;
+
+    peak_init(&pk);
+
+    TEST_CHECK(!peak_get_max(&pk, &s));
+    TEST_CHECK(!peak_get_min(&pk, &s));
+
+    for(size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        peak_feed(&pk, values[i], (uint32_t)(1000 + i));
+    }
+
+    TEST_CHECK(peak_get_max(&pk, &s));
+    TEST_CHECK(s.value == 8388607 && s.time == 1007);
+    TEST_CHECK(peak_get_min(&pk, &s));
+    TEST_CHECK(s.value == -8388608 && s.time == 1006);
+
+    //a tie keeps the time the value was first reached
+    peak_reset(&pk);
+    peak_feed(&pk, 4, 1);
+    peak_feed(&pk, 9, 2);
+    peak_feed(&pk, 9, 3);
+    peak_feed(&pk, 4, 4);
+
+    TEST_CHECK(peak_get_max(&pk, &s));
+    TEST_CHECK(s.value == 9 && s.time == 2);
+    TEST_CHECK(peak_get_min(&pk, &s));
+    TEST_CHECK(s.value == 4 && s.time == 1);
+
+}
+
+static void test_peak_capture_around_trigger(void) {
+
+    peak_t pk;
+    peak_sample_t buff[TEST_PEAK_CAPTURE];
+    peak_sample_t out[TEST_PEAK_CAPTURE];
+    size_t trigger = 0;
+
+    peak_init(&pk);
+    peak_capture_arm(&pk, buff, TEST_PEAK_CAPTURE, TEST_PEAK_PRE, TEST_PEAK_LEVEL, peak_trigger_above);
+
+    //not done until every sample after the trigger is recorded
+    test_peak_feed_ramp(&pk, 14, 10);
+
+    TEST_CHECK(!peak_capture_is_done(&pk));
+    TEST_CHECK(peak_capture_read(&pk, out, TEST_PEAK_CAPTURE, &trigger) == 0);
+
+    //samples after the capture is done are held but not captured
+    for(size_t i = 14; i < 30; ++i) {
+        peak_feed(&pk, (int32_t)i, (uint32_t)(i * 10));
+    }
+
+    TEST_CHECK(peak_capture_is_done(&pk));
+    TEST_CHECK(peak_capture_read(&pk, out, TEST_PEAK_CAPTURE, &trigger) == TEST_PEAK_CAPTURE);
+    TEST_CHECK(trigger == TEST_PEAK_PRE);
+
+    //7 8 9 150 11 12 13 14
+    for(size_t i = 0; i < TEST_PEAK_CAPTURE; ++i) {
+        const size_t n = 7 + i;
+        TEST_CHECK(out[i].value == (n == 10 ? 150 : (int32_t)n));
+        TEST_CHECK(out[i].time == n * 10);
+    }
+
+    peak_sample_t s;
+
+    TEST_CHECK(peak_get_max(&pk, &s));
+    TEST_CHECK(s.value == 150 && s.time == 100);
+
+}
+
+static void test_peak_capture_early_trigger(void) {
+
+    peak_t pk;
+    peak_sample_t buff[TEST_PEAK_CAPTURE];
+    peak_sample_t out[TEST_PEAK_CAPTURE];
+    size_t trigger = TEST_PEAK_CAPTURE;
+
+    //a trigger on the second sample leaves room for only one sample
+    //before it, so the rest of the capture follows it
+    peak_init(&pk);
+    peak_capture_arm(&pk, buff, TEST_PEAK_CAPTURE, TEST_PEAK_PRE, TEST_PEAK_LEVEL, peak_trigger_above);
+    test_peak_feed_ramp(&pk, 20, 1);
+
+    TEST_CHECK(peak_capture_read(&pk, out, TEST_PEAK_CAPTURE, &trigger) == TEST_PEAK_CAPTURE);
+    TEST_CHECK(trigger == 1);
+    TEST_CHECK(out[0].value == 0);
+    TEST_CHECK(out[1].value == 150);
+    TEST_CHECK(out[TEST_PEAK_CAPTURE - 1].value == TEST_PEAK_CAPTURE - 1);
+
+    //a trigger on the first sample has nothing before it
+    peak_capture_arm(&pk, buff, TEST_PEAK_CAPTURE, TEST_PEAK_PRE, TEST_PEAK_LEVEL, peak_trigger_above);
+    test_peak_feed_ramp(&pk, 20, 0);
+
+    TEST_CHECK(peak_capture_read(&pk, out, TEST_PEAK_CAPTURE, &trigger) == TEST_PEAK_CAPTURE);
+    TEST_CHECK(trigger == 0);
+    TEST_CHECK(out[0].value == 150 && out[0].time == 0);
+
+}
+
+static void test_peak_capture_below(void) {
+
+    peak_t pk;
+    peak_sample_t buff[TEST_PEAK_CAPTURE];
+    peak_sample_t out[TEST_PEAK_CAPTURE];
+    size_t trigger = 0;
+
+    peak_init(&pk);
+    peak_capture_arm(&pk, buff, TEST_PEAK_CAPTURE, TEST_PEAK_PRE, -TEST_PEAK_LEVEL, peak_trigger_below);
+
+    //a falling ramp reaches the level exactly at the 101st sample
+    for(int32_t i = 0; i < 200; ++i) {
+        peak_feed(&pk, -i, (uint32_t)i);
+    }
+
+    TEST_CHECK(peak_capture_read(&pk, out, TEST_PEAK_CAPTURE, &trigger) == TEST_PEAK_CAPTURE);
+    TEST_CHECK(trigger == TEST_PEAK_PRE);
+    TEST_CHECK(out[trigger].value == -TEST_PEAK_LEVEL);
+    TEST_CHECK(out[0].value == -TEST_PEAK_LEVEL + (int32_t)TEST_PEAK_PRE);
+
+}
+
+int main(void) {
+
+    test_peak_hold();
+    test_peak_capture_around_trigger();
+    test_peak_capture_early_trigger();
+    test_peak_capture_below();
+
+    return test_result("peak");
+
+}
@@ -0,0 +1,200 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for the P-squared streaming quantile estimator
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/quantile.h"
+#include "test.h"
+
+#define TEST_QUANTILE_LEN 10000u
+
+/**
+ * Largest error allowed in an estimate, as 0.5% of the range of the
+ * random values
+ */
+static const double TEST_QUANTILE_TOLERANCE = (1 << 24) / 200.0;
+
+static const double TEST_QUANTILE_PS[] = { 0.1, 0.25, 0.5, 0.75, 0.9 };
+
+static uint32_t test_quantile_seed = 1;
+
+/**
+ * Repeatable values uniformly distributed in [-2^23, 2^23)
+ */
+static int32_t test_quantile_rand(void) {
+    test_quantile_seed = (test_quantile_seed * 1103515245u) + 12345u;
+    return (int32_t)(test_quantile_seed >> 8) - (1 << 23);
+}
+
+static int test_quantile_compare(
+    const void* a,
+    const void* b) {
+
+        const int32_t va = *(const int32_t*)a;
+        const int32_t vb = *(const int32_t*)b;
+
+        return (va < vb) ? -1 : (va > vb);
+
+}
+
+/**
+ * The p-quantile of len values, interpolated between the two
+ * closest as quantile_p2_get does while it holds every value
+ */
+static double test_quantile_exact(
+    const int32_t* const arr,
+    const size_t len,
+    const double p) {
+
+        static int32_t sorted[TEST_QUANTILE_LEN];
+
+        memcpy(sorted, arr, len * sizeof(int32_t));
+        qsort(sorted, len, sizeof(int32_t), test_quantile_compare);
+
+        const double pos = p * (double)(len - 1);
+        const size_t lo = (size_t)pos;
+        const size_t hi = lo + 1 < len ? lo + 1 : lo;
+
+        return sorted[lo] + ((pos - (double)lo) * (sorted[hi] - sorted[lo]));
+
+}
+
+static void test_quantile_empty(void) {
+
+    quantile_p2_t qe;
+    double val;
+
+    quantile_p2_init(&qe, 0.5);
+
+    TEST_CHECK(!quantile_p2_get(&qe, &val));
+
+}
+
+static void test_quantile_exact_while_few(void) {
+
+    static const int32_t vals[] = { 40, -10, 30, 20, 0 };
+
+    //up to and including the value which fills the last marker
+    for(size_t n = 1; n <= QUANTILE_P2_MARKERS; ++n) {
+        for(size_t i = 0; i < sizeof(TEST_QUANTILE_PS) / sizeof(TEST_QUANTILE_PS[0]); ++i) {
+
+            quantile_p2_t qe;
+            double val;
+
+            quantile_p2_init(&qe, TEST_QUANTILE_PS[i]);
+            quantile_p2_add_all(&qe, vals, n);
+
+            TEST_CHECK(quantile_p2_get(&qe, &val));
+            TEST_CHECK_NEAR(val, test_quantile_exact(vals, n, TEST_QUANTILE_PS[i]), 1e-9);
+
+        }
+    }
+
+}
+
+static void test_quantile_estimates_stream(void) {
+
+    static int32_t uniform[TEST_QUANTILE_LEN];
+    static int32_t normal[TEST_QUANTILE_LEN];
+
+    //the sum of four uniform values is close to normally distributed
+    for(size_t i = 0; i < TEST_QUANTILE_LEN; ++i) {
+        uniform[i] = test_quantile_rand();
+        normal[i] = (test_quantile_rand() / 4) + (test_quantile_rand() / 4) +
+            (test_quantile_rand() / 4) + (test_quantile_rand() / 4);
+    }
+
+    for(size_t i = 0; i < sizeof(TEST_QUANTILE_PS) / sizeof(TEST_QUANTILE_PS[0]); ++i) {
+
+        quantile_p2_t qe;
+        double val;
+
+        quantile_p2_init(&qe, TEST_QUANTILE_PS[i]);
+        quantile_p2_add_all(&qe, uniform, TEST_QUANTILE_LEN);
+        TEST_CHECK(quantile_p2_get(&qe, &val));
+        TEST_CHECK_NEAR(val, test_quantile_exact(uniform, TEST_QUANTILE_LEN, TEST_QUANTILE_PS[i]), TEST_QUANTILE_TOLERANCE);
+
+        quantile_p2_init(&qe, TEST_QUANTILE_PS[i]);
+        quantile_p2_add_all(&qe, normal, TEST_QUANTILE_LEN);
+        TEST_CHECK(quantile_p2_get(&qe, &val));
+        TEST_CHECK_NEAR(val, test_quantile_exact(normal, TEST_QUANTILE_LEN, TEST_QUANTILE_PS[i]), TEST_QUANTILE_TOLERANCE);
+
+    }
+
+}
+
+static void test_quantile_ordered_and_constant(void) {
+
+    static int32_t arr[TEST_QUANTILE_LEN];
+
+    quantile_p2_t qe;
+    double val;
+
+    //values already in order are the worst case for the markers
+    for(size_t i = 0; i < TEST_QUANTILE_LEN; ++i) {
+        arr[i] = (int32_t)i;
+    }
+
+    quantile_p2_init(&qe, 0.5);
+    quantile_p2_add_all(&qe, arr, TEST_QUANTILE_LEN);
+    TEST_CHECK(quantile_p2_get(&qe, &val));
+    TEST_CHECK_NEAR(val, (TEST_QUANTILE_LEN - 1) / 2.0, TEST_QUANTILE_LEN / 100.0);
+
+    quantile_p2_init(&qe, 0.5);
+
+    for(size_t i = TEST_QUANTILE_LEN; i > 0; --i) {
+        quantile_p2_add(&qe, arr[i - 1]);
+    }
+
+    TEST_CHECK(quantile_p2_get(&qe, &val));
+    TEST_CHECK_NEAR(val, (TEST_QUANTILE_LEN - 1) / 2.0, TEST_QUANTILE_LEN / 100.0);
+
+    //a constant load gives exactly that load
+    quantile_p2_init(&qe, 0.9);
+
+    for(size_t i = 0; i < TEST_QUANTILE_LEN; ++i) {
+        quantile_p2_add(&qe, -314159);
+    }
+
+    TEST_CHECK(quantile_p2_get(&qe, &val));
+    TEST_CHECK_NEAR(val, -314159, 0);
+
+}
+
+int main(void) {
+
+    test_quantile_empty();
+    test_quantile_exact_while_few();
+    test_quantile_estimates_stream();
+    test_quantile_ordered_and_constant();
+
+    return test_result("quantile");
+
+}
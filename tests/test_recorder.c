@@ -0,0 +1,375 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for the flash recorder, over flash held in memory
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/flash_adaptor.h"
+#include "../include/mass.h"
+#include "../include/recorder.h"
+#include "../tools/mem_flash_adaptor.h"
+#include "test.h"
+
+#define TEST_RECORDER_SECTOR 4096u
+#define TEST_RECORDER_SIZE (4u * TEST_RECORDER_SECTOR)
+#define TEST_RECORDER_WINDOW 20u
+#define TEST_RECORDER_PERIOD 12500u //us
+#define TEST_RECORDER_LONG (RECORDER_MAX_SAMPLES + 45u)
+
+typedef struct {
+    uint8_t mem[TEST_RECORDER_SIZE];
+    mem_flash_adaptor_t mfa;
+    flash_adaptor_t* fa;
+    recorder_t rec;
+} test_recorder_t;
+
+/**
+ * What a reader found: whether every sample followed on from the one
+ * before, the first and last sample, and the number of weights
+ */
+typedef struct {
+    bool ordered;
+    size_t samples;
+    int32_t first;
+    int32_t last;
+    size_t weights;
+} test_recorder_summary_t;
+
+static recorder_record_t test_recorder_record;
+
+static void test_recorder_init(
+    test_recorder_t* const t) {
+
+        //a new part is fully erased
+        memset(t->mem, 0xff, sizeof(t->mem));
+        mem_flash_adaptor_init(&t->mfa, t->mem, TEST_RECORDER_SIZE, TEST_RECORDER_SECTOR, RECORDER_PAGE_LEN);
+        t->fa = mem_flash_adaptor_get_base(&t->mfa);
+
+        TEST_CHECK(recorder_init(&t->rec, t->fa));
+
+}
+
+/**
+ * Records a window of consecutive values starting at *next, and a
+ * weight of that many grams, then services the recorder once
+ */
+static bool test_recorder_window(
+    test_recorder_t* const t,
+    int32_t* const next) {
+
+        int32_t values[TEST_RECORDER_WINDOW];
+        uint32_t times[TEST_RECORDER_WINDOW];
+        mass_t m;
+
+        for(size_t i = 0; i < TEST_RECORDER_WINDOW; ++i) {
+            values[i] = *next;
+            times[i] = (uint32_t)*next * TEST_RECORDER_PERIOD;
+            ++*next;
+        }
+
+        mass_init(&m, mass_g, values[0]);
+
+        return recorder_add_samples(&t->rec, values, times, TEST_RECORDER_WINDOW) &&
+            recorder_add_weight(&t->rec, times[0], values[0], &m) &&
+            recorder_service(&t->rec);
+
+}
+
+static bool test_recorder_drain(
+    test_recorder_t* const t) {
+
+        //the partly filled page can only be queued once the other
+        //page has been programmed
+        while(!recorder_flush(&t->rec) || !recorder_is_idle(&t->rec)) {
+            if(!recorder_service(&t->rec)) {
+                return false;
+            }
+        }
+
+        return true;
+
+}
+
+static void test_recorder_summarise(
+    flash_adaptor_t* const fa,
+    test_recorder_summary_t* const s) {
+
+        recorder_reader_t rd;
+        recorder_record_t* const r = &test_recorder_record;
+
+        memset(s, 0, sizeof(*s));
+        s->ordered = recorder_reader_init(&rd, fa);
+
+        while(recorder_reader_next(&rd, r)) {
+
+            if(r->type == recorder_record_weight) {
+                ++s->weights;
+                continue;
+            }
+
+            for(size_t i = 0; i < r->count; ++i) {
+
+                if(s->samples == 0) {
+                    s->first = r->values[i];
+                }
+                else if(r->values[i] != s->last + 1) {
+                    s->ordered = false;
+                }
+
+                s->last = r->values[i];
+                ++s->samples;
+
+            }
+
+        }
+
+}
+
+static void test_recorder_empty(void) {
+
+    static test_recorder_t t;
+    test_recorder_summary_t s;
+
+    test_recorder_init(&t);
+    test_recorder_summarise(t.fa, &s);
+
+    TEST_CHECK(s.ordered);
+    TEST_CHECK(s.samples == 0 && s.weights == 0);
+
+}
+
+static void test_recorder_round_trip(void) {
+
+    static test_recorder_t t;
+    static int32_t values[TEST_RECORDER_LONG];
+    static uint32_t times[TEST_RECORDER_LONG];
+
+    recorder_reader_t rd;
+    recorder_record_t* const r = &test_recorder_record;
+    mass_t m;
+
+    test_recorder_init(&t);
+
+    //more values than fit in one record or one page, but few enough
+    //to fit in the two page buffers, including the extremes of int32_t
+    for(size_t i = 0; i < TEST_RECORDER_LONG; ++i) {
+        values[i] = (int32_t)(i % 60u) - 500;
+        times[i] = 4294967000u + (uint32_t)(i * TEST_RECORDER_PERIOD);
+    }
+
+    values[1] = INT32_MIN;
+    values[2] = INT32_MAX;
+
+    mass_init(&m, mass_kg, -1.25);
+
+    TEST_CHECK(recorder_add_samples(&t.rec, values, times, TEST_RECORDER_LONG));
+    TEST_CHECK(recorder_add_weight(&t.rec, 123456, -314.5, &m));
+    TEST_CHECK(test_recorder_drain(&t));
+    TEST_CHECK(recorder_get_dropped(&t.rec) == 0);
+
+    TEST_CHECK(recorder_reader_init(&rd, t.fa));
+
+    //each record carries the time of its first value, and the period
+    //holds across the wrap of the 32 bit time
+    size_t n = 0;
+
+    while(n < TEST_RECORDER_LONG && recorder_reader_next(&rd, r)) {
+
+        TEST_CHECK(r->type == recorder_record_samples);
+        TEST_CHECK(r->count > 0 && n + r->count <= TEST_RECORDER_LONG);
+        TEST_CHECK(r->time == times[n]);
+        TEST_CHECK(r->count == 1 || r->period == TEST_RECORDER_PERIOD);
+        TEST_CHECK(memcmp(r->values, values + n, r->count * sizeof(int32_t)) == 0);
+
+        n += r->count;
+
+    }
+
+    TEST_CHECK(n == TEST_RECORDER_LONG);
+
+    TEST_CHECK(recorder_reader_next(&rd, r));
+    TEST_CHECK(r->type == recorder_record_weight);
+    TEST_CHECK(r->time == 123456);
+    TEST_CHECK_NEAR(r->raw, -314.5, 0);
+    TEST_CHECK_NEAR(r->ug, m.ug, 0);
+    TEST_CHECK(r->unit == mass_kg);
+
+    TEST_CHECK(!recorder_reader_next(&rd, r));
+
+}
+
+static void test_recorder_wraps(void) {
+
+    static test_recorder_t t;
+    test_recorder_summary_t s;
+    int32_t next = 0;
+    bool ok = true;
+
+    test_recorder_init(&t);
+
+    //many times what the flash holds, so it wraps several times
+    for(size_t w = 0; w < 1000; ++w) {
+        ok = ok && test_recorder_window(&t, &next);
+    }
+
+    TEST_CHECK(ok);
+    TEST_CHECK(test_recorder_drain(&t));
+    TEST_CHECK(recorder_get_dropped(&t.rec) == 0);
+
+    //the newest values are kept, oldest first, with none missing
+    test_recorder_summarise(t.fa, &s);
+
+    TEST_CHECK(s.ordered);
+    TEST_CHECK(s.last == next - 1);
+    TEST_CHECK(s.first > 0);
+    TEST_CHECK(s.samples > TEST_RECORDER_SIZE / 4);
+    TEST_CHECK(s.weights >= s.samples / TEST_RECORDER_WINDOW);
+
+    //a reset carries on the same recording after its newest page
+    TEST_CHECK(recorder_init(&t.rec, t.fa));
+
+    for(size_t w = 0; w < 10; ++w) {
+        ok = ok && test_recorder_window(&t, &next);
+    }
+
+    TEST_CHECK(ok);
+    TEST_CHECK(test_recorder_drain(&t));
+
+    test_recorder_summarise(t.fa, &s);
+
+    TEST_CHECK(s.ordered);
+    TEST_CHECK(s.last == next - 1);
+
+}
+
+static void test_recorder_drops(void) {
+
+    static test_recorder_t t;
+    int32_t next = 0;
+    size_t added = 0;
+
+    test_recorder_init(&t);
+
+    //without servicing, both page buffers fill and then records are
+    //dropped and counted rather than overwriting what is waiting
+    for(size_t w = 0; w < 100; ++w) {
+
+        int32_t values[TEST_RECORDER_WINDOW];
+
+        for(size_t i = 0; i < TEST_RECORDER_WINDOW; ++i) {
+            values[i] = next++;
+        }
+
+        if(recorder_add_samples(&t.rec, values, NULL, TEST_RECORDER_WINDOW)) {
+            added += TEST_RECORDER_WINDOW;
+        }
+
+    }
+
+    TEST_CHECK(added > 0);
+    TEST_CHECK(recorder_get_dropped(&t.rec) > 0);
+    TEST_CHECK(recorder_get_dropped(&t.rec) <= (uint32_t)(100 * TEST_RECORDER_WINDOW - added));
+    TEST_CHECK(!recorder_is_idle(&t.rec));
+
+    //once serviced there is room again
+    TEST_CHECK(test_recorder_drain(&t));
+    TEST_CHECK(test_recorder_window(&t, &next));
+
+}
+
+typedef struct {
+    uint8_t buff[TEST_RECORDER_SIZE];
+    size_t len;
+} test_recorder_dump_t;
+
+static bool test_recorder_dump_write(
+    const uint8_t* const buff,
+    const size_t len,
+    void* const data) {
+
+        test_recorder_dump_t* const d = (test_recorder_dump_t*)data;
+
+        if(len > sizeof(d->buff) - d->len) {
+            return false;
+        }
+
+        memcpy(d->buff + d->len, buff, len);
+        d->len += len;
+
+        return true;
+
+}
+
+static void test_recorder_dump(void) {
+
+    static test_recorder_t t;
+    static test_recorder_dump_t d;
+
+    mem_flash_adaptor_t mfa;
+    test_recorder_summary_t orig;
+    test_recorder_summary_t dumped;
+    int32_t next = 0;
+
+    test_recorder_init(&t);
+
+    for(size_t w = 0; w < 500; ++w) {
+        test_recorder_window(&t, &next);
+    }
+
+    TEST_CHECK(test_recorder_drain(&t));
+
+    //the dump is whole pages, and reads back as the same records
+    d.len = 0;
+
+    TEST_CHECK(recorder_dump(t.fa, test_recorder_dump_write, &d));
+    TEST_CHECK(d.len > 0 && d.len % RECORDER_PAGE_LEN == 0);
+
+    mem_flash_adaptor_init(&mfa, d.buff, (uint32_t)d.len, RECORDER_PAGE_LEN, RECORDER_PAGE_LEN);
+
+    test_recorder_summarise(t.fa, &orig);
+    test_recorder_summarise(mem_flash_adaptor_get_base(&mfa), &dumped);
+
+    TEST_CHECK(dumped.ordered);
+    TEST_CHECK(dumped.samples == orig.samples);
+    TEST_CHECK(dumped.first == orig.first && dumped.last == orig.last);
+    TEST_CHECK(dumped.weights == orig.weights);
+
+}
+
+int main(void) {
+
+    test_recorder_empty();
+    test_recorder_round_trip();
+    test_recorder_wraps();
+    test_recorder_drops();
+    test_recorder_dump();
+
+    return test_result("recorder");
+
+}
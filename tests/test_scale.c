@@ -0,0 +1,366 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Unit tests for reading a scale, against a simulated scale
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "../include/mass.h"
+#include "../include/scale.h"
+#include "../include/sim_scale_adaptor.h"
+#include "test.h"
+
+#define TEST_SCALE_BUFFLEN 64u
+
+static int32_t test_scale_buff[TEST_SCALE_BUFFLEN];
+
+/**
+ * A scale reading a simulated 100g load with the given period, served
+ * at once or in real time
+ */
+static void test_scale_init(
+    scale_t* const sc,
+    sim_scale_adaptor_t* const sim,
+    const uint period,
+    const bool realtime) {
+
+        static const sim_step_t steps[] = {
+            { .time = 0, .load = 100 }
+        };
+
+        sim_scale_adaptor_config_t cfg;
+
+        sim_scale_adaptor_get_default_config(&cfg);
+        cfg.period = period;
+        cfg.realtime = realtime;
+        cfg.steps = steps;
+        cfg.steps_len = 1;
+        cfg.settle = 0;
+
+        sim_scale_adaptor_init(sim, &cfg);
+        scale_init(sc, sim_scale_adaptor_get_base(sim), mass_g, (int32_t)cfg.ref_unit, cfg.offset);
+
+}
+
+static void test_scale_init_drops(
+    scale_t* const sc,
+    sim_scale_adaptor_t* const sim,
+    const uint period,
+    const double drop_p) {
+
+        sim_scale_adaptor_config_t cfg;
+
+        sim_scale_adaptor_get_default_config(&cfg);
+        cfg.period = period;
+        cfg.realtime = true;
+        cfg.drop_p = drop_p;
+
+        sim_scale_adaptor_init(sim, &cfg);
+        scale_init(sc, sim_scale_adaptor_get_base(sim), mass_g, (int32_t)cfg.ref_unit, cfg.offset);
+
+}
+
+static void test_scale_options(
+    scale_options_t* const opt) {
+
+        scale_options_get_default(opt);
+        opt->buffer = test_scale_buff;
+        opt->bufflen = TEST_SCALE_BUFFLEN;
+
+}
+
+static void test_scale_timed_read_stops_early(void) {
+
+    static const uint period = 10000; //us
+    static const uint timeout = 35000; //us
+
+    scale_t sc;
+    sim_scale_adaptor_t sim;
+    scale_options_t opt;
+    size_t len;
+
+    test_scale_init(&sc, &sim, period, true);
+    test_scale_options(&opt);
+    opt.strat = strategy_type_time;
+    opt.timeout = timeout;
+
+    //once the next value cannot arrive before the end of the window,
+    //the read stops rather than waiting out the rest of it
+    const uint64_t start = time_us_64();
+    const bool ok = scale_acquire(&sc, &opt, &len);
+    const uint64_t elapsed = time_us_64() - start;
+
+    TEST_CHECK(ok);
+    TEST_CHECK(len >= 3 && len <= 4);
+    TEST_CHECK(elapsed < timeout - (period / 4));
+
+}
+
+static void test_scale_latest(void) {
+
+    scale_t sc;
+    sim_scale_adaptor_t sim;
+    scale_options_t opt;
+    scale_reading_t r;
+    mass_t m;
+    double g;
+
+    test_scale_init(&sc, &sim, 12500, false);
+    test_scale_options(&opt);
+
+    //nothing has been published yet
+    TEST_CHECK(!scale_get_latest(&sc, &r));
+
+    TEST_CHECK(scale_weight(&sc, &m, &opt));
+    TEST_CHECK(scale_get_latest(&sc, &r));
+
+    mass_get_value(&r.mass, &g);
+    TEST_CHECK_NEAR(g, 100, 1);
+    TEST_CHECK(mass_eq(&r.mass, &m));
+    TEST_CHECK(!r.stable);
+
+    //a reading within stable_tol of the last is stable; one beyond is not
+    const double raw = r.raw;
+    const double near = raw + sc.stable_tol;
+    const double far = raw + (2.0 * sc.stable_tol) + 1;
+
+    scale_publish(&sc, &near, &m);
+    TEST_CHECK(scale_get_latest(&sc, &r));
+    TEST_CHECK(r.stable);
+    TEST_CHECK_NEAR(r.raw, near, 0);
+
+    scale_publish(&sc, &far, &m);
+    TEST_CHECK(scale_get_latest(&sc, &r));
+    TEST_CHECK(!r.stable);
+
+    //the sequence skips 0 when it wraps, so a reading stays published
+    sc._seq = UINT32_MAX - 1;
+    scale_publish(&sc, &raw, &m);
+    TEST_CHECK(sc._seq != 0);
+    TEST_CHECK(scale_get_latest(&sc, &r));
+    TEST_CHECK_NEAR(r.raw, raw, 0);
+
+    //a write which never finishes (eg. the publisher was preempted by
+    //the reader) makes the reader give up rather than spin forever
+    const uint32_t seq = sc._seq;
+    sc._seq = seq + 1;
+
+    const uint64_t start = time_us_64();
+
+    TEST_CHECK(!scale_get_latest(&sc, &r));
+    TEST_CHECK(time_us_64() - start >= SCALE_LATEST_TIMEOUT);
+
+    sc._seq = seq;
+    TEST_CHECK(scale_get_latest(&sc, &r));
+
+}
+
+/**
+ * Reads a window from a real time scale which drops values, and checks
+ * every gap in the timestamps is counted as missed and left out of the
+ * period estimate
+ */
+static void test_scale_timing(void) {
+
+    static const uint period = 1000; //us
+    static const size_t samples = 40;
+
+    scale_t sc;
+    sim_scale_adaptor_t sim;
+    scale_options_t opt;
+    scale_timing_t timing;
+    uint32_t ts[TEST_SCALE_BUFFLEN];
+    size_t len;
+    uint32_t gaps = 0;
+
+    test_scale_init_drops(&sc, &sim, period, 0.2);
+    test_scale_options(&opt);
+    opt.strat = strategy_type_samples;
+    opt.samples = samples;
+    opt.timestamps = ts;
+
+    TEST_CHECK(scale_acquire(&sc, &opt, &len));
+    TEST_CHECK(len == samples);
+
+    for(size_t i = 1; i < len; ++i) {
+        const uint32_t delta = ts[i] - ts[i - 1];
+        TEST_CHECK(delta > 0 && delta % period == 0);
+        gaps += (delta / period) - 1;
+    }
+
+    scale_get_timing(&sc, &timing);
+
+    TEST_CHECK(timing.samples == samples);
+    TEST_CHECK(gaps > 0);
+    TEST_CHECK(timing.missed == gaps);
+    TEST_CHECK_NEAR(timing.period, period, period / 10.0);
+
+    scale_reset_timing(&sc);
+    scale_get_timing(&sc, &timing);
+
+    TEST_CHECK(timing.samples == 0);
+    TEST_CHECK(timing.missed == 0);
+    TEST_CHECK_NEAR(timing.period, 0, 0);
+    TEST_CHECK_NEAR(timing.jitter, 0, 0);
+
+    //without drops nothing is missed
+    test_scale_init_drops(&sc, &sim, period, 0);
+
+    TEST_CHECK(scale_acquire(&sc, &opt, &len));
+    scale_get_timing(&sc, &timing);
+
+    TEST_CHECK(timing.samples == samples);
+    TEST_CHECK(timing.missed == 0);
+    TEST_CHECK_NEAR(timing.period, period, period / 10.0);
+
+}
+
+static void test_scale_plan_rejects(void) {
+
+    scale_options_t opt;
+    scale_plan_t plan;
+
+    test_scale_options(&opt);
+    TEST_CHECK(scale_plan_init(&plan, &opt));
+
+    opt.buffer = NULL;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+
+    test_scale_options(&opt);
+    opt.bufflen = 0;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+
+    test_scale_options(&opt);
+    opt.samples = 0;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+
+    opt.samples = TEST_SCALE_BUFFLEN + 1;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+
+    //a quantile is estimated as values stream in, so is not limited to
+    //the buffer
+    opt.read = read_type_quantile;
+    TEST_CHECK(scale_plan_init(&plan, &opt));
+
+    test_scale_options(&opt);
+    opt.strat = strategy_type_time;
+    opt.timeout = 0;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+
+    opt.timeout = 1000;
+    TEST_CHECK(scale_plan_init(&plan, &opt));
+
+    test_scale_options(&opt);
+    opt.strat = (strategy_type_t)-1;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+
+    test_scale_options(&opt);
+    opt.read = (read_type_t)-1;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+
+    test_scale_options(&opt);
+    opt.read = read_type_trimmed_mean;
+    opt.trim = -0.1;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+    opt.trim = 0.5;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+    opt.trim = NAN;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+    opt.trim = 0;
+    TEST_CHECK(scale_plan_init(&plan, &opt));
+
+    test_scale_options(&opt);
+    opt.read = read_type_mad_mean;
+    opt.mad_k = 0;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+    opt.mad_k = NAN;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+    opt.mad_k = 3;
+    TEST_CHECK(scale_plan_init(&plan, &opt));
+
+    test_scale_options(&opt);
+    opt.read = read_type_quantile;
+    opt.quantile = -0.1;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+    opt.quantile = 1.1;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+    opt.quantile = NAN;
+    TEST_CHECK(!scale_plan_init(&plan, &opt));
+    opt.quantile = 1;
+    TEST_CHECK(scale_plan_init(&plan, &opt));
+
+}
+
+/**
+ * Weighs the simulated load through a plan for each read type
+ */
+static void test_scale_plan_reads(void) {
+
+    static const read_type_t reads[] = {
+        read_type_median,
+        read_type_average,
+        read_type_kalman,
+        read_type_trimmed_mean,
+        read_type_mad_mean,
+        read_type_quantile
+    };
+
+    scale_t sc;
+    sim_scale_adaptor_t sim;
+    scale_options_t opt;
+    scale_plan_t plan;
+    mass_t m;
+    double g;
+
+    for(size_t i = 0; i < sizeof(reads) / sizeof(reads[0]); ++i) {
+
+        test_scale_init(&sc, &sim, 12500, false);
+        test_scale_options(&opt);
+        opt.read = reads[i];
+        opt.samples = 32;
+
+        TEST_CHECK(scale_plan_init(&plan, &opt));
+        TEST_CHECK(scale_plan_weight(&sc, &plan, &m));
+
+        mass_get_value(&m, &g);
+        TEST_CHECK_NEAR(g, 100, 1);
+
+    }
+
+}
+
+int main(void) {
+
+    test_scale_timed_read_stops_early();
+    test_scale_latest();
+    test_scale_timing();
+    test_scale_plan_rejects();
+    test_scale_plan_reads();
+
+    return test_result("scale");
+
+}
@@ -0,0 +1,320 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for the cooperative scheduler, against a simulated scale
+ * serving values in real time
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "../include/mass.h"
+#include "../include/scale.h"
+#include "../include/scale_events.h"
+#include "../include/scale_scheduler.h"
+#include "../include/sim_scale_adaptor.h"
+#include "test.h"
+
+#define TEST_SCHED_PERIOD 1000u //us
+#define TEST_SCHED_BUFFLEN 32u
+#define TEST_SCHED_WINDOWS 4u
+#define TEST_SCHED_SLOW 5000u //us; several periods
+
+typedef struct {
+    scale_options_t opt;
+    int32_t buff[TEST_SCHED_BUFFLEN];
+    uint32_t ts[TEST_SCHED_BUFFLEN];
+    size_t windows;
+    uint32_t firsts[TEST_SCHED_WINDOWS]; //capture time of each window's first value
+    uint32_t lens[TEST_SCHED_WINDOWS]; //values in each window
+    uint32_t samples; //scale's sample count at the end of the last window
+} test_sched_log_t;
+
+/**
+ * Logs the window, then takes longer than a sample period, as a
+ * callback which logs or transmits might
+ */
+static void test_sched_slow(
+    const size_t index,
+    scale_t* const sc,
+    const bool ok,
+    const mass_t* const m,
+    void* const data) {
+
+        (void)index;
+        (void)m;
+
+        test_sched_log_t* const log = (test_sched_log_t*)data;
+        scale_timing_t timing;
+
+        scale_get_timing(sc, &timing);
+
+        TEST_CHECK(ok);
+
+        if(log->windows < TEST_SCHED_WINDOWS) {
+            log->firsts[log->windows] = log->ts[0];
+            log->lens[log->windows] = timing.samples - log->samples;
+        }
+
+        log->samples = timing.samples;
+        ++log->windows;
+
+        sleep_us(TEST_SCHED_SLOW);
+
+}
+
+typedef struct {
+    size_t windows; //windows completed
+    size_t rises; //rise events raised
+    size_t windows_at_rise; //windows completed when the first rise was raised
+    double grams; //weight of the sample which raised the first rise
+} test_sched_events_log_t;
+
+static void test_sched_count_window(
+    const size_t index,
+    scale_t* const sc,
+    const bool ok,
+    const mass_t* const m,
+    void* const data) {
+
+        (void)index;
+        (void)sc;
+        (void)ok;
+        (void)m;
+
+        ++((test_sched_events_log_t*)data)->windows;
+
+}
+
+static void test_sched_record_rise(
+    const scale_event_type_t ev,
+    const mass_t* const m,
+    void* const data) {
+
+        test_sched_events_log_t* const log = (test_sched_events_log_t*)data;
+
+        if(ev != scale_event_rise) {
+            return;
+        }
+
+        if(log->rises++ == 0) {
+            log->windows_at_rise = log->windows;
+            mass_get_value(m, &log->grams);
+        }
+
+}
+
+static void test_sched_scale_steps(
+    scale_t* const sc,
+    sim_scale_adaptor_t* const sim,
+    const sim_step_t* const steps,
+    const size_t steps_len) {
+
+        sim_scale_adaptor_config_t cfg;
+
+        sim_scale_adaptor_get_default_config(&cfg);
+        cfg.period = TEST_SCHED_PERIOD;
+        cfg.realtime = true;
+        cfg.steps = steps;
+        cfg.steps_len = steps_len;
+        cfg.settle = 0;
+
+        sim_scale_adaptor_init(sim, &cfg);
+        scale_init(sc, sim_scale_adaptor_get_base(sim), mass_g, cfg.ref_unit, cfg.offset);
+
+}
+
+static void test_sched_scale(
+    scale_t* const sc,
+    sim_scale_adaptor_t* const sim) {
+
+        sim_scale_adaptor_config_t cfg;
+
+        sim_scale_adaptor_get_default_config(&cfg);
+        test_sched_scale_steps(sc, sim, cfg.steps, cfg.steps_len);
+
+}
+
+/**
+ * Polls until TEST_SCHED_WINDOWS windows complete, then checks each
+ * window began with the value after the last one in the window before
+ */
+static void test_sched_run(
+    test_sched_log_t* const log) {
+
+        scale_t sc;
+        sim_scale_adaptor_t sim;
+        scale_scheduler_t ss;
+
+        test_sched_scale(&sc, &sim);
+        scale_scheduler_init(&ss);
+
+        log->opt.buffer = log->buff;
+        log->opt.timestamps = log->ts;
+        log->opt.bufflen = TEST_SCHED_BUFFLEN;
+        log->windows = 0;
+        log->samples = 0;
+
+        TEST_CHECK(scale_scheduler_add(&ss, &sc, &log->opt, test_sched_slow, log, NULL));
+
+        const absolute_time_t give_up = make_timeout_time_ms(1000);
+
+        while(log->windows < TEST_SCHED_WINDOWS && !time_reached(give_up)) {
+            scale_scheduler_poll(&ss);
+        }
+
+        TEST_CHECK(log->windows == TEST_SCHED_WINDOWS);
+
+        for(size_t i = 1; i < TEST_SCHED_WINDOWS; ++i) {
+            TEST_CHECK(log->firsts[i] - log->firsts[i - 1] ==
+                log->lens[i - 1] * TEST_SCHED_PERIOD);
+        }
+
+        scale_timing_t timing;
+
+        scale_get_timing(&sc, &timing);
+
+        TEST_CHECK(timing.missed == 0);
+
+}
+
+static void test_sched_samples_keeps_values(void) {
+
+    test_sched_log_t log;
+
+    scale_options_get_default(&log.opt);
+    log.opt.strat = strategy_type_samples;
+    log.opt.samples = 10;
+
+    test_sched_run(&log);
+
+    for(size_t i = 0; i < TEST_SCHED_WINDOWS; ++i) {
+        TEST_CHECK(log.lens[i] == 10);
+    }
+
+}
+
+static void test_sched_time_keeps_values(void) {
+
+    test_sched_log_t log;
+
+    scale_options_get_default(&log.opt);
+    log.opt.strat = strategy_type_time;
+    log.opt.timeout = 8 * TEST_SCHED_PERIOD;
+
+    test_sched_run(&log);
+
+}
+
+static void test_sched_rejects_oversized_window(void) {
+
+    scale_t sc;
+    sim_scale_adaptor_t sim;
+    scale_scheduler_t ss;
+    test_sched_log_t log;
+
+    test_sched_scale(&sc, &sim);
+    scale_scheduler_init(&ss);
+
+    scale_options_get_default(&log.opt);
+    log.opt.strat = strategy_type_samples;
+    log.opt.buffer = log.buff;
+    log.opt.bufflen = TEST_SCHED_BUFFLEN;
+
+    log.opt.samples = TEST_SCHED_BUFFLEN + 1;
+    TEST_CHECK(!scale_scheduler_add(&ss, &sc, &log.opt, test_sched_slow, &log, NULL));
+
+    log.opt.samples = 0;
+    TEST_CHECK(!scale_scheduler_add(&ss, &sc, &log.opt, test_sched_slow, &log, NULL));
+
+    log.opt.samples = TEST_SCHED_BUFFLEN;
+    TEST_CHECK(scale_scheduler_add(&ss, &sc, &log.opt, test_sched_slow, &log, NULL));
+
+}
+
+/**
+ * Loads the scale part way through the first window and checks the
+ * threshold subscription is raised from the samples the scheduler takes,
+ * before the window they are in completes
+ */
+static void test_sched_feeds_events(void) {
+
+    static const sim_step_t steps[] = {
+        { 0, 0 },
+        { 10 * TEST_SCHED_PERIOD, 100 }
+    };
+
+    scale_t sc;
+    sim_scale_adaptor_t sim;
+    scale_scheduler_t ss;
+    scale_events_t evs;
+    scale_options_t opt;
+    int32_t buff[TEST_SCHED_BUFFLEN];
+    test_sched_events_log_t log = { 0 };
+    mass_t level;
+    mass_t hyst;
+
+    test_sched_scale_steps(&sc, &sim, steps, sizeof(steps) / sizeof(steps[0]));
+    scale_scheduler_init(&ss);
+
+    mass_init(&level, mass_g, 50);
+    mass_init(&hyst, mass_g, 5);
+
+    scale_events_init(&evs, &sc);
+    TEST_CHECK(scale_events_subscribe_threshold(&evs, &level, &hyst, 2,
+        test_sched_record_rise, &log));
+
+    scale_options_get_default(&opt);
+    opt.strat = strategy_type_samples;
+    opt.samples = 30;
+    opt.buffer = buff;
+    opt.bufflen = TEST_SCHED_BUFFLEN;
+
+    TEST_CHECK(scale_scheduler_add(&ss, &sc, &opt, test_sched_count_window, &log, NULL));
+    scale_scheduler_set_events(&ss, 0, &evs);
+
+    const absolute_time_t give_up = make_timeout_time_ms(1000);
+
+    while(log.windows < 1 && !time_reached(give_up)) {
+        scale_scheduler_poll(&ss);
+    }
+
+    TEST_CHECK(log.windows == 1);
+    TEST_CHECK(log.rises == 1);
+    TEST_CHECK(log.windows_at_rise == 0);
+    TEST_CHECK_NEAR(log.grams, 100, 5);
+
+}
+
+int main(void) {
+
+    test_sched_samples_keeps_values();
+    test_sched_time_keeps_values();
+    test_sched_rejects_oversized_window();
+    test_sched_feeds_events();
+
+    return test_result("scheduler");
+
+}
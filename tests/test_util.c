@@ -0,0 +1,365 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/**
+ * Unit tests for selection and the trimmed and MAD means
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/util.h"
+#include "test.h"
+
+#define TEST_UTIL_MAX_LEN 40u
+
+typedef enum {
+    test_util_random = 0,
+    test_util_sorted,
+    test_util_reversed,
+    test_util_equal,
+    test_util_few, //only a few distinct values
+    test_util_extremes, //INT32_MIN and INT32_MAX among others
+    test_util_pattern_count
+} test_util_pattern_t;
+
+static uint32_t test_util_seed = 1;
+
+static int32_t test_util_rand(void) {
+    test_util_seed = (test_util_seed * 1103515245u) + 12345u;
+    return (int32_t)(test_util_seed >> 8) - (1 << 23);
+}
+
+static void test_util_fill(
+    int32_t* const arr,
+    const size_t len,
+    const test_util_pattern_t pattern) {
+
+        for(size_t i = 0; i < len; ++i) {
+            switch(pattern) {
+                case test_util_random:
+                    arr[i] = test_util_rand();
+                    break;
+                case test_util_sorted:
+                    arr[i] = (int32_t)i - 10;
+                    break;
+                case test_util_reversed:
+                    arr[i] = 10 - (int32_t)i;
+                    break;
+                case test_util_equal:
+                    arr[i] = -7;
+                    break;
+                case test_util_few:
+                    arr[i] = (test_util_rand() & 3) - 1;
+                    break;
+                default:
+                    arr[i] = i % 3 == 0
+                        ? INT32_MIN
+                        : (i % 3 == 1 ? INT32_MAX : test_util_rand());
+                    break;
+            }
+        }
+
+}
+
+static uint32_t test_util_magnitude(
+    const int32_t v) {
+        return v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+}
+
+static int test_util_compare(
+    const void* a,
+    const void* b) {
+
+        const int32_t va = *(const int32_t*)a;
+        const int32_t vb = *(const int32_t*)b;
+
+        return (va < vb) ? -1 : (va > vb);
+
+}
+
+static int test_util_abs_compare(
+    const void* a,
+    const void* b) {
+
+        const uint32_t ma = test_util_magnitude(*(const int32_t*)a);
+        const uint32_t mb = test_util_magnitude(*(const int32_t*)b);
+
+        return (ma < mb) ? -1 : (ma > mb);
+
+}
+
+/**
+ * Whether arr holds the same values as orig, in any order
+ */
+static bool test_util_same_values(
+    const int32_t* const arr,
+    const int32_t* const orig,
+    const size_t len) {
+
+        int32_t a[TEST_UTIL_MAX_LEN];
+        int32_t b[TEST_UTIL_MAX_LEN];
+
+        memcpy(a, arr, len * sizeof(int32_t));
+        memcpy(b, orig, len * sizeof(int32_t));
+        qsort(a, len, sizeof(int32_t), test_util_compare);
+        qsort(b, len, sizeof(int32_t), test_util_compare);
+
+        return memcmp(a, b, len * sizeof(int32_t)) == 0;
+
+}
+
+/**
+ * Whether arr[k] is in its sorted place and arr is partitioned around it
+ */
+static bool test_util_is_selected(
+    const int32_t* const arr,
+    const int32_t* const sorted,
+    const size_t len,
+    const size_t k,
+    int (*compare)(const void*, const void*)) {
+
+        if(compare(&arr[k], &sorted[k]) != 0) {
+            return false;
+        }
+
+        for(size_t i = 0; i < len; ++i) {
+            const int c = compare(&arr[i], &arr[k]);
+            if((i < k && c > 0) || (i > k && c < 0)) {
+                return false;
+            }
+        }
+
+        return true;
+
+}
+
+static void test_util_select(void) {
+
+    for(int p = 0; p < test_util_pattern_count; ++p) {
+        for(size_t len = 1; len <= TEST_UTIL_MAX_LEN; ++len) {
+
+            int32_t orig[TEST_UTIL_MAX_LEN];
+            int32_t sorted[TEST_UTIL_MAX_LEN];
+            int32_t abs_sorted[TEST_UTIL_MAX_LEN];
+
+            test_util_fill(orig, len, (test_util_pattern_t)p);
+            memcpy(sorted, orig, sizeof(orig));
+            memcpy(abs_sorted, orig, sizeof(orig));
+            qsort(sorted, len, sizeof(int32_t), test_util_compare);
+            qsort(abs_sorted, len, sizeof(int32_t), test_util_abs_compare);
+
+            for(size_t k = 0; k < len; ++k) {
+
+                int32_t arr[TEST_UTIL_MAX_LEN];
+
+                memcpy(arr, orig, sizeof(orig));
+                util_select(arr, len, k);
+
+                TEST_CHECK(test_util_is_selected(arr, sorted, len, k, test_util_compare));
+                TEST_CHECK(test_util_same_values(arr, orig, len));
+
+                memcpy(arr, orig, sizeof(orig));
+                util__select(arr, len, k, true);
+
+                TEST_CHECK(test_util_is_selected(arr, abs_sorted, len, k, test_util_abs_compare));
+                TEST_CHECK(test_util_same_values(arr, orig, len));
+
+            }
+
+        }
+    }
+
+}
+
+static void test_util_select_pair(void) {
+
+    for(int p = 0; p < test_util_pattern_count; ++p) {
+        for(size_t len = 1; len <= TEST_UTIL_MAX_LEN; len += 3) {
+
+            int32_t orig[TEST_UTIL_MAX_LEN];
+            int32_t sorted[TEST_UTIL_MAX_LEN];
+
+            test_util_fill(orig, len, (test_util_pattern_t)p);
+            memcpy(sorted, orig, sizeof(orig));
+            qsort(sorted, len, sizeof(int32_t), test_util_compare);
+
+            for(size_t k1 = 0; k1 < len; ++k1) {
+                for(size_t k2 = k1; k2 < len; ++k2) {
+
+                    int32_t arr[TEST_UTIL_MAX_LEN];
+
+                    memcpy(arr, orig, sizeof(orig));
+                    util__select_pair(arr, len, k1, k2);
+
+                    TEST_CHECK(test_util_is_selected(arr, sorted, len, k1, test_util_compare));
+                    TEST_CHECK(test_util_is_selected(arr, sorted, len, k2, test_util_compare));
+                    TEST_CHECK(test_util_same_values(arr, orig, len));
+
+                }
+            }
+
+        }
+    }
+
+}
+
+static void test_util_stats(void) {
+
+    int32_t orig[TEST_UTIL_MAX_LEN];
+    int32_t arr[TEST_UTIL_MAX_LEN];
+    int32_t sorted[TEST_UTIL_MAX_LEN];
+    util_stats_t stats;
+
+    for(size_t len = 1; len <= TEST_UTIL_MAX_LEN; ++len) {
+        for(int p = 0; p <= test_util_pattern_count; ++p) {
+
+            //an extra pattern of values clustered far from zero, as
+            //samples from a loaded cell are
+            if(p == test_util_pattern_count) {
+                for(size_t i = 0; i < len; ++i) {
+                    orig[i] = 8000000 + (test_util_rand() & 0xff);
+                }
+            }
+            else {
+                test_util_fill(orig, len, (test_util_pattern_t)p);
+            }
+
+            //two-pass reference
+            long double total = 0;
+            long double squares = 0;
+
+            for(size_t i = 0; i < len; ++i) {
+                total += orig[i];
+            }
+
+            const long double mean = total / len;
+
+            for(size_t i = 0; i < len; ++i) {
+                squares += (orig[i] - mean) * (orig[i] - mean);
+            }
+
+            const double variance = len > 1 ? (double)(squares / (len - 1)) : 0;
+
+            memcpy(sorted, orig, len * sizeof(int32_t));
+            qsort(sorted, len, sizeof(int32_t), test_util_compare);
+
+            const double median = len % 2 == 0
+                ? ((double)sorted[len / 2 - 1] + sorted[len / 2]) / 2
+                : sorted[len / 2];
+
+            memcpy(arr, orig, len * sizeof(int32_t));
+            util_stats(arr, len, &stats);
+
+            TEST_CHECK(stats.len == len);
+            TEST_CHECK_NEAR(stats.mean, (double)mean, 1e-6);
+            TEST_CHECK_NEAR(stats.variance, variance, 1e-9 * fmax(1, variance));
+            TEST_CHECK(stats.min == sorted[0]);
+            TEST_CHECK(stats.max == sorted[len - 1]);
+            TEST_CHECK_NEAR(stats.median, median, 0);
+            TEST_CHECK(test_util_same_values(arr, orig, len));
+
+        }
+    }
+
+}
+
+static void test_util_trimmed_mean(void) {
+
+    static const int32_t vals[] = { 1, 2, 3, 4, 100, -100, 5, 6, 7, 8 };
+    static const size_t len = sizeof(vals) / sizeof(vals[0]);
+
+    int32_t arr[sizeof(vals) / sizeof(vals[0])];
+    double avg;
+
+    //10% from each end discards only the outliers
+    memcpy(arr, vals, sizeof(vals));
+    util_trimmed_mean(arr, len, 0.1, &avg);
+    TEST_CHECK_NEAR(avg, 4.5, 1e-9);
+    TEST_CHECK(test_util_same_values(arr, vals, len));
+
+    //no trim is the plain average
+    memcpy(arr, vals, sizeof(vals));
+    util_trimmed_mean(arr, len, 0, &avg);
+    TEST_CHECK_NEAR(avg, 3.6, 1e-9);
+
+    //the most that can be trimmed leaves the middle two
+    memcpy(arr, vals, sizeof(vals));
+    util_trimmed_mean(arr, len, 0.49, &avg);
+    TEST_CHECK_NEAR(avg, 4.5, 1e-9);
+
+    //at least one value is always kept
+    int32_t three[] = { 9, -3, 4 };
+    util_trimmed_mean(three, 3, 0.4, &avg);
+    TEST_CHECK_NEAR(avg, 4, 1e-9);
+
+    int32_t one[] = { -8388608 };
+    util_trimmed_mean(one, 1, 0.4, &avg);
+    TEST_CHECK_NEAR(avg, -8388608, 1e-9);
+
+}
+
+static void test_util_mad_mean(void) {
+
+    static const int32_t vals[] = { 10, 11, 9, 10, 12, 8, 10, 1000 };
+    static const size_t len = sizeof(vals) / sizeof(vals[0]);
+
+    int32_t arr[sizeof(vals) / sizeof(vals[0])];
+    double avg;
+
+    //the median is 10 and the MAD is 1, so only 1000 is discarded
+    memcpy(arr, vals, sizeof(vals));
+    util_mad_mean(arr, len, 3, &avg);
+    TEST_CHECK_NEAR(avg, 10, 1e-9);
+    TEST_CHECK(test_util_same_values(arr, vals, len));
+
+    //a wide enough limit keeps everything
+    memcpy(arr, vals, sizeof(vals));
+    util_mad_mean(arr, len, 1000, &avg);
+    TEST_CHECK_NEAR(avg, 1070.0 / 8, 1e-9);
+
+    //with no spread at all, only values equal to the median are kept
+    int32_t flat[] = { -5, -5, -5, 7, -5, -5 };
+    util_mad_mean(flat, 6, 3, &avg);
+    TEST_CHECK_NEAR(avg, -5, 1e-9);
+
+    //negative deviations are discarded as well as positive ones
+    int32_t low[] = { -1000000, 20, 21, 19, 20, 22, 18 };
+    util_mad_mean(low, 7, 3, &avg);
+    TEST_CHECK_NEAR(avg, 20, 1e-9);
+
+}
+
+int main(void) {
+
+    test_util_select();
+    test_util_select_pair();
+    test_util_stats();
+    test_util_trimmed_mean();
+    test_util_mad_mean();
+
+    return test_result("util");
+
+}
@@ -0,0 +1,67 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "../include/bytes.h"
+#include "../include/capture.h"
+#include "capture_writer.h"
+
+FILE* capture_create(
+    const char* const path,
+    const uint32_t period) {
+
+        FILE* const f = fopen(path, "wb");
+        uint8_t header[CAPTURE_HEADER_LEN] = {0};
+
+        if(f == NULL) {
+            return NULL;
+        }
+
+        bytes_put_u32(header, CAPTURE_MAGIC);
+        bytes_put_u16(header + 4, CAPTURE_VERSION);
+        bytes_put_u16(header + 6, sizeof(capture_sample_t));
+        bytes_put_u32(header + 8, period);
+
+        if(fwrite(header, 1, sizeof(header), f) != sizeof(header)) {
+            fclose(f);
+            return NULL;
+        }
+
+        return f;
+
+}
+
+bool capture_write(
+    FILE* const f,
+    const uint32_t time,
+    const int32_t value) {
+
+        uint8_t b[sizeof(capture_sample_t)];
+
+        bytes_put_u32(b, time);
+        bytes_put_u32(b + 4, (uint32_t)value);
+
+        return fwrite(b, 1, sizeof(b), f) == sizeof(b);
+
+}
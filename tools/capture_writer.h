@@ -0,0 +1,70 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CAPTURE_WRITER_H_5C07E2B8_A4D1_4F93_8E6B_2D19F0A7C345
+#define CAPTURE_WRITER_H_5C07E2B8_A4D1_4F93_8E6B_2D19F0A7C345
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Writes capture files for replay_scale_adaptor_t; see
+ * include/capture.h for the format
+ */
+
+/**
+ * @brief Creates a capture file at path and writes its header. period is
+ * the nominal time between values in us, or 0 if unknown. Returns NULL
+ * on failure.
+ * 
+ * @param path 
+ * @param period 
+ * @return FILE* 
+ */
+FILE* capture_create(
+    const char* const path,
+    const uint32_t period);
+
+/**
+ * @brief Appends a value and the time it was obtained
+ * 
+ * @param f 
+ * @param time us
+ * @param value 
+ * @return true 
+ * @return false 
+ */
+bool capture_write(
+    FILE* const f,
+    const uint32_t time,
+    const int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,212 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Measures the compression ratio and speed of the raw value codec.
+ * 
+ * Usage: codec_bench [file]
+ * 
+ * file holds little-endian int32 raw values, such as the value column
+ * of telemetry_decode's output converted to binary. Without a file,
+ * a simulated HX711 signal is used: a slowly drifting offset with
+ * noise of a few hundred counts and occasional load steps.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/codec.h"
+
+static const size_t BENCH_SIMULATED = 1u << 20;
+static const size_t BENCH_BLOCK = 256;
+static const double BENCH_MIN_SECONDS = 0.5;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t prng(uint32_t* const state) {
+    //xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static int32_t* simulate(
+    const size_t len) {
+
+        int32_t* const arr = malloc(len * sizeof(int32_t));
+        uint32_t state = 0x12345678u;
+        int32_t level = -367539;
+
+        if(arr == NULL) {
+            return NULL;
+        }
+
+        for(size_t i = 0; i < len; ++i) {
+
+            if(prng(&state) % 4000 == 0) {
+                level += (int32_t)(prng(&state) % 400000) - 200000;
+            }
+
+            //sum of uniforms for roughly gaussian noise
+            int32_t noise = 0;
+            for(int j = 0; j < 4; ++j) {
+                noise += (int32_t)(prng(&state) % 256) - 128;
+            }
+
+            arr[i] = (level + (int32_t)(i / 1000) + noise) & 0xffffff;
+
+            //24 bit two's complement
+            if(arr[i] & 0x800000) {
+                arr[i] -= 0x1000000;
+            }
+
+        }
+
+        return arr;
+
+}
+
+static int32_t* load(
+    const char* const path,
+    size_t* const len) {
+
+        FILE* const f = fopen(path, "rb");
+
+        if(f == NULL) {
+            return NULL;
+        }
+
+        fseek(f, 0, SEEK_END);
+        const long size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+
+        *len = size > 0 ? (size_t)size / 4 : 0;
+
+        int32_t* const arr = malloc(*len * sizeof(int32_t) + 1);
+        uint8_t b[4];
+
+        for(size_t i = 0; arr != NULL && i < *len; ++i) {
+            if(fread(b, 1, 4, f) != 4) {
+                *len = i;
+                break;
+            }
+            arr[i] = (int32_t)(b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24));
+        }
+
+        fclose(f);
+
+        return arr;
+
+}
+
+int main(int argc, char** argv) {
+
+    size_t len = BENCH_SIMULATED;
+    int32_t* const arr = argc > 1 ? load(argv[1], &len) : simulate(len);
+
+    if(arr == NULL || len == 0) {
+        fprintf(stderr, "no values to encode\n");
+        return EXIT_FAILURE;
+    }
+
+    const size_t indexlen = len / BENCH_BLOCK + 1;
+    uint8_t* const buff = malloc(CODEC_ENCODED_MAX(len));
+    int32_t* const out = malloc(len * sizeof(int32_t));
+    uint32_t* const index = malloc(indexlen * sizeof(uint32_t));
+
+    if(buff == NULL || out == NULL || index == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    codec_encoder_t enc;
+    codec_decoder_t dec;
+    size_t encoded = 0;
+    size_t runs;
+    double start;
+    double elapsed;
+
+    //encode
+    runs = 0;
+    start = now_seconds();
+    do {
+        codec_encoder_init(&enc, buff, CODEC_ENCODED_MAX(len), BENCH_BLOCK, index, indexlen);
+        codec_encoder_add_all(&enc, arr, len);
+        encoded = codec_encoder_get_len(&enc);
+        ++runs;
+    } while((elapsed = now_seconds() - start) < BENCH_MIN_SECONDS);
+
+    const double enc_mbs = runs * len * sizeof(int32_t) / elapsed / 1e6;
+
+    //decode
+    runs = 0;
+    start = now_seconds();
+    do {
+        codec_decoder_init(&dec, buff, encoded, BENCH_BLOCK);
+        codec_decoder_read(&dec, out, len);
+        ++runs;
+    } while((elapsed = now_seconds() - start) < BENCH_MIN_SECONDS);
+
+    const double dec_mbs = runs * len * sizeof(int32_t) / elapsed / 1e6;
+
+    if(memcmp(arr, out, len * sizeof(int32_t)) != 0) {
+        fprintf(stderr, "decoded values do not match\n");
+        return EXIT_FAILURE;
+    }
+
+    //random access through the checkpoints
+    uint32_t state = 1;
+    for(size_t i = 0; i < 1000; ++i) {
+        const size_t n = prng(&state) % len;
+        int32_t v;
+        if(!codec_decoder_seek(&dec, index, indexlen, n) ||
+            !codec_decoder_next(&dec, &v) ||
+            v != arr[n]) {
+                fprintf(stderr, "seek to %zu failed\n", n);
+                return EXIT_FAILURE;
+        }
+    }
+
+    printf("values:      %zu\n", len);
+    printf("raw bytes:   %zu\n", len * sizeof(int32_t));
+    printf("encoded:     %zu (%.2f bytes/value)\n", encoded, (double)encoded / len);
+    printf("ratio:       %.2f:1\n", (double)(len * sizeof(int32_t)) / encoded);
+    printf("encode:      %.1f MB/s\n", enc_mbs);
+    printf("decode:      %.1f MB/s\n", dec_mbs);
+
+    free(arr);
+    free(buff);
+    free(out);
+    free(index);
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,140 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/flash_adaptor.h"
+#include "mem_flash_adaptor.h"
+
+bool mem_flash_adaptor_init(
+    mem_flash_adaptor_t* const mfa,
+    uint8_t* const mem,
+    const uint32_t size,
+    const uint32_t sector_size,
+    const uint32_t page_size) {
+
+        assert(mfa != NULL);
+        assert(mem != NULL);
+        assert(page_size > 0);
+        assert(sector_size % page_size == 0);
+        assert(size % sector_size == 0);
+
+        mfa->_mem = mem;
+        mfa->erases = 0;
+        mfa->programs = 0;
+
+        flash_adaptor_init(&mfa->_fa, mfa);
+        mfa->_fa.read = mem_flash_adaptor_read;
+        mfa->_fa.program = mem_flash_adaptor_program;
+        mfa->_fa.erase = mem_flash_adaptor_erase;
+        mfa->_fa.size = size;
+        mfa->_fa.sector_size = sector_size;
+        mfa->_fa.page_size = page_size;
+
+        return true;
+
+}
+
+flash_adaptor_t* mem_flash_adaptor_get_base(
+    mem_flash_adaptor_t* const mfa) {
+        assert(mfa != NULL);
+        return &mfa->_fa;
+}
+
+bool mem_flash_adaptor_read(
+    flash_adaptor_t* const fa,
+    const uint32_t offset,
+    uint8_t* const buff,
+    const size_t len) {
+
+        assert(fa != NULL);
+        assert(buff != NULL);
+
+        if(offset > fa->size || len > fa->size - offset) {
+            return false;
+        }
+
+        const mem_flash_adaptor_t* const mfa =
+            (const mem_flash_adaptor_t*)flash_adaptor_get_data(fa);
+
+        memcpy(buff, mfa->_mem + offset, len);
+
+        return true;
+
+}
+
+bool mem_flash_adaptor_program(
+    flash_adaptor_t* const fa,
+    const uint32_t offset,
+    const uint8_t* const buff) {
+
+        assert(fa != NULL);
+        assert(buff != NULL);
+
+        if(offset % fa->page_size != 0 || offset >= fa->size) {
+            return false;
+        }
+
+        mem_flash_adaptor_t* const mfa =
+            (mem_flash_adaptor_t*)flash_adaptor_get_data(fa);
+
+        uint8_t* const page = mfa->_mem + offset;
+
+        for(uint32_t i = 0; i < fa->page_size; ++i) {
+            if(page[i] != 0xff) {
+                return false;
+            }
+        }
+
+        for(uint32_t i = 0; i < fa->page_size; ++i) {
+            page[i] &= buff[i];
+        }
+
+        ++mfa->programs;
+
+        return true;
+
+}
+
+bool mem_flash_adaptor_erase(
+    flash_adaptor_t* const fa,
+    const uint32_t offset) {
+
+        assert(fa != NULL);
+
+        if(offset % fa->sector_size != 0 || offset >= fa->size) {
+            return false;
+        }
+
+        mem_flash_adaptor_t* const mfa =
+            (mem_flash_adaptor_t*)flash_adaptor_get_data(fa);
+
+        memset(mfa->_mem + offset, 0xff, fa->sector_size);
+
+        ++mfa->erases;
+
+        return true;
+
+}
@@ -0,0 +1,89 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef MEM_FLASH_ADAPTOR_H_2E8A61C4_7B09_4D3F_9C52_A1F6E07B83D9
+#define MEM_FLASH_ADAPTOR_H_2E8A61C4_7B09_4D3F_9C52_A1F6E07B83D9
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/flash_adaptor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Host stand-in for flash, held in memory. Behaves like NOR flash:
+ * erasing sets bytes to 0xff and programming can only clear bits.
+ * Programming a page which has not been erased fails, so a missed
+ * erase is caught rather than silently corrupting data.
+ */
+typedef struct {
+    uint8_t* _mem;
+    uint32_t erases;
+    uint32_t programs;
+    flash_adaptor_t _fa;
+} mem_flash_adaptor_t;
+
+/**
+ * @brief Initialises the adaptor over size bytes of mem, which already
+ * holds the flash contents (eg. all 0xff, or an image read from a file)
+ * 
+ * @param mfa 
+ * @param mem 
+ * @param size 
+ * @param sector_size 
+ * @param page_size 
+ * @return true 
+ * @return false 
+ */
+bool mem_flash_adaptor_init(
+    mem_flash_adaptor_t* const mfa,
+    uint8_t* const mem,
+    const uint32_t size,
+    const uint32_t sector_size,
+    const uint32_t page_size);
+
+flash_adaptor_t* mem_flash_adaptor_get_base(
+    mem_flash_adaptor_t* const mfa);
+
+bool mem_flash_adaptor_read(
+    flash_adaptor_t* const fa,
+    const uint32_t offset,
+    uint8_t* const buff,
+    const size_t len);
+
+bool mem_flash_adaptor_program(
+    flash_adaptor_t* const fa,
+    const uint32_t offset,
+    const uint8_t* const buff);
+
+bool mem_flash_adaptor_erase(
+    flash_adaptor_t* const fa,
+    const uint32_t offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Prints the records in a flight recording as CSV lines, oldest first:
+ * 
+ *  sample,<page seq>,<time us>,<value>
+ *  weight,<page seq>,<time us>,<raw>,<value>,<unit>
+ * 
+ * Sample times after the first in each record are estimated from the
+ * record's mean period.
+ * 
+ * The input is either an image of the flash region (eg. from picotool
+ * save) or the output of recorder_dump.
+ * 
+ * Usage: recorder_dump [-c capture] <file>
+ * With -c, samples are also written to a capture file for
+ * replay_scale_adaptor_t.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/mass.h"
+#include "../include/recorder.h"
+#include "capture_writer.h"
+#include "mem_flash_adaptor.h"
+
+int main(int argc, char** argv) {
+
+    FILE* capture = NULL;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:")) != -1) {
+        switch(opt) {
+            case 'c':
+                capture = capture_create(optarg, 0);
+                if(capture == NULL) {
+                    perror(optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            default:
+                optind = argc;
+                break;
+        }
+    }
+
+    if(optind >= argc) {
+        fprintf(stderr, "usage: %s [-c capture] <file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char* const path = argv[optind];
+    FILE* const f = fopen(path, "rb");
+
+    if(f == NULL) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    //only whole pages are of any use
+    const uint32_t len = size > 0
+        ? (uint32_t)size / RECORDER_PAGE_LEN * RECORDER_PAGE_LEN
+        : 0;
+
+    uint8_t* const mem = malloc(len + 1);
+
+    if(mem == NULL || fread(mem, 1, len, f) != len) {
+        fprintf(stderr, "%s: could not read\n", path);
+        fclose(f);
+        return EXIT_FAILURE;
+    }
+
+    fclose(f);
+
+    if(len == 0) {
+        free(mem);
+        return EXIT_SUCCESS;
+    }
+
+    mem_flash_adaptor_t mfa;
+    recorder_reader_t rd;
+    recorder_record_t* const r = malloc(sizeof(recorder_record_t));
+
+    //reading does not care about sectors, so treat each page as one
+    mem_flash_adaptor_init(&mfa, mem, len, RECORDER_PAGE_LEN, RECORDER_PAGE_LEN);
+
+    if(r == NULL || !recorder_reader_init(&rd, mem_flash_adaptor_get_base(&mfa))) {
+        fprintf(stderr, "%s: could not read\n", path);
+        return EXIT_FAILURE;
+    }
+
+    while(recorder_reader_next(&rd, r)) {
+
+        switch(r->type) {
+            case recorder_record_samples:
+                for(size_t i = 0; i < r->count; ++i) {
+
+                    const uint32_t time = r->time + (uint32_t)i * r->period;
+
+                    printf("sample,%lu,%lu,%ld\n",
+                        (unsigned long)r->seq,
+                        (unsigned long)time,
+                        (long)r->values[i]);
+
+                    if(capture != NULL) {
+                        capture_write(capture, time, r->values[i]);
+                    }
+
+                }
+                break;
+
+            case recorder_record_weight:
+                printf("weight,%lu,%lu,%.1f,%.6f,%s\n",
+                    (unsigned long)r->seq,
+                    (unsigned long)r->time,
+                    r->raw,
+                    r->ug / MASS_RATIOS[r->unit],
+                    MASS_NAMES[r->unit]);
+                break;
+        }
+
+    }
+
+    if(capture != NULL) {
+        fclose(capture);
+    }
+
+    free(r);
+    free(mem);
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,187 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Exercises the flight recorder against the in-memory flash stand-in.
+ * A simulated scale records a window of raw values and a weight every
+ * 250ms, well past the point the circular region wraps, with a reset
+ * part way through. The recording is then read back and checked to be
+ * an unbroken run of the most recent values.
+ * 
+ * Usage: recorder_sim [image]
+ * Writes the flash image to the given file, for recorder_dump.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/mass.h"
+#include "../include/recorder.h"
+#include "mem_flash_adaptor.h"
+
+static const uint32_t SIM_FLASH_SIZE = 32u * 1024u;
+static const uint32_t SIM_SECTOR_SIZE = 4096u;
+static const size_t SIM_WINDOWS = 2000;
+static const size_t SIM_WINDOW_LEN = 20; //80 SPS for 250ms
+static const uint32_t SIM_PERIOD = 12500; //us
+
+int main(int argc, char** argv) {
+
+    uint8_t* const mem = malloc(SIM_FLASH_SIZE);
+    int32_t* const all = malloc(SIM_WINDOWS * SIM_WINDOW_LEN * sizeof(int32_t));
+    recorder_record_t* const r = malloc(sizeof(recorder_record_t));
+
+    if(mem == NULL || all == NULL || r == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    //a new part is fully erased
+    memset(mem, 0xff, SIM_FLASH_SIZE);
+
+    mem_flash_adaptor_t mfa;
+    recorder_t rec;
+    int32_t values[SIM_WINDOW_LEN];
+    uint32_t times[SIM_WINDOW_LEN];
+    uint32_t now = 0;
+    size_t count = 0;
+    uint32_t state = 1;
+
+    mem_flash_adaptor_init(&mfa, mem, SIM_FLASH_SIZE, SIM_SECTOR_SIZE, RECORDER_PAGE_LEN);
+    flash_adaptor_t* const fa = mem_flash_adaptor_get_base(&mfa);
+
+    if(!recorder_init(&rec, fa)) {
+        fprintf(stderr, "could not start recording\n");
+        return EXIT_FAILURE;
+    }
+
+    for(size_t w = 0; w < SIM_WINDOWS; ++w) {
+
+        for(size_t i = 0; i < SIM_WINDOW_LEN; ++i) {
+            //xorshift32 noise around a fixed offset
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            values[i] = -367539 + (int32_t)(state % 200) - 100;
+            times[i] = now;
+            now += SIM_PERIOD;
+            all[count++] = values[i];
+        }
+
+        //mass.c needs the pico sdk, so set the mass directly
+        const mass_t m = {
+            .ug = (values[0] + 367539) / 432.0 * MASS_RATIOS[mass_g],
+            .unit = mass_g
+        };
+
+        if(!recorder_add_samples(&rec, values, times, SIM_WINDOW_LEN) ||
+            !recorder_add_weight(&rec, now, values[0], &m)) {
+                fprintf(stderr, "dropped records in window %zu\n", w);
+                return EXIT_FAILURE;
+        }
+
+        //between reads, as the main loop would
+        if(!recorder_service(&rec)) {
+            fprintf(stderr, "flash operation failed in window %zu\n", w);
+            return EXIT_FAILURE;
+        }
+
+        //a reset part way through must carry on the same recording
+        if(w == SIM_WINDOWS / 2) {
+            while(!recorder_flush(&rec) || !recorder_is_idle(&rec)) {
+                recorder_service(&rec);
+            }
+            if(!recorder_init(&rec, fa)) {
+                fprintf(stderr, "could not continue recording\n");
+                return EXIT_FAILURE;
+            }
+        }
+
+    }
+
+    while(!recorder_flush(&rec) || !recorder_is_idle(&rec)) {
+        if(!recorder_service(&rec)) {
+            fprintf(stderr, "flash operation failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    //read everything back
+    recorder_reader_t rd;
+    size_t samples = 0;
+    size_t weights = 0;
+    size_t first = 0; //index in all of the oldest recorded value
+    bool ok = recorder_reader_init(&rd, fa);
+
+    while(ok && recorder_reader_next(&rd, r)) {
+
+        if(r->type == recorder_record_weight) {
+            ++weights;
+            continue;
+        }
+
+        if(samples == 0) {
+            first = r->time / SIM_PERIOD;
+        }
+
+        if(r->period != SIM_PERIOD && r->count > 1) {
+            ok = false;
+        }
+
+        for(size_t i = 0; ok && i < r->count; ++i) {
+            ok = first + samples < count && r->values[i] == all[first + samples];
+            ++samples;
+        }
+
+    }
+
+    //the recording must run right up to the newest value
+    ok = ok && samples > 0 && first + samples == count;
+
+    printf("values:    %zu recorded of %zu\n", samples, count);
+    printf("weights:   %zu\n", weights);
+    printf("bytes:     %.2f per value\n", (double)SIM_FLASH_SIZE / samples);
+    printf("erases:    %lu\n", (unsigned long)mfa.erases);
+    printf("programs:  %lu\n", (unsigned long)mfa.programs);
+    printf("dropped:   %lu\n", (unsigned long)recorder_get_dropped(&rec));
+    printf("%s\n", ok ? "ok" : "FAILED");
+
+    if(argc > 1) {
+        FILE* const f = fopen(argv[1], "wb");
+        if(f == NULL || fwrite(mem, 1, SIM_FLASH_SIZE, f) != SIM_FLASH_SIZE) {
+            perror(argv[1]);
+            ok = false;
+        }
+        if(f != NULL) {
+            fclose(f);
+        }
+    }
+
+    free(mem);
+    free(all);
+    free(r);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
@@ -0,0 +1,174 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Decodes the binary telemetry stream from a device, or from any file
+ * or pseudo-terminal, and prints each packet as a CSV line:
+ * 
+ *  sample,<seq>,<time us>,<value>
+ *  reading,<seq>,<time us>,<raw>,<value>,<unit>,<stable>
+ * 
+ * Lost packets, counted from gaps in the sequence numbers, are
+ * reported on stderr.
+ * 
+ * Usage: telemetry_decode [-c capture] [path]
+ * Reads stdin if no path is given. With -c, samples are also written
+ * to a capture file for replay_scale_adaptor_t.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "../include/mass.h"
+#include "../include/telemetry.h"
+#include "capture_writer.h"
+
+static void print_packet(
+    const telemetry_packet_t* const pkt) {
+
+        switch(pkt->type) {
+            case telemetry_packet_samples:
+                for(size_t i = 0; i < pkt->count; ++i) {
+                    printf("sample,%u,%lu,%ld\n",
+                        pkt->seq,
+                        (unsigned long)pkt->times[i],
+                        (long)pkt->values[i]);
+                }
+                break;
+
+            case telemetry_packet_reading:
+                printf("reading,%u,%lu,%.1f,%.6f,%s,%d\n",
+                    pkt->seq,
+                    (unsigned long)pkt->time,
+                    pkt->raw,
+                    pkt->ug / MASS_RATIOS[pkt->unit],
+                    MASS_NAMES[pkt->unit],
+                    pkt->stable ? 1 : 0);
+                break;
+        }
+
+}
+
+int main(int argc, char** argv) {
+
+    int fd = STDIN_FILENO;
+    FILE* capture = NULL;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:")) != -1) {
+        switch(opt) {
+            case 'c':
+                capture = capture_create(optarg, 0);
+                if(capture == NULL) {
+                    fprintf(stderr, "%s: %s\n", optarg, strerror(errno));
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-c capture] [path]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if(optind < argc) {
+        fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+        if(fd < 0) {
+            fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    //a serial device must not alter or buffer the bytes
+    struct termios tio;
+    if(isatty(fd) && tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    telemetry_decoder_t dec;
+    telemetry_packet_t pkt;
+    uint8_t buff[4096];
+    uint16_t expected = 0;
+    bool first = true;
+    unsigned long lost = 0;
+
+    telemetry_decoder_init(&dec);
+
+    for(;;) {
+
+        const ssize_t n = read(fd, buff, sizeof(buff));
+
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if(n <= 0) {
+            break;
+        }
+
+        for(ssize_t i = 0; i < n; ++i) {
+
+            if(!telemetry_decoder_feed(&dec, buff[i], &pkt)) {
+                continue;
+            }
+
+            if(!first && pkt.seq != expected) {
+                const uint16_t gap = (uint16_t)(pkt.seq - expected);
+                lost += gap;
+                fprintf(stderr, "lost %u packet(s) before %u\n", gap, pkt.seq);
+            }
+
+            first = false;
+            expected = (uint16_t)(pkt.seq + 1);
+
+            print_packet(&pkt);
+
+            if(capture != NULL && pkt.type == telemetry_packet_samples) {
+                for(size_t j = 0; j < pkt.count; ++j) {
+                    capture_write(capture, pkt.times[j], pkt.values[j]);
+                }
+            }
+
+        }
+
+        fflush(stdout);
+
+    }
+
+    if(capture != NULL) {
+        fclose(capture);
+    }
+
+    if(lost > 0) {
+        fprintf(stderr, "lost %lu packet(s) in total\n", lost);
+    }
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,250 @@
+// MIT License
+// 
+// Copyright (c) 2023 Daniel Robertson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/**
+ * Round trip through telemetry_decode as it would be used with a
+ * device: frames are written to one side of a pseudo-terminal while
+ * the decoder reads the other, and its CSV output is checked against
+ * what was sent. Every value in a sample packet is sent, including
+ * ones which contain the frame delimiter, a newline and a carriage
+ * return, which a pseudo-terminal not in raw mode would alter.
+ *
+ * Usage: telemetry_pty_test <telemetry_decode>
+ * Exits with a failure status if the output differs.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include "../include/mass.h"
+#include "../include/telemetry.h"
+
+#define PTY_TEST_SAMPLES 40u //more than one packet's worth
+
+static const int PTY_TEST_TIMEOUT = 5000; //ms
+
+static bool write_frame(
+    const uint8_t* const buff,
+    const size_t len,
+    void* const data) {
+
+        const int fd = *(const int*)data;
+
+        for(size_t done = 0; done < len;) {
+
+            const ssize_t n = write(fd, buff + done, len - done);
+
+            if(n < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if(n <= 0) {
+                return false;
+            }
+
+            done += (size_t)n;
+
+        }
+
+        return true;
+
+}
+
+static size_t count_lines(
+    const char* const s) {
+
+        size_t n = 0;
+
+        for(const char* p = s; *p != '\0'; ++p) {
+            if(*p == '\n') {
+                ++n;
+            }
+        }
+
+        return n;
+
+}
+
+int main(int argc, char** argv) {
+
+    if(argc != 2) {
+        fprintf(stderr, "usage: %s <telemetry_decode>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        fprintf(stderr, "pty: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    const char* const path = ptsname(master);
+
+    //keep the other side open and raw from the start, so nothing
+    //written before the decoder opens it is altered or echoed
+    const int slave = open(path, O_RDWR | O_NOCTTY);
+    struct termios tio;
+
+    if(slave < 0 || tcgetattr(slave, &tio) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    int out[2];
+
+    if(pipe(out) != 0) {
+        fprintf(stderr, "pipe: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    const pid_t pid = fork();
+
+    if(pid < 0) {
+        fprintf(stderr, "fork: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    if(pid == 0) {
+        dup2(out[1], STDOUT_FILENO);
+        close(out[0]);
+        close(out[1]);
+        close(master);
+        close(slave);
+        execl(argv[1], argv[1], path, (char*)NULL);
+        _exit(127);
+    }
+
+    close(out[1]);
+
+    //send a window of samples and a reading, and build the
+    //lines the decoder should print for them
+    int32_t values[PTY_TEST_SAMPLES];
+    uint32_t times[PTY_TEST_SAMPLES];
+    char expected[4096] = {0};
+    size_t used = 0;
+    telemetry_t tm;
+
+    const mass_t m = {
+        .ug = 123.5 * MASS_RATIOS[mass_g],
+        .unit = mass_g
+    };
+
+    for(size_t i = 0; i < PTY_TEST_SAMPLES; ++i) {
+        values[i] = -367539 + (int32_t)(i * 97) - (i % 3 == 0 ? 0x0d0a00 : 0);
+        times[i] = 4294967000u + (uint32_t)(i * 12500);
+    }
+
+    values[1] = 0;
+    values[2] = '\n';
+    values[3] = '\r';
+    values[4] = INT32_MIN;
+    values[5] = INT32_MAX;
+
+    telemetry_init(&tm, write_frame, (void*)&master);
+
+    for(size_t i = 0; i < PTY_TEST_SAMPLES; ++i) {
+        used += (size_t)snprintf(
+            expected + used,
+            sizeof(expected) - used,
+            "sample,%u,%lu,%ld\n",
+            (unsigned)(i / TELEMETRY_MAX_SAMPLES),
+            (unsigned long)times[i],
+            (long)values[i]);
+    }
+
+    used += (size_t)snprintf(
+        expected + used,
+        sizeof(expected) - used,
+        "reading,%u,%lu,%.1f,%.6f,%s,%d\n",
+        (unsigned)((PTY_TEST_SAMPLES + TELEMETRY_MAX_SAMPLES - 1) / TELEMETRY_MAX_SAMPLES),
+        12345ul,
+        -314.0,
+        123.5,
+        MASS_NAMES[mass_g],
+        1);
+
+    if(!telemetry_send_samples(&tm, values, times, PTY_TEST_SAMPLES) ||
+        !telemetry_send_reading(&tm, 12345, -314.0, &m, true)) {
+            fprintf(stderr, "failed to write frames\n");
+            return EXIT_FAILURE;
+    }
+
+    //wait for the decoder to print every line before hanging up,
+    //since closing the pseudo-terminal discards anything unread
+    char actual[4096] = {0};
+    size_t got = 0;
+    struct pollfd pfd = { .fd = out[0], .events = POLLIN };
+
+    while(count_lines(actual) < count_lines(expected) && got < sizeof(actual) - 1) {
+
+        if(poll(&pfd, 1, PTY_TEST_TIMEOUT) <= 0) {
+            fprintf(stderr, "timed out waiting for the decoder\n");
+            break;
+        }
+
+        const ssize_t n = read(out[0], actual + got, sizeof(actual) - 1 - got);
+
+        if(n <= 0) {
+            break;
+        }
+
+        got += (size_t)n;
+
+    }
+
+    close(slave);
+    close(master);
+    close(out[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+        fprintf(stderr, "decoder failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if(strcmp(actual, expected) != 0) {
+        fprintf(stderr, "expected:\n%s\ndecoded:\n%s\n", expected, actual);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u samples and 1 reading decoded\n", PTY_TEST_SAMPLES);
+
+    return EXIT_SUCCESS;
+
+}